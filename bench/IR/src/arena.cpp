@@ -0,0 +1,108 @@
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <optional>
+#include <print>
+
+#include "bjac/IR/basic_block.hpp"
+#include "bjac/IR/binary_operator.hpp"
+#include "bjac/IR/branch_instruction.hpp"
+#include "bjac/IR/constant_instruction.hpp"
+#include "bjac/IR/function.hpp"
+#include "bjac/IR/ret_instruction.hpp"
+#include "bjac/IR/type.hpp"
+
+#include "bench/common.hpp"
+
+// Every heap allocation made by the program is counted
+
+namespace {
+
+std::atomic<std::size_t> allocations_count{0};
+
+void *counted_allocate(std::size_t size, std::size_t alignment) {
+    allocations_count.fetch_add(1, std::memory_order_relaxed);
+
+    // aligned_alloc requires the size to be a multiple of the alignment
+    size = (size + alignment - 1) / alignment * alignment;
+    if (void *p = std::aligned_alloc(alignment, size == 0 ? alignment : size)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+} // unnamed namespace
+
+void *operator new(std::size_t size) {
+    return counted_allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    return counted_allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+namespace {
+
+constexpr std::size_t kInstructionsPerBlock = 8;
+
+// Each block computes a chain of additions of constants and falls through to the next block
+void make_function(bjac::Function &foo, std::size_t n_blocks) {
+    const auto *i64 = bjac::IntegralType::get(bjac::Type::ID::kI64);
+
+    bjac::BasicBlock *prev = nullptr;
+    for (std::size_t i = 0; i != n_blocks; ++i) {
+        auto &bb = foo.emplace_back();
+        if (prev) {
+            prev->emplace_back<bjac::BranchInstruction>(bb);
+        }
+
+        bjac::Instruction *acc = &bb.emplace_back<bjac::ConstInstruction>(i64, i);
+        for (std::size_t j = 2; j < kInstructionsPerBlock; j += 2) {
+            auto &c = bb.emplace_back<bjac::ConstInstruction>(i64, j);
+            acc = &bb.emplace_back<bjac::BinaryOperator>(bjac::Instruction::Opcode::kAdd, *acc, c);
+        }
+
+        prev = &bb;
+    }
+    prev->emplace_back<bjac::ReturnInstruction>();
+}
+
+} // unnamed namespace
+
+int main() {
+    constexpr std::array kSizes{1'000uz, 10'000uz, 100'000uz};
+
+    std::println("{:>10} {:>10} {:>12} {:>12} {:>8} {:>12} {:>14}", "blocks", "instrs",
+                 "build allocs", "allocs/node", "slabs", "build, ms", "destroy, ms");
+
+    for (auto n_blocks : kSizes) {
+        std::optional<bjac::Function> foo;
+
+        const auto allocs_before = allocations_count.load();
+        const auto build_time = bench::best_of(1, [&] {
+            foo.emplace("bench", bjac::VoidType::get());
+            make_function(*foo, n_blocks);
+        });
+        const auto build_allocs = allocations_count.load() - allocs_before;
+
+        std::size_t n_instrs = 0;
+        for (auto &bb : *foo) {
+            n_instrs += bb.size();
+        }
+        const auto slabs = foo->get_arena().slabs_count();
+
+        const auto destroy_time = bench::best_of(1, [&] { foo.reset(); });
+
+        std::println("{:>10} {:>10} {:>12} {:>12.2f} {:>8} {:>12.3f} {:>14.3f}", n_blocks,
+                     n_instrs, build_allocs,
+                     static_cast<double>(build_allocs) / static_cast<double>(n_blocks + n_instrs),
+                     slabs, build_time.count(), destroy_time.count());
+    }
+}
@@ -0,0 +1,94 @@
+#include <array>
+#include <cstddef>
+#include <print>
+#include <ranges>
+
+#include "bjac/analysis/graph_coloring.hpp"
+#include "bjac/analysis/liveness.hpp"
+#include "bjac/analysis/reg_alloc.hpp"
+
+#include "bjac/IR/basic_block.hpp"
+#include "bjac/IR/function.hpp"
+#include "bjac/IR/instruction.hpp"
+#include "bjac/IR/phi_instruction.hpp"
+
+#include "bench/common.hpp"
+
+namespace {
+
+constexpr std::size_t kRuns = 5;
+// functions of the size of those in tests and large ones
+constexpr std::array kSizes{10uz, 50uz, 500uz, 1'000uz, 2'000uz};
+constexpr std::array kRegisters{4uz, 8uz};
+
+constexpr std::size_t kGlobalValues = 16;
+constexpr std::size_t kInstructionsPerBlock = 8;
+
+struct Stats {
+    std::size_t stack_slots = 0;
+    std::size_t spills = 0;
+    std::size_t reloads = 0;
+    // inputs of PHI instructions not sharing the location of the PHI instruction
+    std::size_t phi_copies = 0;
+    double cost = 0.0;
+};
+
+template <bjac::RegisterAllocator Allocator>
+Stats allocate(const bjac::Function &func, std::size_t n_regs) {
+    using enum bjac::RegAlloc::Storage::Kind;
+
+    const Allocator allocator{func, n_regs};
+
+    Stats stats{.stack_slots = allocator.stack_slots_count(), .cost = allocator.spill_cost()};
+    for (const auto &move : allocator.moves()) {
+        stats.spills += move.from.kind == kRegister && move.to.kind == kStackSlot;
+        stats.reloads += move.from.kind == kStackSlot && move.to.kind == kRegister;
+    }
+
+    const bjac::LivenessAnalysis liveness{func};
+    for (const auto &bb : func) {
+        if (!liveness.has_position(bb.front())) {
+            continue;
+        }
+        for (const auto &instr : bb.phi_instructions()) {
+            const auto &phi = static_cast<const bjac::PHIInstruction &>(instr);
+            for (const auto &[pred, input] : phi.get_paths()) {
+                if (!liveness.has_position(pred->back()) || !liveness.has_position(*input)) {
+                    continue;
+                }
+                const auto &from = allocator.at(*input, liveness.position(pred->back()));
+                stats.phi_copies += from != allocator.at(phi);
+            }
+        }
+    }
+    return stats;
+}
+
+} // unnamed namespace
+
+int main() {
+    std::println("{:>7} {:>5} | {:>31} {:>8} {:>9} | {:>31} {:>8} {:>9}", "blocks", "regs",
+                 "scan: slots/spills/loads/copies", "cost", "time, ms",
+                 "irc: slots/spills/loads/copies", "cost", "time, ms");
+
+    for (auto n_blocks : kSizes) {
+        auto foo = bench::make_function();
+        bench::make_random_cfg(foo, n_blocks);
+        bench::fill_blocks(foo, kGlobalValues, kInstructionsPerBlock);
+
+        for (auto n_regs : kRegisters) {
+            Stats scan;
+            Stats irc;
+            const auto scan_time = bench::best_of(
+                kRuns, [&] { scan = allocate<bjac::RegAlloc>(foo, n_regs); });
+            const auto irc_time = bench::best_of(
+                kRuns, [&] { irc = allocate<bjac::GraphColoringRegAlloc>(foo, n_regs); });
+
+            std::println("{:>7} {:>5} | {:>7}/{:>7}/{:>7}/{:>7} {:>8.0f} {:>9.3f} | "
+                         "{:>7}/{:>7}/{:>7}/{:>7} {:>8.0f} {:>9.3f}",
+                         n_blocks, n_regs, scan.stack_slots, scan.spills, scan.reloads,
+                         scan.phi_copies, scan.cost, scan_time.count(), irc.stack_slots,
+                         irc.spills, irc.reloads, irc.phi_copies, irc.cost, irc_time.count());
+        }
+    }
+}
@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <print>
+#include <ranges>
+#include <unordered_set>
+#include <vector>
+
+#include "bjac/analysis/lifetime.hpp"
+#include "bjac/analysis/liveness.hpp"
+
+#include "bjac/graphs/linear_order.hpp"
+
+#include "bjac/IR/basic_block.hpp"
+#include "bjac/IR/dense_map.hpp"
+#include "bjac/IR/function.hpp"
+#include "bjac/IR/instruction.hpp"
+#include "bjac/IR/phi_instruction.hpp"
+
+#include "bench/common.hpp"
+
+namespace {
+
+constexpr std::size_t kRuns = 5;
+constexpr std::array kSizes{1'000uz, 2'000uz, 5'000uz, 10'000uz, 20'000uz};
+constexpr std::array kInstructionCounts{1'000uz, 2'500uz, 5'000uz, 10'000uz, 25'000uz};
+
+constexpr std::size_t kGlobalValues = 16;
+constexpr std::size_t kInstructionsPerBlock = 8;
+
+// The backward walk over operands at the core of liveness analysis. Operands used to be returned
+// by a virtual function as a freshly allocated vector; kCopy emulates that
+template <bool kCopy>
+std::size_t walk_operands(const bjac::Function &foo) {
+    std::size_t sink = 0;
+    for (const auto &bb : foo | std::views::reverse) {
+        for (const auto &instr : bb | std::views::reverse) {
+            if constexpr (kCopy) {
+                const std::vector<const bjac::Instruction *> inputs{std::from_range,
+                                                                    instr.inputs()};
+                for (const auto *input : inputs) {
+                    sink += input->get_id();
+                }
+            } else {
+                for (const auto *input : instr.inputs()) {
+                    sink += input->get_id();
+                }
+            }
+        }
+    }
+    return sink;
+}
+
+// The previous liveness dataflow keeping live-in sets of blocks in hash sets. It computes the
+// same lifetimes as bjac::LivenessAnalysis and serves as the baseline for bit vector live sets
+bjac::DenseMap<bjac::Instruction, bjac::Lifetime> hash_set_liveness(const bjac::Function &func) {
+    using LiveIn = std::unordered_set<const bjac::Instruction *>;
+    using Segment = bjac::Lifetime::Segment;
+    using Traits = bjac::ConstFunctionGraphTraits;
+
+    func.renumber();
+    bjac::DenseMap<bjac::Instruction, bjac::Lifetime> lifetimes(func.numbered_instructions_count());
+
+    const bjac::DFS<Traits> dfs{func};
+    const bjac::DominatorTree<Traits> dom_tree{func, dfs};
+    const bjac::LoopTree<Traits> loop_tree{func, dfs, dom_tree};
+    const bjac::LinearOrder<Traits> linear_order{func, dom_tree, loop_tree};
+
+    bjac::DenseMap<bjac::BasicBlock, LiveIn> live_ins(func.numbered_blocks_count());
+
+    bjac::DenseMap<bjac::Instruction, std::size_t> numbering(func.numbered_instructions_count());
+    for (std::size_t n = 0; const auto *bb : linear_order) {
+        std::ranges::view auto phi_instructions = bb->phi_instructions();
+        for (const auto &instr : phi_instructions) {
+            numbering[instr] = n;
+        }
+
+        n += !phi_instructions.empty();
+
+        for (const auto &instr : bb->non_phi_instructions()) {
+            numbering[instr] = n++;
+        }
+    }
+
+    for (const auto *bb : linear_order | std::views::reverse) {
+        auto &live_in = live_ins[*bb];
+
+        for (const auto *succ : bb->successors()) {
+            live_in.insert_range(live_ins[*succ]);
+
+            const auto pred_index = succ->predecessor_index(*bb);
+            assert(pred_index);
+            for (const auto &phi : succ->phi_instructions()) {
+                const auto &phi_instr = static_cast<const bjac::PHIInstruction &>(phi);
+                live_in.insert(phi_instr.get_value(*pred_index));
+            }
+        }
+
+        const auto first_instr_n = numbering.at(bb->front());
+        const auto last_instr_n = numbering.at(bb->back());
+
+        for (const auto *instr : live_in) {
+            lifetimes[*instr].add(Segment{first_instr_n, last_instr_n});
+        }
+
+        for (const auto &instr : bb->non_phi_instructions() | std::views::reverse) {
+            const auto instr_n = numbering.at(instr);
+
+            if (instr.get_type_id() != bjac::Type::ID::kVoid) {
+                auto &lt = lifetimes[instr];
+                auto seg = Segment{instr_n, last_instr_n};
+                if (auto it = lt.find(seg); it == lt.end()) {
+                    lt.add(seg);
+                } else if (it->start() < instr_n) {
+                    const auto old_seg_end = it->end();
+                    lt.remove(it);
+                    lt.add(Segment{instr_n, old_seg_end});
+                }
+
+                live_in.erase(std::addressof(instr));
+            }
+
+            for (const auto *input : instr.inputs()) {
+                lifetimes[*input].add(Segment{first_instr_n, instr_n});
+                live_in.insert(input);
+            }
+        }
+
+        for (const auto &phi : bb->phi_instructions()) {
+            live_in.erase(std::addressof(phi));
+        }
+
+        if (loop_tree.is_header(bb)) {
+            const auto &last_loop_instr = loop_tree.get_loop(bb).vertices().back()->back();
+            const auto loop_end = numbering.at(last_loop_instr);
+            for (const auto *instr : live_in) {
+                lifetimes[*instr].add(Segment{first_instr_n, loop_end});
+            }
+        }
+    }
+
+    return lifetimes;
+}
+
+bool same_lifetimes(const bjac::Function &func) {
+    const auto expected = hash_set_liveness(func);
+    const bjac::LivenessAnalysis liveness{func};
+    return liveness.size() == expected.size() &&
+           std::ranges::all_of(liveness, [&expected](const auto &pair) {
+               return expected.contains(*pair.first) && expected.at(*pair.first) == pair.second;
+           });
+}
+
+} // unnamed namespace
+
+int main() {
+    std::println("{:>10} {:>16} {:>16}", "blocks", "vector walk, ms", "span walk, ms");
+
+    for (auto n_blocks : kSizes) {
+        auto foo = bench::make_function();
+        bench::make_random_cfg(foo, n_blocks);
+        bench::fill_blocks(foo, kGlobalValues, kInstructionsPerBlock);
+
+        std::size_t sink = 0;
+        const auto vector_time = bench::best_of(kRuns, [&] { sink += walk_operands<true>(foo); });
+        const auto span_time = bench::best_of(kRuns, [&] { sink += walk_operands<false>(foo); });
+
+        std::println("{:>10} {:>16.3f} {:>16.3f}", n_blocks, vector_time.count(),
+                     span_time.count());
+
+        // keeps the walks from being optimized out
+        if (sink == 0) {
+            std::println("");
+        }
+    }
+
+    std::println("");
+    std::println("{:>14} {:>10} {:>15} {:>17}", "instructions", "blocks", "hash sets, ms",
+                 "bit vectors, ms");
+
+    for (auto n_instrs : kInstructionCounts) {
+        // every block holds the chain of additions and a terminator
+        const auto n_blocks = n_instrs / (kInstructionsPerBlock + 1);
+
+        auto foo = bench::make_function();
+        bench::make_random_cfg(foo, n_blocks);
+        bench::fill_blocks(foo, kGlobalValues, kInstructionsPerBlock);
+
+        if (!same_lifetimes(foo)) {
+            std::println("bit vector liveness diverges from the baseline on {} blocks", n_blocks);
+            return EXIT_FAILURE;
+        }
+
+        std::size_t sink = 0;
+        const auto hash_set_time =
+            bench::best_of(kRuns, [&] { sink += hash_set_liveness(foo).size(); });
+        const auto bit_vector_time =
+            bench::best_of(kRuns, [&] { sink += bjac::LivenessAnalysis{foo}.size(); });
+
+        std::println("{:>14} {:>10} {:>15.3f} {:>17.3f}", foo.numbered_instructions_count(),
+                     n_blocks, hash_set_time.count(), bit_vector_time.count());
+
+        if (sink == 0) {
+            std::println("");
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <print>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+#include "bjac/analysis/lifetime.hpp"
+#include "bjac/analysis/liveness.hpp"
+#include "bjac/analysis/reg_alloc.hpp"
+
+#include "bjac/IR/basic_block.hpp"
+#include "bjac/IR/function.hpp"
+#include "bjac/IR/instruction.hpp"
+
+#include "bench/common.hpp"
+
+namespace {
+
+constexpr std::size_t kRuns = 5;
+constexpr std::array kSizes{100uz, 500uz, 1'000uz, 2'000uz};
+constexpr std::array kRegisters{4uz, 8uz, 32uz};
+
+constexpr std::size_t kGlobalValues = 16;
+constexpr std::size_t kInstructionsPerBlock = 8;
+
+struct Stats {
+    std::size_t stack_slots = 0;
+    std::size_t spills = 0;
+    std::size_t reloads = 0;
+    double cost = 0.0;
+};
+
+bool reads_register(const bjac::LivenessAnalysis &liveness, const bjac::Instruction &user) {
+    return !user.is_phi() && user.get_opcode() != bjac::Instruction::Opcode::kCall &&
+           liveness.has_position(user);
+}
+
+// Poletto-Sarkar linear scan the allocator used to be: a value either stays in a register for its
+// whole lifetime or lives in a stack slot, in which case it's stored once after its definition and
+// loaded before every use
+Stats whole_lifetime_linear_scan(const bjac::Function &func, std::size_t n_regs) {
+    const bjac::LivenessAnalysis liveness{func};
+
+    std::vector<std::pair<const bjac::Instruction *, const bjac::Lifetime *>> lifetimes{
+        std::from_range, liveness | std::views::transform([](const auto &pair) static {
+                             return std::pair{pair.first, std::addressof(pair.second)};
+                         })};
+    std::ranges::stable_sort(lifetimes, {}, [](const auto &pair) static {
+        return pair.second->start_point();
+    });
+
+    std::vector<const bjac::Instruction *> spilled;
+    std::multimap<std::size_t, const bjac::Instruction *> active;
+    for (const auto &[instr, lifetime] : lifetimes) {
+        active.erase(active.begin(), active.upper_bound(lifetime->start_point()));
+
+        if (active.size() != n_regs) {
+            active.emplace(lifetime->end_point(), instr);
+        } else if (auto last = std::prev(active.end()); last->first > lifetime->end_point()) {
+            spilled.push_back(last->second);
+            active.erase(last);
+            active.emplace(lifetime->end_point(), instr);
+        } else {
+            spilled.push_back(instr);
+        }
+    }
+
+    Stats stats{.stack_slots = spilled.size(), .spills = spilled.size()};
+    for (const auto *instr : spilled) {
+        stats.cost += liveness.frequency(instr->get_parent());
+        for (const auto *user : instr->get_users()) {
+            if (reads_register(liveness, *user)) {
+                ++stats.reloads;
+                stats.cost += liveness.frequency(user->get_parent());
+            }
+        }
+    }
+    return stats;
+}
+
+Stats interval_splitting_linear_scan(const bjac::Function &func, std::size_t n_regs) {
+    using enum bjac::RegAlloc::Storage::Kind;
+
+    const bjac::RegAlloc allocator{func, n_regs};
+
+    Stats stats{.stack_slots = allocator.stack_slots_count(), .cost = allocator.spill_cost()};
+    for (const auto &move : allocator.moves()) {
+        stats.spills += move.from.kind == kRegister && move.to.kind == kStackSlot;
+        stats.reloads += move.from.kind == kStackSlot && move.to.kind == kRegister;
+    }
+    return stats;
+}
+
+} // unnamed namespace
+
+int main() {
+    std::println("{:>7} {:>5} | {:>26} {:>10} {:>9} | {:>26} {:>10} {:>9}", "blocks", "regs",
+                 "whole: slots/spills/loads", "cost", "time, ms", "split: slots/spills/loads",
+                 "cost", "time, ms");
+
+    for (auto n_blocks : kSizes) {
+        auto foo = bench::make_function();
+        bench::make_random_cfg(foo, n_blocks);
+        bench::fill_blocks(foo, kGlobalValues, kInstructionsPerBlock);
+
+        for (auto n_regs : kRegisters) {
+            Stats whole;
+            Stats split;
+            const auto whole_time = bench::best_of(
+                kRuns, [&] { whole = whole_lifetime_linear_scan(foo, n_regs); });
+            const auto split_time = bench::best_of(
+                kRuns, [&] { split = interval_splitting_linear_scan(foo, n_regs); });
+
+            std::println("{:>7} {:>5} | {:>8}/{:>8}/{:>8} {:>10.0f} {:>9.3f} | "
+                         "{:>8}/{:>8}/{:>8} {:>10.0f} {:>9.3f}",
+                         n_blocks, n_regs, whole.stack_slots, whole.spills, whole.reloads,
+                         whole.cost, whole_time.count(), split.stack_slots, split.spills,
+                         split.reloads, split.cost, split_time.count());
+        }
+    }
+}
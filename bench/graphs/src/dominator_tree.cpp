@@ -0,0 +1,46 @@
+#include <array>
+#include <cstddef>
+#include <print>
+#include <string_view>
+
+#include "bjac/graphs/dfs.hpp"
+#include "bjac/graphs/dominator_tree.hpp"
+
+#include "bjac/IR/function.hpp"
+
+#include "bench/common.hpp"
+
+namespace {
+
+using Traits = bjac::ConstFunctionGraphTraits;
+
+constexpr std::size_t kRuns = 5;
+constexpr std::array kSizes{1'000uz, 2'000uz, 5'000uz, 10'000uz, 20'000uz, 50'000uz, 100'000uz};
+
+void run(std::string_view shape, auto make_cfg) {
+    std::println("{} CFG:", shape);
+    std::println("{:>10} {:>12} {:>12} {:>14}", "blocks", "dfs, ms", "domtree, ms",
+                 "domtree, ns/bb");
+
+    for (auto n_blocks : kSizes) {
+        auto foo = bench::make_function();
+        make_cfg(foo, n_blocks);
+
+        bjac::DFS<Traits> dfs{foo};
+
+        const auto dfs_time = bench::best_of(kRuns, [&] { dfs.recompute(foo, &foo.front()); });
+        const auto dom_time =
+            bench::best_of(kRuns, [&] { bjac::DominatorTree<Traits>{foo, dfs}; });
+
+        std::println("{:>10} {:>12.3f} {:>12.3f} {:>14.1f}", n_blocks, dfs_time.count(),
+                     dom_time.count(), dom_time.count() * 1e6 / n_blocks);
+    }
+    std::println("");
+}
+
+} // unnamed namespace
+
+int main() {
+    run("random", [](bjac::Function &foo, std::size_t n) { bench::make_random_cfg(foo, n); });
+    run("straight-line", bench::make_chain_cfg);
+}
@@ -0,0 +1,129 @@
+#ifndef BENCH_INCLUDE_BENCH_COMMON_HPP
+#define BENCH_INCLUDE_BENCH_COMMON_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "bjac/IR/basic_block.hpp"
+#include "bjac/IR/binary_operator.hpp"
+#include "bjac/IR/branch_instruction.hpp"
+#include "bjac/IR/constant_instruction.hpp"
+#include "bjac/IR/function.hpp"
+#include "bjac/IR/ret_instruction.hpp"
+#include "bjac/IR/type.hpp"
+
+namespace bench {
+
+inline auto make_function() { return bjac::Function{"bench", bjac::VoidType::get()}; }
+
+using duration = std::chrono::duration<double, std::milli>;
+
+// Runs f n_runs times and returns the fastest run
+template <typename F>
+duration best_of(std::size_t n_runs, F &&f) {
+    auto best = duration{std::numeric_limits<double>::max()};
+    for (std::size_t i = 0; i != n_runs; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        const auto finish = std::chrono::steady_clock::now();
+        best = std::min(best, duration{finish - start});
+    }
+    return best;
+}
+
+inline constexpr std::uint64_t kSeed = 0xb1c7c1e;
+
+// Fills an empty function with n_blocks basic blocks forming a reducible-ish CFG typical for
+// structured programs: each block falls through to the next one and, with some probability, also
+// branches either back to one of a few preceding blocks (a loop) or forward (an if-then-else)
+inline void make_random_cfg(bjac::Function &foo, std::size_t n_blocks,
+                            std::uint64_t seed = kSeed) {
+    std::vector<bjac::BasicBlock *> bbs;
+    bbs.reserve(n_blocks);
+    for (std::size_t i = 0; i != n_blocks; ++i) {
+        bbs.push_back(std::addressof(foo.emplace_back()));
+    }
+
+    auto &cond = bbs.front()->emplace_back<bjac::ConstInstruction>(
+        bjac::IntegralType::get(bjac::Type::ID::kI1), 0);
+
+    std::mt19937_64 gen{seed};
+    std::bernoulli_distribution is_conditional{0.7};
+    std::bernoulli_distribution is_back_edge{0.3};
+    constexpr std::size_t kWindow = 16;
+
+    for (std::size_t i = 0; i + 1 < n_blocks; ++i) {
+        auto &next = *bbs[i + 1];
+        if (!is_conditional(gen)) {
+            bbs[i]->emplace_back<bjac::BranchInstruction>(next);
+            continue;
+        }
+
+        std::size_t target;
+        if (is_back_edge(gen)) {
+            target = std::uniform_int_distribution<std::size_t>{i - std::min(i, kWindow), i}(gen);
+        } else {
+            target = std::uniform_int_distribution<std::size_t>{
+                i + 1, std::min(i + kWindow, n_blocks - 1)}(gen);
+        }
+
+        if (target == i + 1) {
+            bbs[i]->emplace_back<bjac::BranchInstruction>(next);
+        } else {
+            bbs[i]->emplace_back<bjac::BranchInstruction>(cond, next, *bbs[target]);
+        }
+    }
+
+    bbs.back()->emplace_back<bjac::ReturnInstruction>();
+}
+
+// Fills an empty function with a straight line of n_blocks basic blocks. Such CFGs are typical
+// after aggressive inlining, and the depth of DFS on them equals the number of blocks
+inline void make_chain_cfg(bjac::Function &foo, std::size_t n_blocks) {
+    bjac::BasicBlock *prev = nullptr;
+    for (std::size_t i = 0; i != n_blocks; ++i) {
+        auto &bb = foo.emplace_back();
+        if (prev) {
+            prev->emplace_back<bjac::BranchInstruction>(bb);
+        }
+        prev = std::addressof(bb);
+    }
+    prev->emplace_back<bjac::ReturnInstruction>();
+}
+
+// Adds n_globals constants to the entry block and a chain of n_per_block additions to every block
+// of a function with a CFG. Each addition takes the previous value of the chain and one of the
+// constants, so constants are live across the whole function
+inline void fill_blocks(bjac::Function &foo, std::size_t n_globals, std::size_t n_per_block,
+                        std::uint64_t seed = kSeed) {
+    const auto *i64 = bjac::IntegralType::get(bjac::Type::ID::kI64);
+
+    std::vector<bjac::Instruction *> globals;
+    for (std::size_t i = 0; i != n_globals; ++i) {
+        globals.push_back(
+            std::addressof(foo.front().emplace_front<bjac::ConstInstruction>(i64, i)));
+    }
+
+    std::mt19937_64 gen{seed};
+    std::uniform_int_distribution<std::size_t> pick{0, n_globals - 1};
+
+    for (auto &bb : foo) {
+        const auto term = std::prev(bb.end());
+        auto *prev = globals[pick(gen)];
+        for (std::size_t i = 0; i != n_per_block; ++i) {
+            prev = std::addressof(*bb.emplace<bjac::BinaryOperator>(
+                term, bjac::Instruction::Opcode::kAdd, *prev, *globals[pick(gen)]));
+        }
+    }
+}
+
+} // namespace bench
+
+#endif // BENCH_INCLUDE_BENCH_COMMON_HPP
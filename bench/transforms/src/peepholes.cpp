@@ -0,0 +1,393 @@
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <print>
+#include <random>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+#include "bjac/graphs/dfs.hpp"
+
+#include "bjac/IR/basic_block.hpp"
+#include "bjac/IR/binary_operator.hpp"
+#include "bjac/IR/constant_instruction.hpp"
+#include "bjac/IR/function.hpp"
+#include "bjac/IR/instruction.hpp"
+#include "bjac/IR/type.hpp"
+
+#include "bjac/transforms/peepholes.hpp"
+
+#include "bench/common.hpp"
+
+namespace {
+
+constexpr std::size_t kRuns = 5;
+constexpr std::array kSizes{100uz, 1'000uz, 5'000uz, 10'000uz};
+
+constexpr std::size_t kInstructionsPerBlock = 16;
+
+// The peephole pass as it was before its rules were written with bjac::pattern: a hand-written
+// ladder of opcode checks per opcode. It serves as the baseline for the rules matched with tables
+namespace handwritten {
+
+using bjac::BinaryOperator;
+using bjac::ConstInstruction;
+using bjac::Instruction;
+
+auto process_add(std::bidirectional_iterator auto it) -> decltype(it) {
+    using enum Instruction::Opcode;
+
+    auto &add_instr = static_cast<BinaryOperator &>(*it);
+    assert(add_instr.get_opcode() == kAdd);
+
+    auto &bb = it->get_parent();
+    auto next_it = std::next(it);
+
+    auto *lhs = add_instr.get_lhs();
+    auto *rhs = add_instr.get_rhs();
+
+    if (lhs->get_opcode() == kConst) {
+        if (static_cast<ConstInstruction *>(lhs)->get_value() == 0) { // 0 + x -> x
+            bb.replace_instruction(it, *rhs);
+        }
+    } else if (rhs->get_opcode() == kConst) {
+        if (static_cast<ConstInstruction *>(rhs)->get_value() == 0) { // x + 0 -> x
+            bb.replace_instruction(it, *lhs);
+        }
+    } else {
+        auto [sub, other] = [lhs, rhs] -> std::pair<BinaryOperator *, Instruction *> {
+            if (lhs->get_opcode() == kSub) {
+                return {static_cast<BinaryOperator *>(lhs), rhs};
+            } else if (rhs->get_opcode() == kSub) {
+                return {static_cast<BinaryOperator *>(rhs), lhs};
+            }
+            return {};
+        }();
+
+        if (!sub) {
+            return next_it;
+        }
+
+        if (sub->get_lhs()->get_opcode() == kConst &&
+            static_cast<ConstInstruction *>(sub->get_lhs())->get_value() == 0) {
+            auto new_it = bb.template emplace<BinaryOperator>(it, kSub, *other, *sub->get_rhs());
+            bb.replace_instruction(it, *new_it);
+            return new_it;
+        }
+    }
+
+    return next_it;
+}
+
+auto process_shrl(std::bidirectional_iterator auto it) -> decltype(it) {
+    using enum Instruction::Opcode;
+
+    auto &shrl_instr = static_cast<BinaryOperator &>(*it);
+    assert(shrl_instr.get_opcode() == kShrL);
+
+    auto &bb = it->get_parent();
+    auto next_it = std::next(it);
+
+    auto *lhs = shrl_instr.get_lhs();
+    auto *rhs = shrl_instr.get_rhs();
+
+    if (lhs->get_opcode() == kConst) {
+        if (static_cast<ConstInstruction *>(lhs)->get_value() == 0) { // 0 >> x -> 0
+            bb.replace_instruction(it, *lhs);
+        }
+    } else if (rhs->get_opcode() == kConst) {
+        if (static_cast<ConstInstruction *>(rhs)->get_value() == 0) { // x >> 0 -> x
+            bb.replace_instruction(it, *lhs);
+        }
+    }
+
+    return next_it;
+}
+
+void bitwise_instr_chaining(std::bidirectional_iterator auto it, auto op) {
+    using enum Instruction::Opcode;
+
+    assert(it->get_opcode() == kAnd || it->get_opcode() == kOr || it->get_opcode() == kXor);
+
+    auto *bit_instr = static_cast<BinaryOperator *>(std::addressof(*it));
+    auto *lhs = bit_instr->get_lhs();
+    auto *rhs = bit_instr->get_rhs();
+
+    auto [instr, constant] = [lhs, rhs, op] -> std::pair<Instruction *, std::uintmax_t> {
+        if (lhs->get_opcode() == kConst) {
+            if (rhs->get_opcode() == kAnd) {
+                auto *rhs_lhs = static_cast<BinaryOperator *>(rhs)->get_lhs();
+                auto *rhs_rhs = static_cast<BinaryOperator *>(rhs)->get_rhs();
+                if (rhs_lhs->get_opcode() == kConst) {
+                    return {rhs_rhs, op(static_cast<ConstInstruction *>(lhs)->get_value(),
+                                        static_cast<ConstInstruction *>(rhs_lhs)->get_value())};
+                } else if (rhs_rhs->get_opcode() == kConst) {
+                    return {rhs_lhs, op(static_cast<ConstInstruction *>(lhs)->get_value(),
+                                        static_cast<ConstInstruction *>(rhs_rhs)->get_value())};
+                }
+            }
+        } else if (rhs->get_opcode() == kConst) {
+            if (lhs->get_opcode() == kAnd) {
+                auto *lhs_lhs = static_cast<BinaryOperator *>(lhs)->get_lhs();
+                auto *lhs_rhs = static_cast<BinaryOperator *>(lhs)->get_rhs();
+                if (lhs_lhs->get_opcode() == kConst) {
+                    return {lhs_rhs, op(static_cast<ConstInstruction *>(rhs)->get_value(),
+                                        static_cast<ConstInstruction *>(lhs_lhs)->get_value())};
+                } else if (lhs_rhs->get_opcode() == kConst) {
+                    return {lhs_lhs, op(static_cast<ConstInstruction *>(rhs)->get_value(),
+                                        static_cast<ConstInstruction *>(lhs_rhs)->get_value())};
+                }
+            }
+        }
+
+        return {nullptr, 0};
+    }();
+
+    if (instr != nullptr) {
+        auto &bb = it->get_parent();
+        assert(it != bb.begin());
+        auto new_it = bb.template emplace<ConstInstruction>(
+            it, std::addressof(bit_instr->get_type()), constant);
+        bit_instr->set_lhs(*instr);
+        bit_instr->set_rhs(*new_it);
+    }
+}
+
+auto process_and(std::bidirectional_iterator auto it) -> decltype(it) {
+    using enum Instruction::Opcode;
+
+    auto &and_instr = static_cast<BinaryOperator &>(*it);
+    assert(and_instr.get_opcode() == kAnd);
+
+    auto &bb = it->get_parent();
+    auto next_it = std::next(it);
+
+    auto *lhs = and_instr.get_lhs();
+    auto *rhs = and_instr.get_rhs();
+
+    if (lhs->get_opcode() == kConst) {
+        auto *const_lhs = static_cast<ConstInstruction *>(lhs);
+        if (const auto value = const_lhs->get_value(); value == 0) { // 0 & x -> 0
+            bb.replace_instruction(it, *lhs);
+        } else if (value == const_lhs->max_value()) { // 1..1 & x -> x
+            bb.replace_instruction(it, *rhs);
+        } else {
+            bitwise_instr_chaining(it, std::bit_and{});
+        }
+    } else if (rhs->get_opcode() == kConst) {
+        auto *const_rhs = static_cast<ConstInstruction *>(rhs);
+        if (const auto value = const_rhs->get_value(); value == 0) { // x & 0 -> 0
+            bb.replace_instruction(it, *rhs);
+        } else if (value == const_rhs->max_value()) { // x & 1..1 -> x
+            bb.replace_instruction(it, *lhs);
+        } else {
+            bitwise_instr_chaining(it, std::bit_and{});
+        }
+    } else if (lhs == rhs) { // x & x -> x
+        bb.replace_instruction(it, *lhs);
+    }
+
+    return next_it;
+}
+
+auto process_or(std::bidirectional_iterator auto it) -> decltype(it) {
+    using enum Instruction::Opcode;
+
+    auto &or_instr = static_cast<BinaryOperator &>(*it);
+    assert(or_instr.get_opcode() == kOr);
+
+    auto &bb = it->get_parent();
+    auto next_it = std::next(it);
+
+    auto *lhs = or_instr.get_lhs();
+    auto *rhs = or_instr.get_rhs();
+
+    if (lhs->get_opcode() == kConst) {
+        auto *const_lhs = static_cast<ConstInstruction *>(lhs);
+        if (const auto value = const_lhs->get_value(); value == 0) { // 0 | x -> x
+            bb.replace_instruction(it, *rhs);
+        } else if (value == const_lhs->max_value()) { // 1..1 | x -> 1..1
+            bb.replace_instruction(it, *lhs);
+        } else {
+            bitwise_instr_chaining(it, std::bit_or{});
+        }
+    } else if (rhs->get_opcode() == kConst) {
+        auto *const_rhs = static_cast<ConstInstruction *>(rhs);
+        if (const auto value = const_rhs->get_value(); value == 0) { // x | 0 -> x
+            bb.replace_instruction(it, *lhs);
+        } else if (value == const_rhs->max_value()) { // x | 1..1 -> 1..1
+            bb.replace_instruction(it, *rhs);
+        } else {
+            bitwise_instr_chaining(it, std::bit_or{});
+        }
+    } else if (lhs == rhs) { // x | x -> x
+        bb.replace_instruction(it, *lhs);
+    }
+
+    return next_it;
+}
+
+auto process_xor(std::bidirectional_iterator auto it) -> decltype(it) {
+    using enum Instruction::Opcode;
+
+    auto &xor_instr = static_cast<BinaryOperator &>(*it);
+    assert(xor_instr.get_opcode() == kXor);
+
+    auto &bb = it->get_parent();
+    auto next_it = std::next(it);
+
+    auto *lhs = xor_instr.get_lhs();
+    auto *rhs = xor_instr.get_rhs();
+
+    if (lhs->get_opcode() == kConst) {
+        const auto value = static_cast<ConstInstruction *>(lhs)->get_value();
+        if (value == 0) { // 0 ^ x -> x
+            bb.replace_instruction(it, *rhs);
+        } else {
+            bitwise_instr_chaining(it, std::bit_or{});
+        }
+    } else if (rhs->get_opcode() == kConst) {
+        const auto value = static_cast<ConstInstruction *>(rhs)->get_value();
+        if (value == 0) { // x ^ 0 -> x
+            bb.replace_instruction(it, *lhs);
+        } else {
+            bitwise_instr_chaining(it, std::bit_or{});
+        }
+    } else if (lhs == rhs) { // x ^ x -> 0
+        auto new_it =
+            bb.template emplace<ConstInstruction>(it, std::addressof(xor_instr.get_type()), 0);
+        bb.replace_instruction(it, *new_it);
+        return new_it;
+    }
+
+    return next_it;
+}
+
+auto process_instruction(std::bidirectional_iterator auto it) -> decltype(it) {
+    using enum Instruction::Opcode;
+    switch (it->get_opcode()) {
+    case kAdd:
+        return process_add(it);
+    case kShrL:
+        return process_shrl(it);
+    case kAnd:
+        return process_and(it);
+    case kOr:
+        return process_or(it);
+    case kXor:
+        return process_xor(it);
+    default:
+        return std::next(it);
+    }
+}
+
+
+void run(bjac::Function &f) {
+    const bjac::DFS<bjac::MutFunctionGraphTraits> dfs{f};
+    for (auto *bb : dfs.post_order() | std::views::reverse) {
+        for (auto it = bb->begin(), ite = bb->end(); it != ite;) {
+            it = process_instruction(it);
+        }
+    }
+}
+
+} // namespace handwritten
+
+// Fills every block of a function with a CFG with a mix of the operations the peephole rules look
+// at. Operands are previous values of the block or constants, a third of which are 0 or 1..1, so
+// some instructions match a rule and most of them are only checked against the rules
+void fill_blocks(bjac::Function &foo, std::uint64_t seed = bench::kSeed) {
+    using enum bjac::Instruction::Opcode;
+
+    const auto *i64 = bjac::IntegralType::get(bjac::Type::ID::kI64);
+    constexpr std::array kOpcodes{kAdd, kSub, kShrL, kAnd, kOr, kXor};
+    constexpr std::array<std::uint64_t, 6> kConstants{
+        0, std::numeric_limits<std::uint64_t>::max(), 0x0ff, 0xff0, 42, 7};
+
+    std::mt19937_64 gen{seed};
+    std::uniform_int_distribution<std::size_t> pick_opcode{0, kOpcodes.size() - 1};
+    std::uniform_int_distribution<std::size_t> pick_constant{0, kConstants.size() - 1};
+    std::bernoulli_distribution is_constant{0.4};
+
+    for (auto &bb : foo) {
+        const auto term = std::prev(bb.end());
+        std::vector<bjac::Instruction *> values{std::addressof(
+            *bb.emplace<bjac::ConstInstruction>(term, i64, kConstants[pick_constant(gen)]))};
+
+        auto operand = [&] -> bjac::Instruction & {
+            if (is_constant(gen)) {
+                return *bb.emplace<bjac::ConstInstruction>(term, i64,
+                                                           kConstants[pick_constant(gen)]);
+            }
+            return *values[std::uniform_int_distribution<std::size_t>{0, values.size() - 1}(gen)];
+        };
+
+        for (std::size_t i = 0; i != kInstructionsPerBlock; ++i) {
+            auto &lhs = operand();
+            auto &rhs = operand();
+            values.push_back(std::addressof(
+                *bb.emplace<bjac::BinaryOperator>(term, kOpcodes[pick_opcode(gen)], lhs, rhs)));
+        }
+    }
+}
+
+std::size_t instructions_count(const bjac::Function &foo) {
+    std::size_t count = 0;
+    for (const auto &bb : foo) {
+        count += bb.size();
+    }
+    return count;
+}
+
+struct Result {
+    bench::duration time;
+    std::size_t instructions;
+};
+
+// Every run rewrites a fresh copy of the input, and only the pass is timed
+template <typename F>
+Result run_pass(std::size_t n_blocks, F &&pass) {
+    Result result{.time = bench::duration{std::numeric_limits<double>::max()}, .instructions = 0};
+    for (std::size_t i = 0; i != kRuns; ++i) {
+        auto foo = bench::make_function();
+        bench::make_random_cfg(foo, n_blocks);
+        fill_blocks(foo);
+
+        const auto start = std::chrono::steady_clock::now();
+        pass(foo);
+        const auto finish = std::chrono::steady_clock::now();
+
+        result.time = std::min(result.time, bench::duration{finish - start});
+        result.instructions = instructions_count(foo);
+    }
+    return result;
+}
+
+} // unnamed namespace
+
+int main() {
+    // instructions left after the pass are shown next to the time it took
+    std::println("{:>7} {:>13} | {:>13} {:>10} | {:>13} {:>10}", "blocks", "instructions",
+                 "hand-written", "time, ms", "rules", "time, ms");
+
+    for (auto n_blocks : kSizes) {
+        auto foo = bench::make_function();
+        bench::make_random_cfg(foo, n_blocks);
+        fill_blocks(foo);
+
+        const auto old = run_pass(n_blocks, handwritten::run);
+        const auto rules =
+            run_pass(n_blocks, [](bjac::Function &f) { bjac::PeepholePass{}.run(f); });
+
+        std::println("{:>7} {:>13} | {:>13} {:>10.3f} | {:>13} {:>10.3f}", n_blocks,
+                     instructions_count(foo), old.instructions, old.time.count(),
+                     rules.instructions, rules.time.count());
+    }
+}
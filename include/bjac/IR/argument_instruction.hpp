@@ -27,8 +27,6 @@ class ArgumentInstruction final : public Instruction {
 
     ArgumentInstruction(BasicBlock &parent, unsigned pos);
 
-    virtual void remove_as_user() override { /* no-op */ }
-
     unsigned pos_;
 };
 
@@ -1,20 +1,26 @@
 #ifndef INCLUDE_BJAC_IR_BASIC_BLOCK_HPP
 #define INCLUDE_BJAC_IR_BASIC_BLOCK_HPP
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <iosfwd>
 #include <memory>
+#include <memory_resource>
+#include <optional>
 #include <ranges>
-#include <set>
 #include <type_traits>
 #include <utility>
 
+#include <boost/container/small_vector.hpp>
+
 #include "bjac/IR/branch_instruction.hpp"
 #include "bjac/IR/call_instruction.hpp"
 #include "bjac/IR/instruction.hpp"
 #include "bjac/IR/phi_instruction.hpp"
 #include "bjac/IR/ret_instruction.hpp"
 
+#include "bjac/utils/arena.hpp"
 #include "bjac/utils/ilist.hpp"
 #include "bjac/utils/ilist_node.hpp"
 
@@ -31,12 +37,23 @@ class BasicBlock final : public Value, public ilist_node<BasicBlock>, private il
     using instructions::iterator;
     using instructions::size_type;
 
+    // Basic blocks are allocated from the arena of the function they belong to
+    static void *operator new(std::size_t size, Arena &arena) { return arena.allocate(size); }
+    static void operator delete(void *p, std::size_t size) noexcept {
+        Arena::owner(p).deallocate(p, size);
+    }
+    // Called only if the constructor throws; the chunk is released together with the arena
+    static void operator delete([[maybe_unused]] void *p, [[maybe_unused]] Arena &arena) noexcept {}
+
     template <typename Self>
     auto &get_parent(this Self &&self) noexcept {
         assert(self.parent_);
         return std::forward_like<Self>(*self.parent_);
     }
 
+    // Returns the arena of the parent function
+    Arena &get_arena() noexcept;
+
     template <typename Self>
     auto *get_terminator(this Self &&self) {
         if (!self.empty() && self.back().is_terminator()) {
@@ -47,31 +64,49 @@ class BasicBlock final : public Value, public ilist_node<BasicBlock>, private il
 
     unsigned get_id() const noexcept { return id_; }
 
+    // Dense index of the block in the function assigned by Function::renumber()
+    unsigned get_number() const noexcept { return number_; }
+
     unsigned get_next_instr_id() const noexcept { return next_instr_id_; }
 
-    auto predecessors() { return std::ranges::subrange(predecessors_); }
+    // Predecessors are kept in the order the edges were added in. Operands of PHI instructions of
+    // the block are aligned with them: the i-th operand comes from the i-th predecessor
+    std::ranges::contiguous_range auto predecessors() {
+        return std::ranges::subrange(predecessors_);
+    }
     auto predecessors() const {
         return predecessors_ | std::views::transform(
                                    [](BasicBlock *bb) static -> const BasicBlock * { return bb; });
     }
 
-    void add_predecessor(BasicBlock &bb) { predecessors_.insert(std::addressof(bb)); }
-    void remove_predecessor(BasicBlock &bb) { predecessors_.erase(std::addressof(bb)); }
-
-    template <typename Self>
-    auto successors(this Self &&self) {
-        using branch_type = decltype(std::forward_like<Self>(std::declval<BranchInstruction &>()));
-        using R = decltype(std::declval<branch_type &>().successors());
-
-        if (self.empty()) {
-            return R{};
-        } else if (auto &term = self.back(); term.get_opcode() != Instruction::Opcode::kBr) {
-            return R{};
-        } else {
-            return static_cast<branch_type &>(term).successors();
+    std::optional<std::size_t> predecessor_index(const BasicBlock &bb) const noexcept {
+        if (auto it = std::ranges::find(predecessors_, std::addressof(bb));
+            it != predecessors_.end()) {
+            return static_cast<std::size_t>(it - predecessors_.begin());
         }
+        return std::nullopt;
     }
 
+    // Adding and removing a predecessor adds and removes the corresponding operand of every PHI
+    // instruction of the block. Removal moves the last predecessor in place of the removed one
+    void add_predecessor(BasicBlock &bb);
+    void remove_predecessor(BasicBlock &bb);
+
+    // Puts to in place of predecessor from, so that the values PHI instructions take from from are
+    // now taken from to
+    void replace_predecessor(BasicBlock &from, BasicBlock &to) noexcept;
+
+    // Successors are the paths of the terminating branch in the same order. Both lists of edges
+    // are maintained by insertion and erasure of branches
+    std::ranges::contiguous_range auto successors() { return std::ranges::subrange(successors_); }
+    std::ranges::random_access_range auto successors() const {
+        return successors_ | std::views::transform(
+                                 [](BasicBlock *bb) static -> const BasicBlock * { return bb; });
+    }
+
+    // Redirects the i-th edge to successors to bb
+    void replace_successor(std::size_t i, BasicBlock &bb);
+
     template <typename T, typename... Args>
     iterator emplace(const_iterator pos, Args &&...args) {
         if constexpr (std::is_same_v<T, BranchInstruction>) {
@@ -88,13 +123,10 @@ class BasicBlock final : public Value, public ilist_node<BasicBlock>, private il
             }
         }
 
-        std::unique_ptr<T> instr{new T(*this, std::forward<Args>(args)...)};
+        std::unique_ptr<T> instr{new (get_arena()) T(*this, std::forward<Args>(args)...)};
 
         if constexpr (std::is_same_v<T, BranchInstruction>) {
-            instr->get_true_path()->add_predecessor(*this);
-            if (instr->is_conditional()) {
-                instr->get_false_path()->add_predecessor(*this);
-            }
+            add_successors(*instr);
         } else if constexpr (std::is_same_v<T, ReturnInstruction>) {
             add_ret_to_parent(*instr);
         } else if constexpr (std::is_same_v<T, CallInstruction>) {
@@ -130,6 +162,9 @@ class BasicBlock final : public Value, public ilist_node<BasicBlock>, private il
 
         using enum Instruction::Opcode;
         switch (pos->get_opcode()) {
+        case kBr:
+            remove_successors();
+            break;
         case kRet:
             remove_ret_from_parent(
                 const_cast<ReturnInstruction &>(static_cast<const ReturnInstruction &>(*pos)));
@@ -191,11 +226,17 @@ class BasicBlock final : public Value, public ilist_node<BasicBlock>, private il
     using instructions::rbegin;
     using instructions::rend;
 
+    // Iterator to an instruction of the block
+    using instructions::get_iterator;
+
   private:
     friend class Function;
 
     BasicBlock(Function &parent);
 
+    void add_successors(BranchInstruction &br);
+    void remove_successors();
+
     void add_ret_to_parent(ReturnInstruction &ret);
     void remove_ret_from_parent(ReturnInstruction &ret);
 
@@ -206,14 +247,16 @@ class BasicBlock final : public Value, public ilist_node<BasicBlock>, private il
     Function *parent_;
     unsigned id_;
     unsigned next_instr_id_;
+    mutable unsigned number_ = 0;
 
-    struct IDCompare {
-        bool operator()(const BasicBlock *lhs, const BasicBlock *rhs) const {
-            return lhs->get_id() < rhs->get_id();
-        }
-    };
+    // Most blocks have at most a couple of predecessors and a branch has at most two paths. Longer
+    // lists are allocated from the arena like everything else the function owns
+    template <std::size_t N>
+    using Edges = boost::container::small_vector<BasicBlock *, N,
+                                                 std::pmr::polymorphic_allocator<BasicBlock *>>;
 
-    std::set<BasicBlock *, IDCompare> predecessors_;
+    Edges<4> predecessors_;
+    Edges<2> successors_;
 };
 
 } // namespace bjac
@@ -1,6 +1,7 @@
 #ifndef INCLUDE_BJAC_IR_BINARY_OPERATOR_HPP
 #define INCLUDE_BJAC_IR_BINARY_OPERATOR_HPP
 
+#include <array>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -17,49 +18,43 @@ class InvalidBinaryOperatorOpcode final : public std::invalid_argument {
 
 class BinaryOperator final : public Instruction {
   public:
+    static constexpr unsigned kNumOperands = 2;
+
     ~BinaryOperator() override = default;
 
     template <typename Self>
     auto *get_lhs(this Self &&self) noexcept {
-        return std::addressof(std::forward_like<Self>(*self.lhs_));
+        return std::addressof(std::forward_like<Self>(*self.operands_[0].get()));
     }
 
     void set_lhs(Instruction &lhs) {
         if (!get_type().is_equal(lhs.get_type())) {
             throw OperandsTypeMismatch{opcode_, lhs.get_type(), get_type()};
         }
-        lhs_->remove_user(this);
-        lhs_ = std::addressof(lhs);
-        lhs_->add_user(this);
+        operands_[0].set(std::addressof(lhs));
     }
 
     template <typename Self>
     auto *get_rhs(this Self &&self) noexcept {
-        return std::addressof(std::forward_like<Self>(*self.rhs_));
+        return std::addressof(std::forward_like<Self>(*self.operands_[1].get()));
     }
 
     void set_rhs(Instruction &rhs) {
         if (!get_type().is_equal(rhs.get_type())) {
             throw OperandsTypeMismatch{opcode_, get_type(), rhs.get_type()};
         }
-        rhs_->remove_user(this);
-        rhs_ = std::addressof(rhs);
-        rhs_->add_user(this);
+        operands_[1].set(std::addressof(rhs));
     }
 
     std::string to_string() const override;
 
-    std::vector<Instruction *> inputs() override { return {lhs_, rhs_}; }
-    std::vector<const Instruction *> inputs() const override { return {lhs_, rhs_}; }
-
   private:
     friend class BasicBlock;
 
     BinaryOperator(BasicBlock &parent, Opcode opcode, Instruction &lhs, Instruction &rhs)
         : Instruction(parent, check_opcode(opcode), common_type(opcode, lhs, rhs)),
-          lhs_{std::addressof(lhs)}, rhs_{std::addressof(rhs)} {
-        lhs.add_user(this);
-        rhs.add_user(this);
+          operands_{{{*this, std::addressof(lhs)}, {*this, std::addressof(rhs)}}} {
+        set_operands(operands_);
     }
 
     static Opcode check_opcode(Opcode opcode) {
@@ -69,24 +64,17 @@ class BinaryOperator final : public Instruction {
         return opcode;
     }
 
-    static std::unique_ptr<Type> common_type(Opcode opcode, const Instruction &lhs,
-                                             const Instruction &rhs) {
+    static const Type *common_type(Opcode opcode, const Instruction &lhs, const Instruction &rhs) {
         const auto &lhs_type = lhs.get_type();
         const auto &rhs_type = rhs.get_type();
         if (lhs_type.is_equal(rhs_type)) {
-            return lhs_type.clone();
+            return std::addressof(lhs_type);
         } else {
             throw OperandsTypeMismatch{opcode, lhs_type, rhs_type};
         }
     }
 
-    void remove_as_user() override {
-        lhs_->remove_user(this);
-        rhs_->remove_user(this);
-    }
-
-    Instruction *lhs_;
-    Instruction *rhs_;
+    std::array<Use, kNumOperands> operands_;
 };
 
 } // namespace bjac
@@ -1,22 +1,23 @@
 #ifndef INCLUDE_BJAC_IR_BOUNDS_CHECK_HPP
 #define INCLUDE_BJAC_IR_BOUNDS_CHECK_HPP
 
+#include <array>
+
 #include "bjac/IR/instruction.hpp"
 
 namespace bjac {
 
 class BoundsCheckInstruction : public Instruction {
   public:
-    ~BoundsCheckInstruction() override = default;
+    static constexpr unsigned kNumOperands = 2;
 
-    Instruction *get_array() noexcept { return array_; }
-    const Instruction *get_array() const noexcept { return array_; }
+    ~BoundsCheckInstruction() override = default;
 
-    Instruction *get_index() noexcept { return index_; }
-    const Instruction *get_index() const noexcept { return index_; }
+    Instruction *get_array() noexcept { return operands_[0].get(); }
+    const Instruction *get_array() const noexcept { return operands_[0].get(); }
 
-    std::vector<Instruction *> inputs() override { return {array_, index_}; }
-    std::vector<const Instruction *> inputs() const override { return {array_, index_}; }
+    Instruction *get_index() noexcept { return operands_[1].get(); }
+    const Instruction *get_index() const noexcept { return operands_[1].get(); }
 
     std::string to_string() const override;
 
@@ -25,13 +26,7 @@ class BoundsCheckInstruction : public Instruction {
 
     BoundsCheckInstruction(BasicBlock &parent, Instruction &array, Instruction &index);
 
-    void remove_as_user() override {
-        array_->remove_user(this);
-        index_->remove_user(this);
-    }
-
-    Instruction *array_;
-    Instruction *index_;
+    std::array<Use, kNumOperands> operands_;
 };
 
 } // namespace bjac
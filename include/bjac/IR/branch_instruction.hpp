@@ -2,6 +2,7 @@
 #define INCLUDE_BJAC_IR_BRANCH_INSTRUCTION_HPP
 
 #include <array>
+#include <cstddef>
 #include <iterator>
 #include <memory>
 #include <ranges>
@@ -24,16 +25,15 @@ class BranchInstruction final : public Instruction {
   public:
     ~BranchInstruction() override = default;
 
-    bool is_conditional() const noexcept { return condition_ != nullptr; }
+    bool is_conditional() const noexcept { return condition_.get() != nullptr; }
 
-    Instruction *get_condition() noexcept { return condition_; }
-    const Instruction *get_condition() const noexcept { return condition_; }
+    Instruction *get_condition() noexcept { return condition_.get(); }
+    const Instruction *get_condition() const noexcept { return condition_.get(); }
     void set_condition(Instruction &cond) noexcept {
         auto *new_condition = check_condition(cond);
 
-        condition_->remove_user(this);
-        condition_ = new_condition;
-        condition_->add_user(this);
+        condition_.set(new_condition);
+        set_operands({std::addressof(condition_), 1});
     }
 
     template <typename Self>
@@ -41,20 +41,20 @@ class BranchInstruction final : public Instruction {
         return std::addressof(std::forward_like<Self>(*self.paths_[0]));
     }
 
-    void set_true_path(BasicBlock &bb) noexcept { paths_[0] = std::addressof(bb); }
+    void set_true_path(BasicBlock &bb) { set_path(0, bb); }
 
     BasicBlock *get_false_path() noexcept { return paths_[1]; }
     const BasicBlock *get_false_path() const noexcept { return paths_[1]; }
-    void set_false_path(BasicBlock &bb) noexcept { paths_[1] = std::addressof(bb); }
+    void set_false_path(BasicBlock &bb) { set_path(1, bb); }
 
     auto successors() {
-        return std::ranges::subrange{paths_.begin(),
-                                     condition_ ? paths_.end() : std::ranges::next(paths_.begin())};
+        return std::ranges::subrange{
+            paths_.begin(), is_conditional() ? paths_.end() : std::ranges::next(paths_.begin())};
     }
 
     auto successors() const {
         auto succ = std::ranges::subrange{
-            paths_.begin(), condition_ ? paths_.end() : std::ranges::next(paths_.begin())};
+            paths_.begin(), is_conditional() ? paths_.end() : std::ranges::next(paths_.begin())};
 
         return succ | std::views::transform(
                           [](BasicBlock *bb) static -> const BasicBlock * { return bb; });
@@ -62,34 +62,24 @@ class BranchInstruction final : public Instruction {
 
     std::string to_string() const override;
 
-    std::vector<Instruction *> inputs() override {
-        if (condition_) {
-            return {condition_};
-        }
-        return {};
-    }
-    std::vector<const Instruction *> inputs() const override {
-        if (condition_) {
-            return {condition_};
-        }
-        return {};
-    }
-
   private:
     friend class BasicBlock;
 
     BranchInstruction(BasicBlock &parent, BasicBlock &true_path)
-        : Instruction(parent, Opcode::kBr, std::make_unique<VoidType>()), condition_{nullptr},
+        : Instruction(parent, Opcode::kBr, VoidType::get()), condition_{*this, nullptr},
           paths_{std::addressof(true_path), nullptr} {}
 
     BranchInstruction(BasicBlock &parent, Instruction &condition, BasicBlock &true_path,
                       BasicBlock &false_path)
-        : Instruction(parent, Opcode::kBr, std::make_unique<VoidType>()),
-          condition_{check_condition(condition)},
+        : Instruction(parent, Opcode::kBr, VoidType::get()),
+          condition_{*this, check_condition(condition)},
           paths_{std::addressof(true_path), std::addressof(false_path)} {
-        condition.add_user(this);
+        set_operands({std::addressof(condition_), 1});
     }
 
+    // Also redirects the corresponding edge of the parent block if the path is its successor
+    void set_path(std::size_t i, BasicBlock &bb);
+
     static Instruction *check_condition(Instruction &cond) {
         if (cond.get_type_id() != Type::ID::kI1) {
             throw InvalidConditionType{"type of condition is not i1"};
@@ -97,9 +87,8 @@ class BranchInstruction final : public Instruction {
         return std::addressof(cond);
     }
 
-    void remove_as_user() override { condition_->remove_user(this); }
-
-    Instruction *condition_;
+    // the operand is registered only if the branch is conditional
+    Use condition_;
     std::array<BasicBlock *, 2> paths_;
 };
 
@@ -1,10 +1,13 @@
 #ifndef INCLUDE_BJAC_IR_CALL_INSTRUCTION_HPP
 #define INCLUDE_BJAC_IR_CALL_INSTRUCTION_HPP
 
+#include <memory>
+#include <ranges>
 #include <string>
 #include <vector>
 
 #include "bjac/IR/instruction.hpp"
+#include "bjac/IR/use_array.hpp"
 
 namespace bjac {
 
@@ -20,11 +23,9 @@ class CallInstruction final : public Instruction {
     Function &caller() noexcept;
     const Function &caller() const noexcept;
 
-    std::ranges::view auto arguments() { return std::ranges::subrange{args_}; }
-    std::ranges::view auto arguments() const {
-        return args_ | std::views::transform(
-                           [](Instruction *arg) static -> const Instruction * { return arg; });
-    }
+    // arguments are the operands of the call
+    std::ranges::view auto arguments() { return inputs(); }
+    std::ranges::view auto arguments() const { return inputs(); }
 
     bool is_recursive() const noexcept {
         return std::addressof(caller()) == std::addressof(callee());
@@ -37,10 +38,8 @@ class CallInstruction final : public Instruction {
 
     CallInstruction(BasicBlock &parent, Function &callee, std::vector<Instruction *> args = {});
 
-    virtual void remove_as_user() override { /* no-op */ }
-
     Function *callee_;
-    std::vector<Instruction *> args_;
+    UseArray args_;
 };
 
 } // namespace bjac
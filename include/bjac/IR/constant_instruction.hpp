@@ -77,8 +77,8 @@ class ConstInstruction final : public Instruction {
   private:
     friend class BasicBlock;
 
-    ConstInstruction(BasicBlock &parent, std::unique_ptr<Type> type, std::uintmax_t value)
-        : Instruction(parent, Opcode::kConst, std::move(type)), value_{value} {
+    ConstInstruction(BasicBlock &parent, const Type *type, std::uintmax_t value)
+        : Instruction(parent, Opcode::kConst, type), value_{value} {
         using enum Type::ID;
         switch (const auto id = get_type().id()) {
         case kI1:
@@ -111,8 +111,6 @@ class ConstInstruction final : public Instruction {
         }
     }
 
-    virtual void remove_as_user() override { /* no-op */ }
-
     std::uintmax_t value_;
 };
 
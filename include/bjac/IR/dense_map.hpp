@@ -0,0 +1,163 @@
+#ifndef INCLUDE_BJAC_IR_DENSE_MAP_HPP
+#define INCLUDE_BJAC_IR_DENSE_MAP_HPP
+
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace bjac {
+
+template <typename Key>
+concept DenselyNumbered = requires(const Key &key) {
+    { key.get_number() } -> std::convertible_to<std::size_t>;
+};
+
+// Side table mapping basic blocks or instructions of a function to values of type T. Values are
+// stored in a vector indexed by numbers assigned by Function::renumber(), so the function shall
+// not be modified while the map is in use
+template <DenselyNumbered Key, typename T>
+class DenseMap final {
+  public:
+    using key_type = const Key *;
+    using mapped_type = T;
+    using value_type = std::pair<const Key *, T>;
+    using size_type = std::size_t;
+
+  private:
+    // Iterates over occupied slots only; an empty slot has a null key
+    class slot_iterator final {
+      public:
+        using difference_type = std::ptrdiff_t;
+        using value_type = DenseMap::value_type;
+        using pointer = const value_type *;
+        using reference = const value_type &;
+        using iterator_category = std::forward_iterator_tag;
+
+        slot_iterator() = default;
+        slot_iterator(pointer slot, pointer last) noexcept : slot_{slot}, last_{last} {
+            skip_empty();
+        }
+
+        reference operator*() const noexcept { return *slot_; }
+        pointer operator->() const noexcept { return slot_; }
+
+        slot_iterator &operator++() noexcept {
+            ++slot_;
+            skip_empty();
+            return *this;
+        }
+        slot_iterator operator++(int) noexcept {
+            auto old = *this;
+            ++*this;
+            return old;
+        }
+
+        friend bool operator==(slot_iterator lhs, slot_iterator rhs) noexcept {
+            return lhs.slot_ == rhs.slot_;
+        }
+
+      private:
+        void skip_empty() noexcept {
+            while (slot_ != last_ && slot_->first == nullptr) {
+                ++slot_;
+            }
+        }
+
+        pointer slot_ = nullptr;
+        pointer last_ = nullptr;
+    };
+
+  public:
+    using const_iterator = slot_iterator;
+    using iterator = const_iterator;
+
+    DenseMap() = default;
+
+    // Preallocates slots for keys numbered [0; bound)
+    explicit DenseMap(size_type bound) : slots_(bound) {}
+
+    size_type size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    bool contains(const Key &key) const noexcept {
+        const size_type i = key.get_number();
+        return i < slots_.size() && slots_[i].first != nullptr;
+    }
+
+    T &operator[](const Key &key) {
+        auto &slot = get_slot(key);
+        if (slot.first == nullptr) {
+            slot.first = std::addressof(key);
+            ++size_;
+        }
+        return slot.second;
+    }
+
+    template <typename... Args>
+    bool try_emplace(const Key &key, Args &&...args) {
+        auto &slot = get_slot(key);
+        if (slot.first != nullptr) {
+            return false;
+        }
+        slot.first = std::addressof(key);
+        slot.second = T{std::forward<Args>(args)...};
+        ++size_;
+        return true;
+    }
+
+    template <typename Self>
+    auto &at(this Self &&self, const Key &key) {
+        if (!self.contains(key)) {
+            throw std::out_of_range{"the key is not in the dense map"};
+        }
+        auto &slot = self.slots_[key.get_number()];
+        assert(slot.first == std::addressof(key));
+        return std::forward_like<Self>(slot.second);
+    }
+
+    void erase(const Key &key) {
+        if (contains(key)) {
+            slots_[key.get_number()] = value_type{};
+            --size_;
+        }
+    }
+
+    void clear() noexcept {
+        slots_.clear();
+        size_ = 0;
+    }
+
+    const_iterator begin() const noexcept {
+        return {slots_.data(), slots_.data() + slots_.size()};
+    }
+    const_iterator cbegin() const noexcept { return begin(); }
+
+    const_iterator end() const noexcept {
+        const auto *last = slots_.data() + slots_.size();
+        return {last, last};
+    }
+    const_iterator cend() const noexcept { return end(); }
+
+  private:
+    value_type &get_slot(const Key &key) {
+        const size_type i = key.get_number();
+        if (i >= slots_.size()) {
+            slots_.resize(i + 1);
+        }
+        // two keys with the same number mean that the function was modified after renumbering
+        assert(slots_[i].first == nullptr || slots_[i].first == std::addressof(key));
+        return slots_[i];
+    }
+
+    std::vector<value_type> slots_;
+    size_type size_ = 0;
+};
+
+} // namespace bjac
+
+#endif // INCLUDE_BJAC_IR_DENSE_MAP_HPP
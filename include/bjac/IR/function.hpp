@@ -2,6 +2,7 @@
 #define INCLUDE_BJAC_IR_FUNCTION_HPP
 
 #include <concepts>
+#include <cstddef>
 #include <initializer_list>
 #include <iosfwd>
 #include <iterator>
@@ -17,6 +18,7 @@
 #include "bjac/IR/ret_instruction.hpp"
 #include "bjac/IR/type.hpp"
 
+#include "bjac/utils/arena.hpp"
 #include "bjac/utils/ilist.hpp"
 
 namespace bjac {
@@ -32,23 +34,27 @@ class Function final : public Value, private ilist<BasicBlock> {
     using basic_blocks::iterator;
     using basic_blocks::size_type;
 
-    Function(std::string_view name, std::unique_ptr<Type> return_type)
-        : Value{std::make_unique<NoneType>()}, name_(name), return_type_{std::move(return_type)} {}
+    Function(std::string_view name, const Type *return_type)
+        : Value{NoneType::get()}, name_(name), return_type_{return_type} {}
 
     template <std::input_iterator It>
-        requires std::convertible_to<std::iter_value_t<It>, Type>
-    Function(std::string_view name, std::unique_ptr<Type> return_type, It first, It last)
-        : Value{std::make_unique<NoneType>()}, name_(name), return_type_{std::move(return_type)},
+        requires std::convertible_to<std::iter_value_t<It>, const Type *>
+    Function(std::string_view name, const Type *return_type, It first, It last)
+        : Value{NoneType::get()}, name_(name), return_type_{return_type},
           parameters_(first, last) {}
 
-    Function(std::string_view name, std::unique_ptr<Type> return_type,
-             std::vector<std::unique_ptr<Type>> parameters)
-        : Value{std::make_unique<NoneType>()}, name_(name), return_type_{std::move(return_type)},
+    Function(std::string_view name, const Type *return_type, std::vector<const Type *> parameters)
+        : Value{NoneType::get()}, name_(name), return_type_{return_type},
           parameters_(std::move(parameters)) {}
 
     Function(Function &&rhs) = delete("resetting parents of basic blocks would be slow");
     Function &operator=(Function &&rhs) = delete("resetting parents of basic blocks would be slow");
 
+    // Blocks and instructions keep all their memory in the arena and refer to nothing outside the
+    // function but interned types, so they are freed with the slabs of the arena without running
+    // their destructors
+    ~Function() override { release_all(); }
+
     std::string_view name() const noexcept { return name_; }
 
     const Type &return_type() const noexcept { return *return_type_; }
@@ -60,9 +66,23 @@ class Function final : public Value, private ilist<BasicBlock> {
 
     unsigned get_next_bb_id() const noexcept { return next_bb_id_; }
 
+    // Numbers basic blocks and instructions in the order of their layout, so that they can be used
+    // as indices of DenseMap. Numbers are valid until the function is modified. Ids of blocks and
+    // instructions are not affected
+    void renumber() const noexcept;
+
+    // Counts of numbered entities as of the last call of renumber()
+    std::size_t numbered_blocks_count() const noexcept { return numbered_blocks_count_; }
+    std::size_t numbered_instructions_count() const noexcept {
+        return numbered_instructions_count_;
+    }
+
+    // The arena all basic blocks and instructions of the function are allocated from
+    Arena &get_arena() noexcept { return arena_; }
+
     template <typename... Args>
     iterator emplace(const_iterator pos, Args &&...args) {
-        std::unique_ptr<BasicBlock> bb{new BasicBlock(*this, std::forward<Args>(args)...)};
+        std::unique_ptr<BasicBlock> bb{new (arena_) BasicBlock(*this, std::forward<Args>(args)...)};
         ++next_bb_id_;
         return basic_blocks::insert(pos, std::move(bb));
     }
@@ -78,7 +98,7 @@ class Function final : public Value, private ilist<BasicBlock> {
     }
 
     iterator insert(const_iterator pos, std::unique_ptr<BasicBlock> bb) {
-        bb->id_ = next_bb_id_;
+        bb->id_ = next_bb_id_++;
         return basic_blocks::insert(pos, std::move(bb));
     }
 
@@ -120,8 +140,8 @@ class Function final : public Value, private ilist<BasicBlock> {
   private:
     std::string name_;
 
-    std::unique_ptr<Type> return_type_;
-    std::vector<std::unique_ptr<Type>> parameters_;
+    const Type *return_type_;
+    std::vector<const Type *> parameters_;
 
     std::unordered_set<ReturnInstruction *> rets_;
 
@@ -138,6 +158,11 @@ class Function final : public Value, private ilist<BasicBlock> {
     std::unordered_set<Function *, ConstHash, std::equal_to<>> callees_;
 
     unsigned next_bb_id_ = 0;
+
+    mutable std::size_t numbered_blocks_count_ = 0;
+    mutable std::size_t numbered_instructions_count_ = 0;
+
+    Arena arena_;
 };
 
 template <typename F>
@@ -148,6 +173,8 @@ struct FunctionGraphTraits {
     using vertex_handler = std::conditional_t<std::is_const_v<F>, const BasicBlock *, BasicBlock *>;
 
     static size_type n_vertices(const F &g) { return g.size(); }
+    static size_type index_bound(const F &g) { return g.get_next_bb_id(); }
+    static size_type index(vertex_handler v) { return v->get_id(); }
     static std::ranges::forward_range auto vertices(F &g) {
         return std::views::transform(g, [](auto &bb) static { return std::addressof(bb); });
     }
@@ -2,6 +2,7 @@
 #define INCLUDE_BJAC_IR_ICMP_INSTRUCTION_HPP
 
 #include <format>
+#include <array>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -16,67 +17,54 @@ class ICmpInstruction final : public Instruction {
   public:
     enum class Kind { eq, ne, ugt, uge, ult, ule, sgt, sge, slt, sle };
 
+    static constexpr unsigned kNumOperands = 2;
+
     ~ICmpInstruction() override = default;
 
     Kind get_kind() const noexcept { return kind_; }
 
     template <typename Self>
     auto *get_lhs(this Self &&self) noexcept {
-        return std::addressof(std::forward_like<Self>(*self.lhs_));
+        return std::addressof(std::forward_like<Self>(*self.operands_[0].get()));
     }
 
     void set_lhs(Instruction &lhs) {
-        if (!lhs_->get_type().is_equal(lhs.get_type())) {
-            throw OperandsTypeMismatch{opcode_, lhs_->get_type(), lhs.get_type()};
+        if (!get_lhs()->get_type().is_equal(lhs.get_type())) {
+            throw OperandsTypeMismatch{opcode_, get_lhs()->get_type(), lhs.get_type()};
         }
-        lhs_->remove_user(this);
-        lhs_ = std::addressof(lhs);
-        lhs_->add_user(this);
+        operands_[0].set(std::addressof(lhs));
     }
 
     template <typename Self>
     auto *get_rhs(this Self &&self) noexcept {
-        return std::addressof(std::forward_like<Self>(*self.rhs_));
+        return std::addressof(std::forward_like<Self>(*self.operands_[1].get()));
     }
 
     void set_rhs(Instruction &rhs) {
-        if (!rhs_->get_type().is_equal(rhs.get_type())) {
-            throw OperandsTypeMismatch{opcode_, rhs_->get_type(), rhs.get_type()};
+        if (!get_rhs()->get_type().is_equal(rhs.get_type())) {
+            throw OperandsTypeMismatch{opcode_, get_rhs()->get_type(), rhs.get_type()};
         }
-        rhs_->remove_user(this);
-        rhs_ = std::addressof(rhs);
-        rhs_->add_user(this);
+        operands_[1].set(std::addressof(rhs));
     }
 
     std::string to_string() const override;
 
-    std::vector<Instruction *> inputs() override { return {lhs_, rhs_}; }
-    std::vector<const Instruction *> inputs() const override { return {lhs_, rhs_}; }
-
   private:
     friend class BasicBlock;
 
     ICmpInstruction(BasicBlock &parent, Kind kind, Instruction &lhs, Instruction &rhs)
-        : Instruction(parent, Opcode::kICmp, std::make_unique<IntegralType>(Type::ID::kI1)),
-          kind_{kind}, lhs_{std::addressof(lhs)}, rhs_{std::addressof(rhs)} {
+        : Instruction(parent, Opcode::kICmp, IntegralType::get(Type::ID::kI1)),
+          kind_{kind}, operands_{{{*this, std::addressof(lhs)}, {*this, std::addressof(rhs)}}} {
+        set_operands(operands_);
         const auto &lhs_type = lhs.get_type();
         const auto &rhs_type = rhs.get_type();
         if (!lhs_type.is_equal(rhs_type)) {
             throw OperandsTypeMismatch{opcode_, lhs_type, rhs_type};
         }
-
-        lhs.add_user(this);
-        rhs.add_user(this);
-    }
-
-    void remove_as_user() override {
-        lhs_->remove_user(this);
-        rhs_->remove_user(this);
     }
 
     Kind kind_;
-    Instruction *lhs_;
-    Instruction *rhs_;
+    std::array<Use, kNumOperands> operands_;
 };
 
 inline std::string_view to_string_view(ICmpInstruction::Kind kind) {
@@ -1,10 +1,13 @@
 #ifndef INCLUDE_BJAC_IR_INSTRUCTION_HPP
 #define INCLUDE_BJAC_IR_INSTRUCTION_HPP
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <format>
+#include <memory>
 #include <ranges>
-#include <set>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <string_view>
@@ -12,7 +15,9 @@
 #include <vector>
 
 #include "bjac/IR/type.hpp"
+#include "bjac/IR/use.hpp"
 #include "bjac/IR/value.hpp"
+#include "bjac/utils/arena.hpp"
 #include "bjac/utils/ilist_node.hpp"
 
 namespace bjac {
@@ -51,7 +56,24 @@ class Instruction : public Value, public ilist_node<Instruction> {
 #include "bjac/IR/instructions.def"
     };
 
-    ~Instruction() override = default;
+    // Uses of the instruction may still exist only if its whole block is being erased, so they are
+    // just detached not to refer to the destroyed instruction later
+    ~Instruction() override {
+        for (auto *use = first_use_; use != nullptr;) {
+            auto *next = use->next_;
+            use->value_ = nullptr;
+            use->prev_ = use->next_ = nullptr;
+            use = next;
+        }
+    }
+
+    // Instructions are allocated from the arena of the function they belong to
+    static void *operator new(std::size_t size, Arena &arena) { return arena.allocate(size); }
+    static void operator delete(void *p, std::size_t size) noexcept {
+        Arena::owner(p).deallocate(p, size);
+    }
+    // Called only if a constructor throws; the chunk is released together with the arena
+    static void operator delete([[maybe_unused]] void *p, [[maybe_unused]] Arena &arena) noexcept {}
 
     Opcode get_opcode() const noexcept { return opcode_; }
 
@@ -63,6 +85,9 @@ class Instruction : public Value, public ilist_node<Instruction> {
 
     unsigned get_id() const noexcept { return id_; }
 
+    // Dense index of the instruction in the function assigned by Function::renumber()
+    unsigned get_number() const noexcept { return number_; }
+
     static constexpr bool is_binary_op(Opcode opcode) noexcept {
         return is_in_category<Opcode::kBinaryBegin, Opcode::kBinaryEnd>(opcode);
     }
@@ -91,26 +116,51 @@ class Instruction : public Value, public ilist_node<Instruction> {
 
     constexpr bool is_phi() const noexcept { return Instruction::is_phi(opcode_); }
 
-    void add_user(Instruction *value) { users_.insert(value); }
-    void remove_user(Instruction *value) { users_.erase(value); }
+    // The number of uses of the instruction; a user having the instruction as several operands
+    // is counted several times
+    std::unsigned_integral auto users_count() const noexcept { return uses_count_; }
 
-    std::unsigned_integral auto users_count() const noexcept { return users_.size(); }
+    bool has_user(const Instruction *user) const {
+        return std::ranges::contains(get_users(), user);
+    }
 
-    bool has_user(const Instruction *user) const { return users_.contains(user); }
+    std::ranges::forward_range auto get_uses() {
+        return std::ranges::subrange{use_iterator<Use>{first_use_}, use_iterator<Use>{}};
+    }
+    std::ranges::forward_range auto get_uses() const {
+        return std::ranges::subrange{use_iterator<const Use>{first_use_},
+                                     use_iterator<const Use>{}};
+    }
 
-    std::ranges::bidirectional_range auto get_users() { return std::ranges::subrange{users_}; }
-    std::ranges::bidirectional_range auto get_users() const {
-        return users_ | std::views::transform(
-                            [](Instruction *i) static -> const Instruction * { return i; });
+    std::ranges::forward_range auto get_users() {
+        return get_uses() | std::views::transform([](Use &use) static { return use.get_user(); });
     }
+    std::ranges::forward_range auto get_users() const {
+        return get_uses() | std::views::transform([](const Use &use) static -> const Instruction * {
+                   return use.get_user();
+               });
+    }
+
+    // Operands are stored contiguously by every kind of instruction, so they are accessed without
+    // virtual calls and allocations
+    std::span<Use> operands() noexcept { return {operands_ptr_, num_operands_}; }
+    std::span<const Use> operands() const noexcept { return {operands_ptr_, num_operands_}; }
 
-    virtual std::vector<Instruction *> inputs() { return {}; }
-    virtual std::vector<const Instruction *> inputs() const { return {}; }
+    std::ranges::random_access_range auto inputs() noexcept {
+        return operands() | std::views::transform([](Use &use) static { return use.get(); });
+    }
+    std::ranges::random_access_range auto inputs() const noexcept {
+        return operands() | std::views::transform([](const Use &use) static -> const Instruction * {
+                   return use.get();
+               });
+    }
 
     virtual std::string to_string() const = 0;
 
   private:
     friend class BasicBlock;
+    friend class Function;
+    friend class Use;
 
     template <Opcode kBegin, Opcode kEnd>
     static constexpr bool is_in_category(Opcode opcode) noexcept {
@@ -119,20 +169,61 @@ class Instruction : public Value, public ilist_node<Instruction> {
     }
 
   protected:
-    Instruction(BasicBlock &parent, Opcode opcode, std::unique_ptr<Type> type);
+    Instruction(BasicBlock &parent, Opcode opcode, const Type *type);
 
     // Replaces this instruction as an argument of all its users
     void replace_with(Instruction &other);
 
-    // Removes this instruction from users list of its arguments
-    virtual void remove_as_user() = 0;
+    // Every instruction registers the storage of its operands; instructions with a variable
+    // number of operands do it again whenever the storage changes
+    void set_operands(std::span<Use> operands) noexcept {
+        operands_ptr_ = operands.data();
+        num_operands_ = static_cast<unsigned>(operands.size());
+    }
 
     Opcode opcode_;
     BasicBlock *parent_;
     unsigned id_;
-    std::multiset<Instruction *, std::less<>> users_;
+
+  private:
+    // numbers are not a part of the IR, so they may be reassigned in a const function
+    mutable unsigned number_ = 0;
+
+  private:
+    void link(Use &use) noexcept {
+        use.prev_ = last_use_;
+        use.next_ = nullptr;
+        (last_use_ ? last_use_->next_ : first_use_) = std::addressof(use);
+        last_use_ = std::addressof(use);
+        ++uses_count_;
+    }
+
+    void unlink(Use &use) noexcept {
+        (use.prev_ ? use.prev_->next_ : first_use_) = use.next_;
+        (use.next_ ? use.next_->prev_ : last_use_) = use.prev_;
+        use.prev_ = use.next_ = nullptr;
+        --uses_count_;
+    }
+
+    Use *operands_ptr_ = nullptr;
+    unsigned num_operands_ = 0;
+
+    // uses are kept in the order they were linked in
+    Use *first_use_ = nullptr;
+    Use *last_use_ = nullptr;
+    std::size_t uses_count_ = 0;
 };
 
+inline void Use::set(Instruction *value) noexcept {
+    if (value_) {
+        value_->unlink(*this);
+    }
+    value_ = value;
+    if (value_) {
+        value_->link(*this);
+    }
+}
+
 inline std::string_view to_string_view(Instruction::Opcode opcode) noexcept {
     using namespace std::string_view_literals;
     switch (opcode) {
@@ -1,30 +1,29 @@
 #ifndef INCLUDE_BJAC_IR_LOAD_INSTRUCTION_HPP
 #define INCLUDE_BJAC_IR_LOAD_INSTRUCTION_HPP
 
+#include <array>
+
 #include "bjac/IR/instruction.hpp"
 
 namespace bjac {
 
 class LoadInstruction final : public Instruction {
   public:
-    ~LoadInstruction() override = default;
+    static constexpr unsigned kNumOperands = 1;
 
-    Instruction *get_addr() noexcept { return addr_; }
-    const Instruction *get_addr() const noexcept { return addr_; }
+    ~LoadInstruction() override = default;
 
-    std::vector<Instruction *> inputs() override { return {addr_}; }
-    std::vector<const Instruction *> inputs() const override { return {addr_}; }
+    Instruction *get_addr() noexcept { return operands_[0].get(); }
+    const Instruction *get_addr() const noexcept { return operands_[0].get(); }
 
     std::string to_string() const override;
 
   private:
     friend class BasicBlock;
 
-    LoadInstruction(BasicBlock &parent, std::unique_ptr<Type> type, Instruction &addr);
-
-    void remove_as_user() override { addr_->remove_user(this); }
+    LoadInstruction(BasicBlock &parent, const Type *type, Instruction &addr);
 
-    Instruction *addr_;
+    std::array<Use, kNumOperands> operands_;
 };
 
 } // namespace bjac
@@ -1,19 +1,20 @@
 #ifndef INCLUDE_BJAC_IR_NULL_CHECK_HPP
 #define INCLUDE_BJAC_IR_NULL_CHECK_HPP
 
+#include <array>
+
 #include "bjac/IR/instruction.hpp"
 
 namespace bjac {
 
 class NullCheckInstruction final : public Instruction {
   public:
-    ~NullCheckInstruction() override = default;
+    static constexpr unsigned kNumOperands = 1;
 
-    Instruction *get_input() noexcept { return input_; }
-    const Instruction *get_input() const noexcept { return input_; }
+    ~NullCheckInstruction() override = default;
 
-    std::vector<Instruction *> inputs() override { return {input_}; }
-    std::vector<const Instruction *> inputs() const override { return {input_}; }
+    Instruction *get_input() noexcept { return operands_[0].get(); }
+    const Instruction *get_input() const noexcept { return operands_[0].get(); }
 
     std::string to_string() const override;
 
@@ -22,9 +23,7 @@ class NullCheckInstruction final : public Instruction {
 
     NullCheckInstruction(BasicBlock &parent, Instruction &input);
 
-    void remove_as_user() override { input_->remove_user(this); }
-
-    Instruction *input_;
+    std::array<Use, kNumOperands> operands_;
 };
 
 } // namespace bjac
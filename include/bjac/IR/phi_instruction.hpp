@@ -1,15 +1,17 @@
 #ifndef INCLUDE_BJAC_IR_PHI_INSTRUCTION_HPP
 #define INCLUDE_BJAC_IR_PHI_INSTRUCTION_HPP
 
-#include <map>
+#include <cstddef>
 #include <memory>
 #include <ranges>
 #include <stdexcept>
 #include <string>
-#include <utility>
+#include <tuple>
+#include <type_traits>
 
 #include "bjac/IR/instruction.hpp"
 #include "bjac/IR/type.hpp"
+#include "bjac/IR/use_array.hpp"
 
 namespace bjac {
 
@@ -17,91 +19,82 @@ class PHITypeMismatch final : public std::invalid_argument {
     using std::invalid_argument::invalid_argument;
 };
 
+// Operands of a PHI instruction are aligned with predecessors of its parent block: the i-th operand
+// is the value coming from the i-th predecessor, or null if the path hasn't been added yet
 class PHIInstruction final : public Instruction {
+    template <typename Self>
+    using value_pointer = std::conditional_t<std::is_const_v<std::remove_reference_t<Self>>,
+                                             const Instruction, Instruction> *;
+
   public:
     ~PHIInstruction() override = default;
 
-    void add_path(BasicBlock &bb, Instruction &value) {
-        if (!get_type().is_equal(value.get_type())) {
-            throw PHITypeMismatch{"adding path of different type to a phi instruction"};
-        }
-        records_.emplace(std::addressof(bb), std::addressof(value));
-        value.add_user(this);
-    }
+    // Sets the value coming from predecessor bb of the parent block
+    void add_path(BasicBlock &bb, Instruction &value);
 
-    void remove_path(BasicBlock &bb) {
-        if (auto it = records_.find(std::addressof(bb)); it != records_.end()) {
-            it->second->remove_user(this);
-            records_.erase(it);
-        }
-    }
+    // Unsets the value coming from bb; the operand itself lives as long as the edge does
+    void remove_path(BasicBlock &bb);
 
     void replace_value(Instruction &from, Instruction &to) {
-        for (auto &instr : records_ | std::views::values) {
-            if (instr == std::addressof(from)) {
-                instr->remove_user(this);
-                instr = std::addressof(to);
-                instr->add_user(this);
+        for (auto &use : values_.span()) {
+            if (use.get() == std::addressof(from)) {
+                use.set(std::addressof(to));
             }
         }
     }
 
     template <typename Self>
-    auto get_value(this Self &&self, BasicBlock &bb)
-        -> std::conditional_t<std::is_const_v<std::remove_reference_t<Self>>, const Instruction,
-                              Instruction> * {
-        if (auto it = self.records_.find(std::addressof(bb)); it != self.records_.end()) {
-            return std::addressof(std::forward_like<Self>(*it->second));
+    auto get_value(this Self &&self, std::size_t pred_index) noexcept -> value_pointer<Self> {
+        return self.values_[pred_index].get();
+    }
+
+    template <typename Self>
+    auto get_value(this Self &&self, const BasicBlock &bb) -> value_pointer<Self> {
+        if (auto i = self.get_parent().predecessor_index(bb)) {
+            return self.values_[*i].get();
         }
         return nullptr;
     }
 
-    std::ranges::bidirectional_range auto get_paths() { return records_ | std::views::all; }
-    std::ranges::bidirectional_range auto get_paths() const {
-        return records_ | std::views::transform([](const auto &pair) static {
-                   return std::pair<const BasicBlock *, const Instruction *>{pair};
-               });
+    // Yields pairs of a predecessor and the value coming from it for every added path
+    template <typename Self>
+    std::ranges::bidirectional_range auto get_paths(this Self &&self) {
+        return std::views::zip(self.get_parent().predecessors(), self.inputs()) |
+               std::views::filter(
+                   [](const auto &path) static { return std::get<1>(path) != nullptr; });
     }
 
-    std::ranges::bidirectional_range auto get_sources() { return records_ | std::views::keys; }
-
-    std::ranges::bidirectional_range auto get_sources() const {
-        return records_ | std::views::keys |
-               std::views::transform(
-                   [](BasicBlock *bb) static -> const BasicBlock * { return bb; });
+    template <typename Self>
+    std::ranges::bidirectional_range auto get_sources(this Self &&self) {
+        return self.get_paths() |
+               std::views::transform([](const auto &path) static { return std::get<0>(path); });
     }
 
-    std::ranges::bidirectional_range auto get_values() { return records_ | std::views::values; }
-
-    std::ranges::bidirectional_range auto get_values() const {
-        return records_ | std::views::values |
-               std::views::transform(
-                   [](Instruction *i) static -> const Instruction * { return i; });
+    template <typename Self>
+    std::ranges::bidirectional_range auto get_values(this Self &&self) {
+        return self.get_paths() |
+               std::views::transform([](const auto &path) static { return std::get<1>(path); });
     }
 
     std::string to_string() const override;
 
-    std::vector<Instruction *> inputs() override {
-        return {std::from_range, records_ | std::views::values};
-    }
-
-    std::vector<const Instruction *> inputs() const override {
-        return {std::from_range, records_ | std::views::values};
-    }
-
   private:
     friend class BasicBlock;
 
-    PHIInstruction(BasicBlock &parent, std::unique_ptr<Type> type)
-        : Instruction(parent, Opcode::kPHI, std::move(type)) {}
+    PHIInstruction(BasicBlock &parent, const Type *type);
 
-    void remove_as_user() override {
-        for (auto *value : records_ | std::views::values) {
-            value->remove_user(this);
-        }
+    // Called by the parent block when a predecessor is added or removed
+    void add_incoming() {
+        values_.emplace_back(*this, nullptr);
+        set_operands(values_.span());
+    }
+
+    void remove_incoming(std::size_t pred_index) noexcept {
+        values_.swap_erase(pred_index);
+        set_operands(values_.span());
     }
 
-    std::map<BasicBlock *, Instruction *> records_;
+    UseArray values_;
 };
 
 } // namespace bjac
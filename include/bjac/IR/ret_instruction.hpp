@@ -14,15 +14,15 @@ class ReturnInstruction final : public Instruction {
     ~ReturnInstruction() override = default;
 
     Type::ID get_ret_type_id() const noexcept {
-        return ret_val_ ? ret_val_->get_type_id() : Type::ID::kVoid;
+        return ret_val_.get() ? ret_val_.get()->get_type_id() : Type::ID::kVoid;
     }
 
-    Instruction *get_ret_value() noexcept { return ret_val_; }
-    const Instruction *get_ret_value() const noexcept { return ret_val_; }
+    Instruction *get_ret_value() noexcept { return ret_val_.get(); }
+    const Instruction *get_ret_value() const noexcept { return ret_val_.get(); }
     void set_ret_value(Instruction &ret_val) {
         const auto &new_ret_type = ret_val.get_type();
-        if (ret_val_) {
-            const auto &curr_ret_type = ret_val_->get_type();
+        if (auto *curr_ret_val = ret_val_.get()) {
+            const auto &curr_ret_type = curr_ret_val->get_type();
             if (!new_ret_type.is_equal(curr_ret_type)) {
                 throw std::invalid_argument{std::format("trying to change {} {} to {} {}",
                                                         Opcode::kRet, new_ret_type.to_string(),
@@ -34,25 +34,20 @@ class ReturnInstruction final : public Instruction {
                                                     Type::ID::kVoid)};
         }
 
-        ret_val_->remove_user(this);
-        ret_val_ = std::addressof(ret_val);
-        ret_val_->add_user(this);
+        ret_val_.set(std::addressof(ret_val));
+        set_operands({std::addressof(ret_val_), 1});
     }
 
     std::string to_string() const override;
 
-    std::vector<Instruction *> inputs() override { return {ret_val_}; }
-    std::vector<const Instruction *> inputs() const override { return {ret_val_}; }
-
   private:
     friend class BasicBlock;
 
     ReturnInstruction(BasicBlock &parent); // ret void
     ReturnInstruction(BasicBlock &parent, Instruction &ret_val);
 
-    void remove_as_user() override { ret_val_->remove_user(this); }
-
-    Instruction *ret_val_;
+    // the operand is registered only if a value is returned
+    Use ret_val_;
 };
 
 } // namespace bjac
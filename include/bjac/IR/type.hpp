@@ -1,13 +1,18 @@
 #ifndef INCLUDE_BJAC_IR_TYPE_HPP
 #define INCLUDE_BJAC_IR_TYPE_HPP
 
+#include <cstddef>
 #include <format>
-#include <memory>
+#include <stdexcept>
+#include <string>
 #include <string_view>
 #include <utility>
 
 namespace bjac {
 
+// Types are immutable and interned: every distinct type exists as a single object living until
+// the end of the program, which is obtained by get() of the corresponding class. Thus values share
+// types by plain pointers, and two types are equal iff they are the same object
 class Type {
   public:
     enum class ID {
@@ -22,20 +27,19 @@ class Type {
         kArray
     };
 
+    Type(const Type &) = delete("types are interned");
+    Type &operator=(const Type &) = delete("types are interned");
+
     virtual ~Type() = default;
 
     constexpr ID id() const noexcept { return kind_; }
 
-    virtual std::unique_ptr<Type> clone() const = 0;
-    virtual bool is_equal(const Type &other) const = 0;
+    bool is_equal(const Type &other) const noexcept { return this == &other; }
     virtual std::string to_string() const = 0;
 
   protected:
     Type(ID kind) noexcept : kind_{kind} {}
 
-    Type(const Type &) = default;
-    Type(Type &&) = default;
-
     static ID check_if_integral(ID kind);
 
   private:
@@ -103,78 +107,64 @@ inline auto Type::check_if_integral(ID kind) -> ID {
 
 class NoneType final : public Type {
   public:
-    NoneType() : Type(ID::kNone) {}
+    static const NoneType *get();
 
-    std::unique_ptr<Type> clone() const override { return std::make_unique<NoneType>(); }
-    bool is_equal(const Type &other) const override { return other.id() == ID::kNone; }
     std::string to_string() const override { return std::string{to_string_view(ID::kNone)}; }
+
+  private:
+    NoneType() : Type(ID::kNone) {}
 };
 
 class VoidType final : public Type {
   public:
-    VoidType() : Type(ID::kVoid) {}
+    static const VoidType *get();
 
-    std::unique_ptr<Type> clone() const override { return std::make_unique<VoidType>(); }
-    bool is_equal(const Type &other) const override { return other.id() == ID::kVoid; }
     std::string to_string() const override { return std::string{to_string_view(ID::kVoid)}; }
+
+  private:
+    VoidType() : Type(ID::kVoid) {}
 };
 
 class IntegralType final : public Type {
   public:
-    explicit IntegralType(ID kind) : Type{check_if_integral(kind)} {}
-
-    std::unique_ptr<Type> clone() const override {
-        return std::unique_ptr<IntegralType>{new IntegralType{*this}};
-    }
+    static const IntegralType *get(ID kind);
 
-    bool is_equal(const Type &other) const override { return id() == other.id(); }
     std::string to_string() const override { return std::string{to_string_view(id())}; }
+
+  private:
+    explicit IntegralType(ID kind) : Type{check_if_integral(kind)} {}
 };
 
 class PointerType final : public Type {
   public:
-    explicit PointerType(ID referenced_kind)
-        : Type{ID::kPointer}, referenced_kind_{check_if_integral(referenced_kind)} {}
+    static const PointerType *get(ID referenced_kind);
 
     ID referenced_kind() const noexcept { return referenced_kind_; }
 
-    std::unique_ptr<Type> clone() const override {
-        return std::unique_ptr<PointerType>{new PointerType{*this}};
-    }
-
-    bool is_equal(const Type &other) const override {
-        return other.id() == ID::kPointer &&
-               referenced_kind_ == static_cast<const PointerType &>(other).referenced_kind_;
-    }
-
     std::string to_string() const override { return std::string{to_string_view(ID::kPointer)}; }
 
   private:
+    explicit PointerType(ID referenced_kind)
+        : Type{ID::kPointer}, referenced_kind_{check_if_integral(referenced_kind)} {}
+
     ID referenced_kind_;
 };
 
 class ArrayType final : public Type {
   public:
-    explicit ArrayType(ID referenced_kind, std::size_t size)
-        : Type{ID::kArray}, referenced_kind_{referenced_kind}, size_{size} {}
+    static const ArrayType *get(ID referenced_kind, std::size_t size);
 
     ID referenced_kind() const noexcept { return referenced_kind_; }
     std::size_t size() const noexcept { return size_; }
 
-    std::unique_ptr<Type> clone() const override {
-        return std::unique_ptr<ArrayType>{new ArrayType{*this}};
-    }
-
-    bool is_equal(const Type &other) const override {
-        return other.id() == ID::kArray && size_ == static_cast<const ArrayType &>(other).size_ &&
-               referenced_kind_ == static_cast<const ArrayType &>(other).referenced_kind_;
-    }
-
     std::string to_string() const override {
         return std::format("[{} x {}]", size_, referenced_kind_);
     }
 
   private:
+    explicit ArrayType(ID referenced_kind, std::size_t size)
+        : Type{ID::kArray}, referenced_kind_{referenced_kind}, size_{size} {}
+
     ID check_if_suitable_for_array(ID kind) {
         using enum ID;
         switch (kind) {
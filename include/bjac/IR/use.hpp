@@ -0,0 +1,93 @@
+#ifndef INCLUDE_BJAC_IR_USE_HPP
+#define INCLUDE_BJAC_IR_USE_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+namespace bjac {
+
+class Instruction;
+
+// An edge from an instruction (the user) to one of its operands. Uses are embedded into operand
+// storage of the user and linked into the intrusive list of uses of the operand, so adding,
+// removing and redirecting a use takes constant time and never allocates
+class Use final {
+  public:
+    // Creates an unattached use; such a use shall be initialized with init() before it's used
+    Use() = default;
+
+    Use(Instruction &user, Instruction *value) { init(user, value); }
+
+    Use(const Use &) = delete;
+    Use &operator=(const Use &) = delete;
+
+    Use(Use &&) = delete("the use is referred to by the list of uses of its value");
+    Use &operator=(Use &&) = delete("the use is referred to by the list of uses of its value");
+
+    ~Use() { set(nullptr); }
+
+    void init(Instruction &user, Instruction *value) {
+        assert(user_ == nullptr);
+        user_ = std::addressof(user);
+        set(value);
+    }
+
+    Instruction *get() const noexcept { return value_; }
+    Instruction *get_user() const noexcept { return user_; }
+
+    // Unlinks the use from the list of uses of the current value and links it into the one of the
+    // new value. Defined in instruction.hpp
+    void set(Instruction *value) noexcept;
+
+    Use *get_next() noexcept { return next_; }
+    const Use *get_next() const noexcept { return next_; }
+
+  private:
+    friend class Instruction;
+
+    Instruction *value_ = nullptr;
+    Instruction *user_ = nullptr;
+    Use *prev_ = nullptr;
+    Use *next_ = nullptr;
+};
+
+template <typename UseT>
+class use_iterator final {
+  public:
+    using difference_type = std::ptrdiff_t;
+    using value_type = UseT;
+    using pointer = UseT *;
+    using reference = UseT &;
+    using iterator_category = std::forward_iterator_tag;
+
+    use_iterator() = default;
+    explicit use_iterator(pointer use) noexcept : use_{use} {}
+
+    use_iterator(const use_iterator<std::remove_const_t<value_type>> &other) noexcept
+        requires std::is_const_v<value_type>
+        : use_{other.operator->()} {}
+
+    reference operator*() const noexcept { return *use_; }
+    pointer operator->() const noexcept { return use_; }
+
+    use_iterator &operator++() noexcept { return (use_ = use_->get_next(), *this); }
+    use_iterator operator++(int) noexcept {
+        auto old = *this;
+        ++*this;
+        return old;
+    }
+
+    friend bool operator==(use_iterator lhs, use_iterator rhs) = default;
+
+  private:
+    pointer use_ = nullptr;
+};
+
+static_assert(std::forward_iterator<use_iterator<Use>>);
+
+} // namespace bjac
+
+#endif // INCLUDE_BJAC_IR_USE_HPP
@@ -0,0 +1,99 @@
+#ifndef INCLUDE_BJAC_IR_USE_ARRAY_HPP
+#define INCLUDE_BJAC_IR_USE_ARRAY_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <utility>
+
+#include "bjac/IR/instruction.hpp"
+#include "bjac/IR/use.hpp"
+#include "bjac/utils/arena.hpp"
+
+namespace bjac {
+
+// Contiguous operand storage of instructions having a variable number of operands (PHI and call).
+// The buffer is allocated from the arena of the function, and since uses cannot be moved, growing
+// the array re-creates them in a new buffer linking them to the same values
+class UseArray final {
+  public:
+    explicit UseArray(Arena &arena) noexcept : arena_{std::addressof(arena)} {}
+
+    UseArray(const UseArray &) = delete;
+    UseArray &operator=(const UseArray &) = delete;
+
+    UseArray(UseArray &&) = delete("uses are referred to by the lists of uses of their values");
+    UseArray &operator=(UseArray &&) =
+        delete("uses are referred to by the lists of uses of their values");
+
+    ~UseArray() {
+        std::destroy_n(data_, size_);
+        release(data_, capacity_);
+    }
+
+    std::size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    Use &operator[](std::size_t i) noexcept {
+        assert(i < size_);
+        return data_[i];
+    }
+    const Use &operator[](std::size_t i) const noexcept {
+        assert(i < size_);
+        return data_[i];
+    }
+
+    std::span<Use> span() noexcept { return {data_, size_}; }
+    std::span<const Use> span() const noexcept { return {data_, size_}; }
+
+    void reserve(Instruction &user, std::size_t capacity) {
+        if (capacity <= capacity_) {
+            return;
+        }
+
+        auto *data = static_cast<Use *>(arena_->allocate(capacity * sizeof(Use), alignof(Use)));
+        for (std::size_t i = 0; i != size_; ++i) {
+            ::new (data + i) Use{user, data_[i].get()};
+        }
+        std::destroy_n(data_, size_);
+        release(data_, capacity_);
+
+        data_ = data;
+        capacity_ = capacity;
+    }
+
+    Use &emplace_back(Instruction &user, Instruction *value) {
+        if (size_ == capacity_) {
+            reserve(user, capacity_ == 0 ? kInitialCapacity : 2 * capacity_);
+        }
+        return *::new (data_ + size_++) Use{user, value};
+    }
+
+    // Removes the i-th use moving the last one in its place
+    void swap_erase(std::size_t i) noexcept {
+        assert(i < size_);
+        if (i != size_ - 1) {
+            data_[i].set(data_[size_ - 1].get());
+        }
+        std::destroy_at(data_ + --size_);
+    }
+
+  private:
+    static constexpr std::size_t kInitialCapacity = 2;
+
+    void release(Use *data, std::size_t capacity) noexcept {
+        if (data) {
+            arena_->deallocate(data, capacity * sizeof(Use), alignof(Use));
+        }
+    }
+
+    Arena *arena_;
+    Use *data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t capacity_ = 0;
+};
+
+} // namespace bjac
+
+#endif // INCLUDE_BJAC_IR_USE_ARRAY_HPP
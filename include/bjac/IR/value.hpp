@@ -1,7 +1,7 @@
 #ifndef INCLUDE_BJAC_IR_VALUE_HPP
 #define INCLUDE_BJAC_IR_VALUE_HPP
 
-#include <memory>
+#include <cassert>
 
 #include "bjac/IR/type.hpp"
 
@@ -9,7 +9,7 @@ namespace bjac {
 
 class Value {
   public:
-    Value(std::unique_ptr<Type> type) : type_{std::move(type)} {}
+    Value(const Type *type) noexcept : type_{type} { assert(type_ != nullptr); }
 
     virtual ~Value() = default;
 
@@ -17,7 +17,7 @@ class Value {
     Type::ID get_type_id() const noexcept { return type_->id(); }
 
   private:
-    std::unique_ptr<Type> type_;
+    const Type *type_;
 };
 
 } // namespace bjac
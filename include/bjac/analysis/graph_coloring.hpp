@@ -0,0 +1,76 @@
+#ifndef INCLUDE_BJAC_ANALYSIS_GRAPH_COLORING_HPP
+#define INCLUDE_BJAC_ANALYSIS_GRAPH_COLORING_HPP
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "bjac/analysis/reg_alloc.hpp"
+
+#include "bjac/IR/dense_map.hpp"
+#include "bjac/IR/instruction.hpp"
+
+namespace bjac {
+
+class Function;
+
+// Chaitin-Briggs allocator with iterated register coalescing (George and Appel). Values
+// interfering in LivenessAnalysis are colored with registers, and a PHI instruction is coalesced
+// with its inputs whenever the Briggs criterion guarantees that the graph stays colorable. A value
+// failing to get a register lives in the stack for its whole lifetime: it is stored after its
+// definition and reloaded before every use, and the graph is colored again. Slower than RegAlloc,
+// but suits ahead-of-time compilation. The result has the same form as that of RegAlloc
+class GraphColoringRegAlloc final {
+  public:
+    using Storage = RegAlloc::Storage;
+    using Part = RegAlloc::Part;
+    using Move = RegAlloc::Move;
+
+  private:
+    using Container = DenseMap<Instruction, std::vector<Part>>;
+
+  public:
+    using const_iterator = Container::const_iterator;
+    using iterator = const_iterator;
+
+    explicit GraphColoringRegAlloc(const Function &func, std::size_t free_regs_count);
+
+    // The location the instruction writes its result to
+    const Storage &at(const Instruction &instr) const { return parts(instr).front().storage; }
+
+    // The location of the value at given position of the linear order
+    const Storage &at(const Instruction &instr, std::size_t position) const;
+
+    std::span<const Part> parts(const Instruction &instr) const {
+        return instr_to_parts_.at(instr);
+    }
+
+    const std::vector<Move> &moves() const noexcept { return moves_; }
+
+    std::size_t stack_slots_count() const noexcept { return stack_slots_count_; }
+
+    // Stores and reloads weighted by estimated execution frequencies of their positions
+    double spill_cost() const noexcept { return spill_cost_; }
+
+    // The number of copies between PHI instructions and their inputs removed by coalescing
+    std::size_t coalesced_moves_count() const noexcept { return coalesced_moves_count_; }
+
+    const_iterator begin() const noexcept { return instr_to_parts_.begin(); }
+    const_iterator cbegin() const noexcept { return instr_to_parts_.cbegin(); }
+
+    const_iterator end() const noexcept { return instr_to_parts_.end(); }
+    const_iterator cend() const noexcept { return instr_to_parts_.cend(); }
+
+  private:
+    Container instr_to_parts_;
+    std::vector<Move> moves_;
+    std::size_t stack_slots_count_ = 0;
+    double spill_cost_ = 0.0;
+    std::size_t coalesced_moves_count_ = 0;
+};
+
+static_assert(RegisterAllocator<GraphColoringRegAlloc>);
+
+} // namespace bjac
+
+#endif // INCLUDE_BJAC_ANALYSIS_GRAPH_COLORING_HPP
@@ -1,20 +1,30 @@
 #ifndef INCLUDE_BJAC_ANALYSIS_LIFETIME_HPP
 #define INCLUDE_BJAC_ANALYSIS_LIFETIME_HPP
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <format>
 #include <initializer_list>
 #include <iterator>
 #include <ostream>
+#include <optional>
 #include <ranges>
-#include <set>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
+
+#include <boost/container/small_vector.hpp>
 
 namespace bjac {
 
+// Union of disjoint and non-adjacent segments of the linear order. Liveness analysis walks
+// instructions backwards, so segments usually come in descending order. They are kept sorted in
+// descending order in a vector with one inline slot: adding a segment below all others is an
+// amortized append, and a lifetime of a single segment does not allocate. Iterators still
+// traverse segments in ascending order
 class Lifetime final {
   public:
     class Segment final {
@@ -37,18 +47,12 @@ class Lifetime final {
     };
 
   private:
-    struct Compare {
-        // This comparator enables treating intersecting and adjacent segments as equivalent, hence
-        // easily merging them
-        bool operator()(const Segment &lhs, const Segment &rhs) const noexcept {
-            return lhs.end() + 1 < rhs.start();
-        }
-    };
+    using Container = boost::container::small_vector<Segment, 1>;
 
   public:
-    using const_iterator = std::set<Segment, Compare>::const_iterator;
+    using const_iterator = std::reverse_iterator<Container::const_iterator>;
     using iterator = const_iterator;
-    using const_reverse_iterator = std::set<Segment, Compare>::const_reverse_iterator;
+    using const_reverse_iterator = Container::const_iterator;
     using reverse_iterator = const_reverse_iterator;
 
     Lifetime() = default;
@@ -59,36 +63,69 @@ class Lifetime final {
         }
     }
 
-    bool empty() const noexcept { return lt_segments_.empty(); }
+    bool empty() const noexcept { return segments_.empty(); }
+    std::size_t size() const noexcept { return segments_.size(); }
 
-    const_iterator begin() const noexcept { return lt_segments_.begin(); }
+    const_iterator begin() const noexcept { return const_iterator{segments_.cend()}; }
     const_iterator cbegin() const noexcept { return begin(); }
-    const_reverse_iterator rbegin() const noexcept { return lt_segments_.rbegin(); }
+    const_reverse_iterator rbegin() const noexcept { return segments_.cbegin(); }
     const_reverse_iterator crbegin() const noexcept { return rbegin(); }
 
-    const_iterator end() const noexcept { return lt_segments_.end(); }
+    const_iterator end() const noexcept { return const_iterator{segments_.cbegin()}; }
     const_iterator cend() const noexcept { return end(); }
-    const_reverse_iterator rend() const noexcept { return lt_segments_.rend(); }
+    const_reverse_iterator rend() const noexcept { return segments_.cend(); }
     const_reverse_iterator crend() const noexcept { return rend(); }
 
-    const_iterator find(const Segment &seg) const { return lt_segments_.find(seg); }
+    // Finds a segment intersecting or adjacent to given one
+    const_iterator find(const Segment &seg) const {
+        const auto [first, last] = equal_range(seg);
+        return first == last ? end() : to_iterator(first);
+    }
 
     const Segment &front() const {
         assert(!empty());
-        return *begin();
+        return segments_.back();
     }
 
     const Segment &back() const {
         assert(!empty());
-        return *std::prev(end());
+        return segments_.front();
     }
 
     std::size_t start_point() const { return front().start(); }
     std::size_t end_point() const { return back().end(); }
 
-    // Checks whether given point/segment belongs to the lifetime set
+    // Checks whether given point/segment intersects the lifetime set
     bool intersects(std::size_t point) const { return intersects(Segment{point, point}); }
-    bool intersects(const Segment &seg) const { return lt_segments_.contains(seg); }
+    bool intersects(const Segment &seg) const {
+        // the first segment not lying entirely above seg
+        auto it = std::ranges::partition_point(
+            segments_, [&seg](const Segment &s) { return s.start() > seg.end(); });
+        return it != segments_.end() && it->end() >= seg.start();
+    }
+
+    bool intersects(const Lifetime &other) const { return next_intersection(other).has_value(); }
+
+    // Returns the least point not less than from belonging to both lifetime sets. Gaps between
+    // segments are holes, so two lifetimes may overlap as wholes and never intersect
+    std::optional<std::size_t> next_intersection(const Lifetime &other,
+                                                 std::size_t from = 0) const {
+        auto lhs = begin();
+        auto rhs = other.begin();
+        while (lhs != end() && rhs != other.end()) {
+            const auto lo = std::max({lhs->start(), rhs->start(), from});
+            const auto hi = std::min(lhs->end(), rhs->end());
+            if (lo <= hi) {
+                return lo;
+            }
+            if (lhs->end() < rhs->end()) {
+                ++lhs;
+            } else {
+                ++rhs;
+            }
+        }
+        return std::nullopt;
+    }
 
     // Checks whether given segment [a; b] belongs to the lifetime set and no segment [a - e; b + e]
     // belongs to the lifetime set for any positive value e (a == b for the case of a point)
@@ -98,16 +135,26 @@ class Lifetime final {
         return it != end() && *it == seg;
     }
 
+    // Adds a segment merging it with all intersecting and adjacent segments
     const_iterator add(Segment seg) {
-        auto [first, last] = lt_segments_.equal_range(seg);
-        while (first != last) {
-            seg = Segment{std::min(seg.start(), first->start()), std::max(seg.end(), first->end())};
-            remove(std::exchange(first, std::next(first)));
+        // fast path for segments coming in descending order
+        if (empty() || seg.end() + 1 < segments_.back().start()) {
+            segments_.push_back(seg);
+            return begin();
+        }
+
+        auto [first, last] = equal_range(seg);
+        if (first == last) {
+            return to_iterator(segments_.insert(first, seg));
         }
-        return lt_segments_.insert(seg).first;
+
+        *first = Segment{std::min(seg.start(), std::prev(last)->start()),
+                         std::max(seg.end(), first->end())};
+        segments_.erase(std::next(first), last);
+        return to_iterator(first);
     }
 
-    void remove(const_iterator it) { lt_segments_.erase(it); }
+    void remove(const_iterator it) { segments_.erase(std::prev(it.base())); }
 
     void remove(const Segment &seg) {
         if (auto it = find(seg); it != end() && *it == seg) {
@@ -118,9 +165,55 @@ class Lifetime final {
     bool operator==(const Lifetime &) const = default;
 
   private:
-    std::set<Segment, Compare> lt_segments_;
+    // Returns the range of segments intersecting or adjacent to seg
+    template <typename Self>
+    auto equal_range(this Self &self, const Segment &seg) {
+        auto &segments = self.segments_;
+        // segments lying entirely above seg and not adjacent to it precede the range
+        auto first = std::ranges::partition_point(
+            segments, [&seg](const Segment &s) { return s.start() > seg.end() + 1; });
+        auto last = std::ranges::partition_point(
+            first, segments.end(), [&seg](const Segment &s) { return s.end() + 1 >= seg.start(); });
+        return std::pair{first, last};
+    }
+
+    static const_iterator to_iterator(Container::const_iterator it) {
+        return const_iterator{std::next(it)};
+    }
+
+    Container segments_;
 };
 
+// Colors non-empty lifetimes so that intersecting ones get different colors. Lifetimes are visited
+// in the order of their start points, each one taking the least color not taken by lifetimes
+// intersecting it. Returns colors of lifetimes and the number of colors used
+inline std::pair<std::vector<std::size_t>, std::size_t>
+color_greedily(std::span<const Lifetime> lifetimes) {
+    std::vector<std::size_t> order(std::from_range, std::views::iota(0uz, lifetimes.size()));
+    std::ranges::stable_sort(order, {}, [lifetimes](std::size_t i) {
+        return lifetimes[i].start_point();
+    });
+
+    // unions of lifetimes of the same color
+    std::vector<Lifetime> classes;
+    std::vector<std::size_t> colors(lifetimes.size());
+    for (auto i : order) {
+        const auto &lifetime = lifetimes[i];
+        auto it = std::ranges::find_if(classes, [&lifetime](const Lifetime &colored) {
+            return !colored.intersects(lifetime);
+        });
+        if (it == classes.end()) {
+            it = classes.emplace(classes.end());
+        }
+        for (const auto &seg : lifetime) {
+            it->add(seg);
+        }
+        colors[i] = static_cast<std::size_t>(it - classes.begin());
+    }
+
+    return {std::move(colors), classes.size()};
+}
+
 } // namespace bjac
 
 namespace std {
@@ -1,24 +1,52 @@
 #ifndef INCLUDE_BJAC_ANALYSIS_LIVENESS_HPP
 #define INCLUDE_BJAC_ANALYSIS_LIVENESS_HPP
 
-#include <memory>
+#include <cstddef>
 #include <ranges>
-#include <unordered_map>
 
 #include "bjac/analysis/lifetime.hpp"
 
+#include "bjac/IR/basic_block.hpp"
+#include "bjac/IR/dense_map.hpp"
+#include "bjac/IR/instruction.hpp"
+
 namespace bjac {
 
 class Function;
-class Instruction;
 
-class LivenessAnalysis final : std::unordered_map<const Instruction *, Lifetime> {
-    using base = std::unordered_map<const Instruction *, Lifetime>;
+template <typename Traits>
+class DominatorTree;
+template <typename Traits>
+class LoopTree;
+template <typename Traits>
+class LinearOrder;
+
+// Lifetimes are indexed by numbers of instructions, so the function is renumbered by the analysis
+class LivenessAnalysis final : DenseMap<Instruction, Lifetime> {
+    using base = DenseMap<Instruction, Lifetime>;
 
   public:
     explicit LivenessAnalysis(const Function &func);
 
-    const Lifetime &at(const Instruction &instr) const { return base::at(std::addressof(instr)); }
+    // Reuses analyses of the control flow graph computed before. Instantiated for
+    // MutFunctionGraphTraits and ConstFunctionGraphTraits
+    template <typename Traits>
+    explicit LivenessAnalysis(typename Traits::graph_type &func,
+                              const DominatorTree<Traits> &dom_tree,
+                              const LoopTree<Traits> &loop_tree);
+
+    const Lifetime &at(const Instruction &instr) const { return base::at(instr); }
+
+    // Position of an instruction in the linear order; PHI instructions of a block share the
+    // position. Instructions of unreachable blocks have no position
+    std::size_t position(const Instruction &instr) const { return positions_.at(instr); }
+    bool has_position(const Instruction &instr) const { return positions_.contains(instr); }
+
+    // The number of loops containing a reachable block
+    std::size_t loop_depth(const BasicBlock &bb) const { return loop_depths_.at(bb); }
+
+    // Estimated execution frequency of a reachable block: every loop is assumed to run 10 times
+    double frequency(const BasicBlock &bb) const;
 
     std::ranges::view auto lifetimes() const { return *this | std::views::values; }
 
@@ -27,6 +55,14 @@ class LivenessAnalysis final : std::unordered_map<const Instruction *, Lifetime>
     using base::cend;
     using base::end;
     using base::size;
+
+  private:
+    template <typename Traits>
+    void compute(const Function &func, const LoopTree<Traits> &loop_tree,
+                 const LinearOrder<Traits> &linear_order);
+
+    DenseMap<Instruction, std::size_t> positions_;
+    DenseMap<BasicBlock, std::size_t> loop_depths_;
 };
 
 } // namespace bjac
@@ -1,21 +1,29 @@
 #ifndef INCLUDE_BJAC_ANALYSIS_REG_ALLOC_HPP
 #define INCLUDE_BJAC_ANALYSIS_REG_ALLOC_HPP
 
+#include <concepts>
 #include <cstddef>
 #include <format>
-#include <memory>
 #include <ostream>
-#include <unordered_map>
+#include <span>
+#include <vector>
+
+#include "bjac/IR/dense_map.hpp"
+#include "bjac/IR/instruction.hpp"
 
 namespace bjac {
 
+class BasicBlock;
 class Function;
-class Instruction;
 
+// Second-generation linear scan (Wimmer and Moessenboeck, "Optimized Interval Splitting in a Linear
+// Scan Register Allocator"): lifetimes are split into parts residing in registers or stack slots
 class RegAlloc final {
   public:
     struct Storage {
-        enum Kind : bool { kRegister, kStackSlot };
+        // A rematerialized value has no location between its uses: it's a constant materialized
+        // again at each of them
+        enum Kind : unsigned char { kRegister, kStackSlot, kRematerialized };
 
         Kind kind;
         std::size_t index;
@@ -23,8 +31,28 @@ class RegAlloc final {
         constexpr bool operator==(const Storage &) const = default;
     };
 
+    // A part of a lifetime beginning at given position of the linear order. Parts of a value are
+    // sorted by their positions, and each one lasts until the next one begins
+    struct Part {
+        std::size_t position;
+        Storage storage;
+    };
+
+    // A copy of a value between locations; a move from a rematerialized location re-emits the
+    // value. Moves splitting a lifetime precede the instruction at given position. Moves resolving
+    // locations on a control flow edge are placed at the end of the predecessor, the position of
+    // its terminator, and also refer to the successor. Nothing is moved to a rematerialized
+    // location
+    struct Move {
+        const Instruction *value;
+        Storage from;
+        Storage to;
+        std::size_t position;
+        const BasicBlock *successor = nullptr;
+    };
+
   private:
-    using Container = std::unordered_map<const Instruction *, Storage>;
+    using Container = DenseMap<Instruction, std::vector<Part>>;
 
   public:
     using const_iterator = Container::const_iterator;
@@ -32,20 +60,60 @@ class RegAlloc final {
 
     explicit RegAlloc(const Function &func, std::size_t free_regs_count);
 
-    const Storage &at(const Instruction &instr) const {
-        return instr_to_reg_.at(std::addressof(instr));
+    // The calling convention registers are preferred by: the i-th argument of a function is passed
+    // in register i, and the result is returned in register 0
+    static constexpr std::size_t kReturnRegister = 0;
+    static constexpr std::size_t argument_register(std::size_t i) noexcept { return i; }
+
+    // Constants can be produced again at any point of the function
+    static bool is_rematerializable(const Instruction &value) noexcept;
+
+    // The location the instruction writes its result to
+    const Storage &at(const Instruction &instr) const { return parts(instr).front().storage; }
+
+    // The location of the value at given position of the linear order
+    const Storage &at(const Instruction &instr, std::size_t position) const;
+
+    std::span<const Part> parts(const Instruction &instr) const {
+        return instr_to_parts_.at(instr);
     }
 
-    const_iterator begin() const noexcept { return instr_to_reg_.begin(); }
-    const_iterator cbegin() const noexcept { return instr_to_reg_.cbegin(); }
+    const std::vector<Move> &moves() const noexcept { return moves_; }
+
+    std::size_t stack_slots_count() const noexcept { return stack_slots_count_; }
+
+    // Moves between registers and stack slots weighted by estimated execution frequencies of the
+    // places they are inserted at
+    double spill_cost() const noexcept { return spill_cost_; }
+
+    const_iterator begin() const noexcept { return instr_to_parts_.begin(); }
+    const_iterator cbegin() const noexcept { return instr_to_parts_.cbegin(); }
 
-    const_iterator end() const noexcept { return instr_to_reg_.end(); }
-    const_iterator cend() const noexcept { return instr_to_reg_.cend(); }
+    const_iterator end() const noexcept { return instr_to_parts_.end(); }
+    const_iterator cend() const noexcept { return instr_to_parts_.cend(); }
 
   private:
-    Container instr_to_reg_;
+    Container instr_to_parts_;
+    std::vector<Move> moves_;
+    std::size_t stack_slots_count_ = 0;
+    double spill_cost_ = 0.0;
 };
 
+// Results of all register allocators have the same form, so one may be swapped for another
+template <typename T>
+concept RegisterAllocator =
+    std::constructible_from<T, const Function &, std::size_t> &&
+    requires(const T &allocator, const Instruction &instr, std::size_t position) {
+        { allocator.at(instr) } -> std::same_as<const RegAlloc::Storage &>;
+        { allocator.at(instr, position) } -> std::same_as<const RegAlloc::Storage &>;
+        { allocator.parts(instr) } -> std::same_as<std::span<const RegAlloc::Part>>;
+        { allocator.moves() } -> std::same_as<const std::vector<RegAlloc::Move> &>;
+        { allocator.stack_slots_count() } -> std::same_as<std::size_t>;
+        { allocator.spill_cost() } -> std::same_as<double>;
+    };
+
+static_assert(RegisterAllocator<RegAlloc>);
+
 } // namespace bjac
 
 namespace std {
@@ -63,6 +131,8 @@ struct formatter<::bjac::RegAlloc::Storage> : formatter<string> {
             return format_to(ctx.out(), "register[{}]", storage.index);
         case kStackSlot:
             return format_to(ctx.out(), "stack[{}]", storage.index);
+        case kRematerialized:
+            return format_to(ctx.out(), "rematerialized");
         }
     }
 };
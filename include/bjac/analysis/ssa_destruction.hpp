@@ -0,0 +1,81 @@
+#ifndef INCLUDE_BJAC_ANALYSIS_SSA_DESTRUCTION_HPP
+#define INCLUDE_BJAC_ANALYSIS_SSA_DESTRUCTION_HPP
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "bjac/analysis/reg_alloc.hpp"
+
+#include "bjac/IR/instruction.hpp"
+
+namespace bjac {
+
+class BasicBlock;
+class Function;
+
+// Lowers PHI instructions to copies between the locations a register allocator has chosen. All
+// copies on a control flow edge take effect at once: inputs of PHI instructions are copied to the
+// locations of the PHI instructions, and values placed differently at the ends of the edge are
+// moved to their locations in the successor. Such a parallel copy is ordered so that no location
+// is overwritten before it's read, cycles being broken with a scratch location or with swaps.
+// Inputs sharing locations with their PHI instructions, as coalesced by the allocator, need no
+// copies, and edges without copies are left alone
+class SSADestruction final {
+  public:
+    using Storage = RegAlloc::Storage;
+
+    struct Copy {
+        // A swap exchanges the contents of both locations
+        enum Kind : unsigned char { kMove, kSwap };
+
+        Kind kind;
+        // the value moved, which is the input for a copy lowering a PHI instruction
+        const Instruction *value;
+        Storage from;
+        Storage to;
+    };
+
+    // Where copies of an edge are inserted. The end of a predecessor with the only successor comes
+    // before its terminator. A critical edge, leading from a block with several successors to a
+    // block with several predecessors, needs a new block to hold them
+    enum class Placement : unsigned char { kPredecessorEnd, kSuccessorStart, kSplitEdge };
+
+    struct Edge {
+        const BasicBlock *pred;
+        const BasicBlock *succ;
+        Placement placement;
+        // in the order of execution
+        std::vector<Copy> copies;
+    };
+
+    // Instantiated for RegAlloc and GraphColoringRegAlloc
+    template <RegisterAllocator Allocator>
+    explicit SSADestruction(const Function &func, const Allocator &allocator,
+                            std::optional<Storage> scratch = std::nullopt);
+
+    // Orders a parallel copy: destinations of moves are distinct, and a swap or a move via the
+    // scratch location breaks every cycle
+    static std::vector<Copy> sequentialize(std::span<const Copy> parallel,
+                                           std::optional<Storage> scratch = std::nullopt);
+
+    // Edges with copies in the order of their successors and then predecessors
+    std::span<const Edge> edges() const noexcept { return edges_; }
+
+    std::size_t copies_count() const noexcept { return copies_count_; }
+    std::size_t split_edges_count() const noexcept { return split_edges_count_; }
+
+    // Inputs of PHI instructions already in the locations of their PHI instructions
+    std::size_t coalesced_copies_count() const noexcept { return coalesced_copies_count_; }
+
+  private:
+    std::vector<Edge> edges_;
+    std::size_t copies_count_ = 0;
+    std::size_t split_edges_count_ = 0;
+    std::size_t coalesced_copies_count_ = 0;
+};
+
+} // namespace bjac
+
+#endif // INCLUDE_BJAC_ANALYSIS_SSA_DESTRUCTION_HPP
@@ -4,8 +4,11 @@
 #include <algorithm>
 #include <cstddef>
 #include <initializer_list>
+#include <iterator>
+#include <limits>
 #include <memory>
-#include <unordered_map>
+#include <ranges>
+#include <stdexcept>
 #include <vector>
 
 namespace bjac {
@@ -16,13 +19,16 @@ class DFS final {
     using time_type = std::size_t;
     using graph_type = typename Traits::graph_type;
     using vertex_handler = typename Traits::vertex_handler;
+    using size_type = typename Traits::size_type;
+
+  private:
+    static constexpr size_type kNone = std::numeric_limits<size_type>::max();
+
+  public:
+    class SpanningTreeAncestorIterator;
 
     class InfoNode final {
       public:
-        InfoNode(vertex_handler v) : InfoNode{v, nullptr} {}
-        InfoNode(vertex_handler v, InfoNode *predecessor)
-            : vertex_(v), discovery_time_{0}, finished_time_{0}, predecessor_{predecessor} {}
-
         vertex_handler get_vertex() const { return vertex_; }
         time_type get_discovery_time() const { return discovery_time_; }
         time_type get_finished_time() const { return finished_time_; }
@@ -31,10 +37,11 @@ class DFS final {
         friend class DFS;
         friend class SpanningTreeAncestorIterator;
 
-        vertex_handler vertex_;
-        time_type discovery_time_;
-        time_type finished_time_;
-        InfoNode *predecessor_;
+        vertex_handler vertex_{};
+        time_type discovery_time_ = 0;
+        time_type finished_time_ = 0;
+        size_type predecessor_ = kNone; // index of the parent in the spanning tree
+        bool visited_ = false;
     };
 
     class SpanningTreeAncestorIterator {
@@ -46,16 +53,17 @@ class DFS final {
         using difference_type = std::ptrdiff_t;
 
         // for compatibility with ranges algorithms
-        SpanningTreeAncestorIterator() : v_info_{nullptr} {}
+        SpanningTreeAncestorIterator() : dfs_{nullptr}, v_info_{nullptr} {}
 
         SpanningTreeAncestorIterator(const DFS &dfs, vertex_handler v)
-            : v_info_(std::addressof(dfs.info_.at(v))) {}
+            : dfs_{std::addressof(dfs)}, v_info_(std::addressof(dfs.info(v))) {}
 
         reference operator*() const { return *v_info_; }
         pointer operator->() const { return v_info_; }
 
         SpanningTreeAncestorIterator &operator++() {
-            v_info_ = v_info_->predecessor_;
+            const auto predecessor = v_info_->predecessor_;
+            v_info_ = (predecessor == kNone) ? nullptr : std::addressof(dfs_->info_[predecessor]);
             return *this;
         }
 
@@ -65,69 +73,89 @@ class DFS final {
             return old;
         }
 
-        bool operator==(const SpanningTreeAncestorIterator &rhs) const = default;
+        bool operator==(const SpanningTreeAncestorIterator &rhs) const {
+            return v_info_ == rhs.v_info_;
+        }
 
       private:
+        const DFS *dfs_;
         const InfoNode *v_info_;
     };
 
-  private:
-    using InfoContainer = std::unordered_map<vertex_handler, InfoNode>;
-
-  public:
-    using size_type = typename InfoContainer::size_type;
-    using iterator = typename InfoContainer::iterator;
-    using const_iterator = typename InfoContainer::const_iterator;
-
     // st stands for spanning tree
     using const_st_iterator = SpanningTreeAncestorIterator;
     using st_iterator = const_st_iterator;
 
+    // Constructs an object that doesn't hold any traversal; call recompute() to run DFS
+    DFS() = default;
+
     // Note: vertices from already_visited appear neither in in post_order, nor in pre_order
     DFS(graph_type &g, vertex_handler source,
-        std::initializer_list<vertex_handler> already_visited = {})
-        : source_(source) {
+        std::initializer_list<vertex_handler> already_visited = {}) {
+        recompute(g, source, already_visited);
+    }
+
+    DFS(graph_type &g, std::initializer_list<vertex_handler> already_visited = {})
+        : DFS(g, Traits::source(g), already_visited) {}
+
+    // Runs DFS once again reusing the memory allocated by previous runs. Only the entries touched
+    // by the previous run are reset, so the cost is proportional to the size of both traversals
+    // rather than to the size of the graph
+    void recompute(graph_type &g, vertex_handler source,
+                   std::initializer_list<vertex_handler> already_visited = {}) {
         if (std::ranges::contains(already_visited, source)) {
             throw std::invalid_argument{"DFS source shall not be already visited"};
         }
 
+        for (auto i : touched_) {
+            info_[i] = InfoNode{};
+        }
+        touched_.clear();
+        pre_order_.clear();
+        post_order_.clear();
+
+        if (const size_type bound = Traits::index_bound(g); info_.size() < bound) {
+            info_.resize(bound);
+        }
+
+        source_ = source;
+
         for (auto v : already_visited) {
-            info_.emplace(v, v);
+            const auto i = Traits::index(v);
+            info_[i].vertex_ = v;
+            info_[i].visited_ = true;
+            touched_.push_back(i);
         }
 
-        // Intentionally ignore return value, because we don't need time parameter anymore
-        static_cast<void>(do_dfs(g, source_, nullptr, time_type{0}));
+        do_dfs(g);
     }
 
-    DFS(graph_type &g, std::initializer_list<vertex_handler> already_visited = {})
-        : DFS(g, Traits::source(g), already_visited) {}
-
     vertex_handler get_source() const { return source_; }
 
-    bool contains(vertex_handler v) const { return info_.contains(v); }
-
-    const InfoNode &info(vertex_handler v) const { return info_.at(v); }
+    bool contains(vertex_handler v) const {
+        const auto i = Traits::index(v);
+        return i < info_.size() && info_[i].visited_;
+    }
 
-    size_type size() const noexcept { return info_.size(); }
+    const InfoNode &info(vertex_handler v) const {
+        if (!contains(v)) {
+            throw std::out_of_range{"vertex has not been visited by DFS"};
+        }
+        return info_[Traits::index(v)];
+    }
 
-    iterator begin() noexcept { return info_.begin(); }
-    const_iterator begin() const noexcept { return info_.begin(); }
-    const_iterator cbegin() const noexcept { return info_.cbegin(); }
-    iterator end() noexcept { return info_.end(); }
-    const_iterator end() const noexcept { return info_.end(); }
-    const_iterator cend() const noexcept { return info_.cend(); }
+    // Returns the number of vertices reached from the source
+    size_type size() const noexcept { return pre_order_.size(); }
 
-    st_iterator st_begin(vertex_handler v) { return {*this, v}; }
     st_iterator st_begin(vertex_handler v) const { return {*this, v}; }
-    st_iterator st_end() { return {*this, source_}; }
     st_iterator st_end() const { return {*this, source_}; }
 
     auto pre_order() const { return std::ranges::subrange(pre_order_); }
     auto post_order() const { return std::ranges::subrange(post_order_); }
 
     bool is_ancestor_of(vertex_handler v, vertex_handler u) const {
-        const auto &v_info = info_.at(v);
-        const auto &u_info = info_.at(u);
+        const auto &v_info = info(v);
+        const auto &u_info = info(u);
 
         return u_info.get_discovery_time() <= v_info.get_discovery_time() &&
                v_info.get_finished_time() <= u_info.get_finished_time();
@@ -138,29 +166,66 @@ class DFS final {
     }
 
   private:
-    [[nodiscard]] time_type do_dfs(graph_type &g, vertex_handler u, InfoNode *parent,
-                                   time_type time) {
-        auto &u_info = info_.try_emplace(u, u, parent).first->second;
+    struct Frame {
+        vertex_handler vertex;
+        size_type predecessor; // index of the vertex that pushed this frame
+        bool finish;           // true if the frame marks the end of processing of the vertex
+    };
+
+    // Explicit stack traversal yielding exactly the same orders and times as the recursive one:
+    // adjacent vertices are pushed in reverse order and checked for being visited only when
+    // popped, so that the first of them is processed first, and the rest are processed only after
+    // everything reachable from the first one has been finished
+    void do_dfs(graph_type &g) {
+        time_type time = 0;
 
-        u_info.discovery_time_ = ++time;
-        pre_order_.push_back(u);
+        stack_.clear();
+        stack_.push_back(Frame{source_, kNone, false});
 
-        for (vertex_handler v : Traits::adjacent_vertices(g, u)) {
-            if (!info_.contains(v)) {
-                time = do_dfs(g, v, std::addressof(u_info), time);
+        while (!stack_.empty()) {
+            const auto [v, predecessor, finish] = stack_.back();
+            stack_.pop_back();
+
+            const auto i = Traits::index(v);
+            auto &v_info = info_[i];
+
+            if (finish) {
+                v_info.finished_time_ = ++time;
+                post_order_.push_back(v);
+                continue;
+            }
+
+            if (v_info.visited_) {
+                continue;
             }
-        }
 
-        u_info.finished_time_ = ++time;
-        post_order_.push_back(u);
+            v_info.vertex_ = v;
+            v_info.visited_ = true;
+            v_info.predecessor_ = predecessor;
+            v_info.discovery_time_ = ++time;
+            pre_order_.push_back(v);
+            touched_.push_back(i);
 
-        return time;
+            stack_.push_back(Frame{v, kNone, true});
+
+            const auto first = stack_.size();
+            for (vertex_handler u : Traits::adjacent_vertices(g, v)) {
+                if (!info_[Traits::index(u)].visited_) {
+                    stack_.push_back(Frame{u, i, false});
+                }
+            }
+            std::reverse(stack_.begin() + static_cast<std::ptrdiff_t>(first), stack_.end());
+        }
     }
 
-    vertex_handler source_;
-    InfoContainer info_;
+    vertex_handler source_{};
+    std::vector<InfoNode> info_; // indexed by Traits::index
     std::vector<vertex_handler> pre_order_;
     std::vector<vertex_handler> post_order_;
+
+    // scratch buffers reused by recompute()
+    std::vector<size_type> touched_;
+    std::vector<Frame> stack_;
 };
 
 } // namespace bjac
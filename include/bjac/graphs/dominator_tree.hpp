@@ -2,10 +2,16 @@
 #define INCLUDE_BJAC_GRAPHS_DOMINATOR_TREE_HPP
 
 #include <algorithm>
+#include <bit>
 #include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <limits>
 #include <optional>
 #include <ranges>
-#include <unordered_map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 #include "bjac/graphs/dfs.hpp"
 
@@ -16,167 +22,280 @@ class DominatorTree final {
   public:
     using graph_type = typename Traits::graph_type;
     using vertex_handler = typename Traits::vertex_handler;
-
-    struct Edges {
-        std::optional<vertex_handler> idom;
-        std::vector<vertex_handler> successors;
-    };
+    using size_type = std::size_t;
 
   private:
-    using VertexToIDomContainer = std::unordered_map<vertex_handler, Edges>;
+    using VertexContainer = std::vector<vertex_handler>;
 
   public:
-    using const_iterator = typename VertexToIDomContainer::const_iterator;
+    using const_iterator = typename VertexContainer::const_iterator;
     using iterator = const_iterator;
 
     explicit DominatorTree(graph_type &g) : DominatorTree{g, DFS<Traits>{g}} {}
 
-    explicit DominatorTree(graph_type &g, const DFS<Traits> &dfs) {
-        compute_idoms(dfs, compute_semidominators(g, dfs));
+    explicit DominatorTree(graph_type &g, const DFS<Traits> &dfs)
+        : vertices_(std::from_range, dfs.pre_order()), numbers_(Traits::index_bound(g), kNone) {
+        for (size_type n = 0; auto v : vertices_) {
+            numbers_[Traits::index(v)] = n++;
+        }
 
-        v_to_idom_.try_emplace(Traits::source(g));
+        compute_idoms(g, dfs);
 
         // Note: successors are stored in reverse post order. This makes it possible to traverse
         // dominator tree in BFS and yield RPO as a result
+        successors_.resize(vertices_.size());
         for (auto v : dfs.post_order() | std::views::reverse) {
-            auto v_it = v_to_idom_.find(v);
-            assert(v_it != v_to_idom_.end());
-            const auto &maybe_idom = v_it->second.idom;
-            if (maybe_idom) {
-                auto idom_it = v_to_idom_.find(*maybe_idom);
-                assert(idom_it != v_to_idom_.end());
-                idom_it->second.successors.push_back(v);
+            if (auto idom = idoms_[number(v)]; idom != kNone) {
+                successors_[idom].push_back(v);
             }
         }
+
+        compute_intervals();
+        compute_sparse_table();
     }
 
-    bool contains(vertex_handler v) const { return v_to_idom_.contains(v); }
+    bool contains(vertex_handler v) const { return find_number(v) != kNone; }
 
     vertex_handler idom_unchecked(vertex_handler v) const {
         assert(contains(v));
-        return *v_to_idom_.find(v)->second.idom;
+        const auto idom = idoms_[number(v)];
+        assert(idom != kNone);
+        return vertices_[idom];
     }
 
     std::optional<vertex_handler> idom(vertex_handler v) const {
-        if (auto it = v_to_idom_.find(v); it != v_to_idom_.end()) {
-            return it->second.idom;
+        if (auto v_n = find_number(v); v_n != kNone) {
+            if (auto idom = idoms_[v_n]; idom != kNone) {
+                return vertices_[idom];
+            }
         }
         return std::nullopt;
     }
 
+    // Checks whether u strictly dominates v
     bool is_dominator_of(vertex_handler v, vertex_handler u) const {
-        for (;;) {
-            if (auto v_it = v_to_idom_.find(v); v_it == v_to_idom_.end()) {
-                return false;
-            } else if (const auto &idom = v_it->second.idom; !idom.has_value()) {
-                return false;
-            } else if (*idom == u) {
-                return true;
-            } else {
-                v = *idom;
-            }
+        const auto v_n = find_number(v);
+        const auto u_n = find_number(u);
+        return v_n != kNone && u_n != kNone && v_n != u_n && dominates(u_n, v_n);
+    }
+
+    // Returns the deepest vertex of the tree dominating both v and u
+    std::optional<vertex_handler> nearest_common_dominator(vertex_handler v,
+                                                           vertex_handler u) const {
+        auto v_n = find_number(v);
+        auto u_n = find_number(u);
+        if (v_n == kNone || u_n == kNone) {
+            return std::nullopt;
         }
+
+        if (dominates(v_n, u_n)) {
+            return v;
+        }
+        if (dominates(u_n, v_n)) {
+            return u;
+        }
+
+        if (enter_[v_n] > enter_[u_n]) {
+            std::swap(v_n, u_n);
+        }
+
+        // Vertices of tree pre-order in range (enter[v], enter[u]] all lie in the subtree of the
+        // nearest common dominator, which is not in the range itself, and the range contains the
+        // child of the common dominator whose subtree holds u. Hence the common dominator is the
+        // idom coming first in tree pre-order among idoms of the range
+        return vertices_[tree_order_[range_min(enter_[v_n] + 1, enter_[u_n])]];
     }
 
     std::ranges::random_access_range auto successors(vertex_handler v) const {
-        return std::views::all(v_to_idom_.at(v).successors);
+        if (auto v_n = find_number(v); v_n != kNone) {
+            return std::views::all(successors_[v_n]);
+        }
+        throw std::out_of_range{"vertex is not in the dominator tree"};
     }
 
-    const_iterator begin() const { return v_to_idom_.begin(); }
-    const_iterator cbegin() const { return v_to_idom_.cbegin(); }
-    const_iterator end() const { return v_to_idom_.end(); }
-    const_iterator cend() const { return v_to_idom_.cend(); }
+    size_type size() const noexcept { return vertices_.size(); }
+
+    // Iterates over vertices of the tree in DFS pre-order
+    const_iterator begin() const { return vertices_.begin(); }
+    const_iterator cbegin() const { return vertices_.cbegin(); }
+    const_iterator end() const { return vertices_.end(); }
+    const_iterator cend() const { return vertices_.cend(); }
 
   private:
-    using time_type = typename DFS<Traits>::time_type;
+    static constexpr size_type kNone = std::numeric_limits<size_type>::max();
 
-    struct SDom {
-        vertex_handler vertex;
-        time_type time;
-    };
+    size_type find_number(vertex_handler v) const {
+        const auto i = Traits::index(v);
+        return i < numbers_.size() ? numbers_[i] : kNone;
+    }
 
-    using VertexToSDomContainer = std::unordered_map<vertex_handler, SDom>;
+    size_type number(vertex_handler v) const {
+        assert(contains(v));
+        return numbers_[Traits::index(v)];
+    }
 
-    static VertexToSDomContainer compute_semidominators(graph_type &g, const DFS<Traits> &dfs) {
-        auto discovery_time = [&dfs](vertex_handler v) { return dfs.info(v).get_discovery_time(); };
+    // Non-strict dominance on DFS numbers: u dominates v iff pre-order interval of v in the tree
+    // is nested into the one of u
+    bool dominates(size_type u_n, size_type v_n) const {
+        return enter_[u_n] <= enter_[v_n] && exit_[v_n] <= exit_[u_n];
+    }
+
+    // Enumerates vertices of the tree in pre-order and records the interval [enter, exit] of
+    // pre-order indices occupied by the subtree of every vertex
+    void compute_intervals() {
+        const size_type n = vertices_.size();
 
-        VertexToSDomContainer v_to_sdom;
-        v_to_sdom.reserve(dfs.size());
+        tree_order_.clear();
+        tree_order_.reserve(n);
+        enter_.assign(n, 0);
+        exit_.assign(n, 0);
 
-        std::vector<vertex_handler> visited_vertices;
-        visited_vertices.reserve(dfs.size());
+        if (n == 0) {
+            return;
+        }
 
-        for (vertex_handler w : dfs.pre_order() | std::views::drop(1) | std::views::reverse) {
-            auto preds = Traits::predecessors(g, w);
+        std::vector<size_type> stack{0};
+        while (!stack.empty()) {
+            const auto v_n = stack.back();
+            stack.pop_back();
 
-            auto sdom_candidates_1 =
-                preds |
-                std::views::filter([discovery_time, w_time = discovery_time(w)](vertex_handler v) {
-                    return discovery_time(v) < w_time;
-                });
+            enter_[v_n] = tree_order_.size();
+            tree_order_.push_back(v_n);
 
-            auto sdom_candidates_2 =
-                visited_vertices | std::views::filter([&](vertex_handler u) {
-                    return std::ranges::any_of(
-                        preds, [&dfs, u](vertex_handler v) { return dfs.is_ancestor_of(v, u); });
-                }) |
-                std::views::transform([&v_to_sdom](vertex_handler u) {
-                    auto it = v_to_sdom.find(u);
-                    assert(it != v_to_sdom.end());
-                    return it->second.vertex;
-                });
+            for (auto succ : successors_[v_n] | std::views::reverse) {
+                stack.push_back(number(succ));
+            }
+        }
+
+        // a subtree ends where the subtree of its last child ends
+        for (auto v_n : tree_order_ | std::views::reverse) {
+            exit_[v_n] = std::max(exit_[v_n], enter_[v_n]);
+            if (auto idom = idoms_[v_n]; idom != kNone) {
+                exit_[idom] = std::max(exit_[idom], exit_[v_n]);
+            }
+        }
+    }
 
-            vertex_handler sdom = std::ranges::min(
-                std::views::concat(sdom_candidates_1, sdom_candidates_2), {}, discovery_time);
+    // Sparse table answering range minimum queries on pre-order indices of idoms of vertices of
+    // tree_order_ in O(1)
+    void compute_sparse_table() {
+        const size_type n = tree_order_.size();
 
-            v_to_sdom.try_emplace(w, sdom, discovery_time(sdom));
-            visited_vertices.push_back(w);
+        sparse_table_.clear();
+        if (n == 0) {
+            return;
         }
 
-        return v_to_sdom;
+        // the root is never queried
+        std::vector<size_type> idom_enters(n, 0);
+        for (size_type i = 1; i != n; ++i) {
+            idom_enters[i] = enter_[idoms_[tree_order_[i]]];
+        }
+        sparse_table_.push_back(std::move(idom_enters));
+        for (size_type width = 2; width <= n; width *= 2) {
+            const auto &prev = sparse_table_.back();
+            std::vector<size_type> level(n - width + 1);
+            for (size_type i = 0; i != level.size(); ++i) {
+                level[i] = std::min(prev[i], prev[i + width / 2]);
+            }
+            sparse_table_.push_back(std::move(level));
+        }
     }
 
-    void compute_idoms(const DFS<Traits> &dfs, const VertexToSDomContainer &v_to_sdom) {
-        v_to_idom_.reserve(dfs.size());
-
-        auto pre_order = dfs.pre_order() | std::views::drop(1);        // drop entry block
-        static_assert(std::ranges::common_range<decltype(pre_order)>); // to guarantee O(1) reverse
-
-        for (vertex_handler w : pre_order | std::views::reverse) {
-            auto w_it = v_to_sdom.find(w);
-            assert(w_it != v_to_sdom.end());
-            vertex_handler sdom_w = w_it->second.vertex;
-            auto it = std::ranges::min_element(dfs.st_begin(w), dfs.st_begin(sdom_w), {},
-                                               [&](const auto &info) {
-                                                   auto it = v_to_sdom.find(info.get_vertex());
-                                                   assert(it != v_to_sdom.end());
-                                                   return it->second.time;
-                                               });
-            vertex_handler u = it->get_vertex();
-            auto u_it = v_to_sdom.find(u);
-            assert(u_it != v_to_sdom.end());
-            if (vertex_handler sdom_u = u_it->second.vertex; sdom_u == sdom_w) {
-                v_to_idom_.emplace(w, sdom_w);
-            } else {
-                v_to_idom_.emplace(w, u);
+    // Returns the least pre-order index of idoms of tree_order_[first], ..., tree_order_[last]
+    size_type range_min(size_type first, size_type last) const {
+        assert(first <= last && last < tree_order_.size());
+        const auto k = std::bit_width(last - first + 1) - 1;
+        const auto &level = sparse_table_[k];
+        return std::min(level[first], level[last + 1 - (size_type{1} << k)]);
+    }
+
+    // Lengauer-Tarjan algorithm with path compression (the "simple" version without balanced
+    // linking, O(m log n)). Vertices are identified by their positions in DFS pre-order, so the
+    // source is 0 and every vertex has a greater number than its spanning tree parent
+    void compute_idoms(graph_type &g, const DFS<Traits> &dfs) {
+        const size_type n = vertices_.size();
+
+        std::vector<size_type> parent(n, kNone);
+        std::vector<size_type> semi(n);
+        std::vector<size_type> label(n);
+        std::vector<size_type> ancestor(n, kNone);
+
+        // every vertex gets into exactly one bucket, so buckets are stored as intrusive lists
+        std::vector<size_type> bucket_head(n, kNone);
+        std::vector<size_type> bucket_next(n, kNone);
+
+        for (size_type v = 0; v != n; ++v) {
+            semi[v] = label[v] = v;
+        }
+
+        for (size_type v = 1; v < n; ++v) {
+            parent[v] = number(std::next(dfs.st_begin(vertices_[v]))->get_vertex());
+        }
+
+        // path compression is done iteratively not to overflow the stack on deep spanning trees
+        std::vector<size_type> path;
+        auto eval = [&](size_type v) -> size_type {
+            if (ancestor[v] == kNone) {
+                return v;
+            }
+
+            for (auto u = v; ancestor[ancestor[u]] != kNone; u = ancestor[u]) {
+                path.push_back(u);
+            }
+
+            while (!path.empty()) {
+                const auto u = path.back();
+                path.pop_back();
+
+                const auto a = ancestor[u];
+                if (semi[label[a]] < semi[label[u]]) {
+                    label[u] = label[a];
+                }
+                ancestor[u] = ancestor[a];
+            }
+
+            return label[v];
+        };
+
+        idoms_.assign(n, kNone);
+
+        for (size_type w = n - 1; w > 0; --w) {
+            for (vertex_handler pred : Traits::predecessors(g, vertices_[w])) {
+                // unreachable predecessors do not take part in dominance
+                if (auto pred_n = find_number(pred); pred_n != kNone) {
+                    semi[w] = std::min(semi[w], semi[eval(pred_n)]);
+                }
+            }
+
+            bucket_next[w] = bucket_head[semi[w]];
+            bucket_head[semi[w]] = w;
+
+            const auto p = parent[w];
+            ancestor[w] = p; // link(p, w)
+
+            for (auto v = std::exchange(bucket_head[p], kNone); v != kNone; v = bucket_next[v]) {
+                const auto u = eval(v);
+                idoms_[v] = semi[u] < semi[v] ? u : p;
             }
         }
 
-        for (vertex_handler w : pre_order) {
-            auto w_it = v_to_idom_.find(w);
-            assert(w_it != v_to_idom_.end());
-            auto &maybe_idom = w_it->second.idom;
-            assert(maybe_idom.has_value());
-            vertex_handler idom = *maybe_idom;
-            if (idom != v_to_sdom.at(w).vertex) {
-                auto idom_it = v_to_idom_.find(idom);
-                assert(idom_it != v_to_idom_.end());
-                maybe_idom = idom_it->second.idom;
+        for (size_type w = 1; w < n; ++w) {
+            if (idoms_[w] != semi[w]) {
+                idoms_[w] = idoms_[idoms_[w]];
             }
         }
     }
 
-    VertexToIDomContainer v_to_idom_;
+    VertexContainer vertices_;      // DFS number -> vertex
+    std::vector<size_type> numbers_; // Traits::index(vertex) -> DFS number
+    std::vector<size_type> idoms_;
+    std::vector<std::vector<vertex_handler>> successors_;
+
+    std::vector<size_type> tree_order_; // pre-order of the tree in terms of DFS numbers
+    std::vector<size_type> enter_;
+    std::vector<size_type> exit_;
+    std::vector<std::vector<size_type>> sparse_table_;
 };
 
 } // namespace bjac
@@ -28,6 +28,12 @@ struct DefaultGraphTraits {
  * // returns the number of vertices in a graph
  * static size_type n_vertices(const graph_type &g);
  *
+ * // returns such a number that index(v) < index_bound(g) for every vertex v of the graph g
+ * static size_type index_bound(const graph_type &g);
+ *
+ * // returns a dense index of a vertex; graph algorithms use it to keep per-vertex data in arrays
+ * static size_type index(vertex_handler v);
+ *
  * // returns a range which value type is vertex_handler and which contains all vertices in the
  * // given graph
  * static std::ranges::forward_range auto vertices(graph_type &g);
@@ -54,6 +60,8 @@ struct ReverseGraphTraits {
     using vertex_handler = typename Traits::vertex_handler;
 
     static size_type n_vertices(const graph_type &g) { return g.size(); }
+    static size_type index_bound(const graph_type &g) { return Traits::index_bound(g); }
+    static size_type index(vertex_handler v) { return Traits::index(v); }
     static std::ranges::forward_range auto vertices(graph_type &g) { return Traits::vertices(g); }
 
     static std::ranges::forward_range auto adjacent_vertices([[maybe_unused]] graph_type &g,
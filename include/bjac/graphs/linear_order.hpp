@@ -4,7 +4,6 @@
 #include <cassert>
 #include <deque>
 #include <ranges>
-#include <unordered_map>
 #include <vector>
 
 #include "bjac/graphs/dfs.hpp"
@@ -46,15 +45,8 @@ class LinearOrder final : private std::vector<typename Traits::vertex_handler> {
                          const LoopTree<Traits> &loop_tree) {
         this->reserve(Traits::n_vertices(g));
 
-        auto color_table = [&g] {
-            std::unordered_map<vertex_handler, Color> color_table;
-            color_table.reserve(Traits::n_vertices(g));
-            color_table.emplace(Traits::source(g), Color::black);
-            for (auto v : Traits::vertices(g)) {
-                color_table.emplace(v, Color::white);
-            }
-            return color_table;
-        }();
+        std::vector<Color> color_table(Traits::index_bound(g), Color::white);
+        color_table[Traits::index(Traits::source(g))] = Color::black;
 
         std::deque<vertex_handler> queue;
         queue.push_back(Traits::source(g));
@@ -69,15 +61,14 @@ class LinearOrder final : private std::vector<typename Traits::vertex_handler> {
                 // drop(1) not to process the header again
                 for (auto v :
                      loop_tree.get_loop(u).vertices() | std::views::drop(1) | std::views::reverse) {
-                    auto &color = color_table.find(v)->second;
-                    assert(color == Color::white);
-                    color = Color::black;
+                    assert(color_table[Traits::index(v)] == Color::white);
+                    color_table[Traits::index(v)] = Color::black;
                     queue.push_front(v);
                 }
             }
 
             for (auto v : dom_tree.successors(u)) {
-                if (auto &color = color_table.find(v)->second; color == Color::white) {
+                if (auto &color = color_table[Traits::index(v)]; color == Color::white) {
                     color = Color::black;
                     queue.push_back(v);
                 }
@@ -2,11 +2,14 @@
 #define INCLUDE_BJAC_GRAPHS_LOOP_TREE_HPP
 
 #include <concepts>
+#include <cstddef>
 #include <memory>
 #include <ranges>
-#include <unordered_map>
+#include <stdexcept>
 #include <utility>
+#include <vector>
 
+#include "bjac/graphs/dfs.hpp"
 #include "bjac/graphs/dominator_tree.hpp"
 #include "bjac/graphs/graph_traits.hpp"
 #include "bjac/graphs/loop.hpp"
@@ -25,41 +28,57 @@ class LoopTree final {
         : LoopTree{g, dfs, DominatorTree<Traits>{g, dfs}} {}
 
     explicit LoopTree(graph_type &g, const DFS<Traits> &dfs,
-                      const DominatorTree<Traits> &dom_tree) {
+                      const DominatorTree<Traits> &dom_tree)
+        : header_to_loop_(Traits::index_bound(g)) {
+        // one traversal object for all loops not to reallocate its buffers for every back edge
+        DFS<ReverseGraphTraits<Traits>> reverse_dfs;
+
         for (auto [latch, header] : compute_back_edges(g, dfs, dom_tree)) {
             auto loop = std::make_unique<Loop<vertex_handler>>(header);
             loop->add_vertex(header);
 
             if (latch != header) {
-                const DFS<ReverseGraphTraits<Traits>> dfs(g, latch, {header});
-                for (vertex_handler v : dfs.post_order()) {
+                reverse_dfs.recompute(g, latch, {header});
+                for (vertex_handler v : reverse_dfs.post_order()) {
                     loop->add_vertex(v);
-                    if (auto it = header_to_loop_.find(v); it != header_to_loop_.end()) {
-                        auto &inner_loop_ptr = it->second;
+                    if (auto &inner_loop_ptr = header_to_loop_[Traits::index(v)]) {
                         inner_loop_ptr->set_parent_loop(*loop);
                         loop->add_inner_loop(std::move(inner_loop_ptr));
-                        header_to_loop_.erase(it);
+                        --loops_count_;
                     }
                 }
             }
 
-            header_to_loop_.emplace(header, std::move(loop));
+            if (auto &loop_ptr = header_to_loop_[Traits::index(header)]; !loop_ptr) {
+                loop_ptr = std::move(loop);
+                ++loops_count_;
+            }
         }
     }
 
-    std::unsigned_integral auto loops_count() const noexcept { return header_to_loop_.size(); }
+    std::unsigned_integral auto loops_count() const noexcept { return loops_count_; }
 
-    bool is_header(vertex_handler v) const { return header_to_loop_.contains(v); }
+    bool is_header(vertex_handler v) const {
+        const auto i = Traits::index(v);
+        return i < header_to_loop_.size() && header_to_loop_[i] != nullptr;
+    }
 
     template <typename Self>
     auto &get_loop(this Self &&self, vertex_handler header) {
-        return std::forward_like<Self>(*self.header_to_loop_.at(header));
+        if (!self.is_header(header)) {
+            throw std::out_of_range{"vertex is not a header of an outermost loop"};
+        }
+        return std::forward_like<Self>(*self.header_to_loop_[Traits::index(header)]);
     }
 
-    std::ranges::forward_range auto headers() const { return header_to_loop_ | std::views::keys; }
+    std::ranges::forward_range auto headers() const {
+        return loops() |
+               std::views::transform([](auto *loop) static { return loop->get_header(); });
+    }
 
     std::ranges::forward_range auto loops() const {
-        return header_to_loop_ | std::views::values |
+        return header_to_loop_ |
+               std::views::filter([](const auto &loop_ptr) static { return loop_ptr != nullptr; }) |
                std::views::transform([](const auto &loop_ptr) static { return loop_ptr.get(); });
     }
 
@@ -76,7 +95,9 @@ class LoopTree final {
                std::views::join;
     }
 
-    std::unordered_map<vertex_handler, std::unique_ptr<Loop<vertex_handler>>> header_to_loop_;
+    // indexed by Traits::index of the header; only outermost loops are stored here
+    std::vector<std::unique_ptr<Loop<vertex_handler>>> header_to_loop_;
+    std::size_t loops_count_ = 0;
 };
 
 } // namespace bjac
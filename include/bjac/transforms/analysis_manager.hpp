@@ -0,0 +1,100 @@
+#ifndef INCLUDE_BJAC_TRANSFORMS_ANALYSIS_MANAGER_HPP
+#define INCLUDE_BJAC_TRANSFORMS_ANALYSIS_MANAGER_HPP
+
+#include <cstddef>
+#include <optional>
+#include <unordered_map>
+
+#include "bjac/graphs/dfs.hpp"
+#include "bjac/graphs/dominator_tree.hpp"
+#include "bjac/graphs/loop_tree.hpp"
+
+#include "bjac/IR/function.hpp"
+
+namespace bjac {
+
+// Analyses of the control flow graph a pass may preserve. Each of them depends on the previous
+// ones, so dropping an analysis drops all of the following ones too
+enum class Analysis : unsigned char { kDFS, kDominatorTree, kLoopTree };
+
+// Besides the analyses still valid, tells whether the pass has changed the function at all
+class PreservedAnalyses final {
+  public:
+    // The function is left as it was
+    static PreservedAnalyses all() noexcept { return PreservedAnalyses{kAll, false}; }
+    static PreservedAnalyses none() noexcept { return PreservedAnalyses{0, true}; }
+
+    // Analyses surviving changes of instructions that keep the blocks and the edges between them.
+    // All analyses managed now are such ones
+    static PreservedAnalyses cfg() noexcept { return PreservedAnalyses{kAll, true}; }
+
+    PreservedAnalyses &preserve(Analysis analysis) noexcept {
+        mask_ |= bit(analysis);
+        return *this;
+    }
+
+    bool is_preserved(Analysis analysis) const noexcept { return mask_ & bit(analysis); }
+
+    bool is_changed() const noexcept { return changed_; }
+
+    // Analyses preserved by both of two passes run one after another
+    PreservedAnalyses &intersect(PreservedAnalyses other) noexcept {
+        mask_ &= other.mask_;
+        changed_ |= other.changed_;
+        return *this;
+    }
+
+    bool operator==(const PreservedAnalyses &) const = default;
+
+  private:
+    static constexpr unsigned kAll = 0b111;
+
+    PreservedAnalyses(unsigned mask, bool changed) noexcept : mask_{mask}, changed_{changed} {}
+
+    static unsigned bit(Analysis analysis) noexcept {
+        return 1u << static_cast<unsigned>(analysis);
+    }
+
+    unsigned mask_;
+    bool changed_;
+};
+
+// Computes analyses of functions on the first request and keeps them until a pass reports that it
+// has not preserved them. Results are referenced by the analyses depending on them, so they stay
+// at the same addresses as long as they are cached
+class AnalysisManager final {
+  public:
+    using Traits = MutFunctionGraphTraits;
+
+    AnalysisManager() = default;
+
+    AnalysisManager(const AnalysisManager &) = delete;
+    AnalysisManager &operator=(const AnalysisManager &) = delete;
+
+    const DFS<Traits> &dfs(Function &f);
+    const DominatorTree<Traits> &dom_tree(Function &f);
+    const LoopTree<Traits> &loop_tree(Function &f);
+
+    bool is_cached(const Function &f, Analysis analysis) const;
+
+    // Drops the analyses of the function not preserved
+    void invalidate(const Function &f, PreservedAnalyses preserved = PreservedAnalyses::none());
+    void clear() noexcept { results_.clear(); }
+
+    // The number of analyses computed rather than taken from the cache
+    std::size_t computations_count() const noexcept { return computations_count_; }
+
+  private:
+    struct Results {
+        std::optional<DFS<Traits>> dfs;
+        std::optional<DominatorTree<Traits>> dom_tree;
+        std::optional<LoopTree<Traits>> loop_tree;
+    };
+
+    std::unordered_map<const Function *, Results> results_;
+    std::size_t computations_count_ = 0;
+};
+
+} // namespace bjac
+
+#endif // INCLUDE_BJAC_TRANSFORMS_ANALYSIS_MANAGER_HPP
@@ -9,7 +9,10 @@ class CheckEliminationPass final : public PassMixin<CheckEliminationPass> {
   public:
     CheckEliminationPass() = default;
 
-    void run(Function &f);
+  private:
+    friend class PassMixin<CheckEliminationPass>;
+
+    PreservedAnalyses run_impl(Function &f, AnalysisManager &am);
 };
 
 } // namespace bjac
@@ -5,11 +5,16 @@
 
 namespace bjac {
 
+// Folds instructions whose operands are constant instructions. SCCPPass finds these constants too,
+// along with those coming through PHI instructions and from blocks that are never executed
 class ConstantFoldingPass final : public PassMixin<ConstantFoldingPass> {
   public:
     ConstantFoldingPass() = default;
 
-    void run(Function &f);
+  private:
+    friend class PassMixin<ConstantFoldingPass>;
+
+    PreservedAnalyses run_impl(Function &f, AnalysisManager &am);
 };
 
 } // namespace bjac
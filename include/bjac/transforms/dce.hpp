@@ -9,7 +9,10 @@ class DCE final : public PassMixin<DCE> {
   public:
     DCE() = default;
 
-    void run(Function &f);
+  private:
+    friend class PassMixin<DCE>;
+
+    PreservedAnalyses run_impl(Function &f, AnalysisManager &am);
 };
 
 } // namespace bjac
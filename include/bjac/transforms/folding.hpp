@@ -0,0 +1,26 @@
+#ifndef INCLUDE_BJAC_TRANSFORMS_FOLDING_HPP
+#define INCLUDE_BJAC_TRANSFORMS_FOLDING_HPP
+
+#include <cstdint>
+#include <optional>
+
+#include "bjac/IR/icmp_instruction.hpp"
+#include "bjac/IR/instruction.hpp"
+#include "bjac/IR/type.hpp"
+
+namespace bjac {
+
+// Evaluation rules shared by the passes computing instructions at compile time. Values are
+// truncated to the width of the type. Division by zero and shifts by the width of the type or more
+// are not evaluated
+std::optional<std::uintmax_t> fold_binary_operator(Instruction::Opcode opcode, const Type &type,
+                                                  std::uintmax_t lhs, std::uintmax_t rhs);
+
+bool fold_icmp(ICmpInstruction::Kind kind, std::uintmax_t lhs, std::uintmax_t rhs);
+
+// Value of a binary operator or an icmp instruction whose operands are constant instructions
+std::optional<std::uintmax_t> fold(const Instruction &instr);
+
+} // namespace bjac
+
+#endif // INCLUDE_BJAC_TRANSFORMS_FOLDING_HPP
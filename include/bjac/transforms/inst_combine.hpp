@@ -0,0 +1,31 @@
+#ifndef INCLUDE_BJAC_TRANSFORMS_INST_COMBINE_HPP
+#define INCLUDE_BJAC_TRANSFORMS_INST_COMBINE_HPP
+
+#include <cstddef>
+
+#include "bjac/transforms/pass.hpp"
+
+namespace bjac {
+
+// Simplifies binary operators and icmp instructions with a worklist: whenever an instruction is
+// rewritten, its users and operands are revisited, so the function reaches a fixed point in one
+// run. Instructions with constant operands are folded by the rules of ConstantFoldingPass, and
+// computations left without users are erased
+class InstCombinePass final : public PassMixin<InstCombinePass> {
+  public:
+    InstCombinePass() = default;
+
+    // Instructions rewritten or erased by all runs of the pass
+    std::size_t rewrites_count() const noexcept { return rewrites_count_; }
+
+  private:
+    friend class PassMixin<InstCombinePass>;
+
+    PreservedAnalyses run_impl(Function &f, AnalysisManager &am);
+
+    std::size_t rewrites_count_ = 0;
+};
+
+} // namespace bjac
+
+#endif // INCLUDE_BJAC_TRANSFORMS_INST_COMBINE_HPP
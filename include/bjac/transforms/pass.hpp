@@ -3,12 +3,28 @@
 
 #include "bjac/IR/function.hpp"
 
+#include "bjac/transforms/analysis_manager.hpp"
+
 namespace bjac {
 
+// A pass implements PreservedAnalyses run_impl(Function &, AnalysisManager &) taking analyses from
+// the manager and reporting those still valid after it. A pass changing nothing returns all(), and
+// a pass changing only instructions returns cfg()
 template <typename Pass>
 class PassMixin {
   public:
-    void run(Function &f) { static_cast<Pass *>(this)->run(f); }
+    // Runs the pass with analyses computed for this run only
+    void run(Function &f) {
+        AnalysisManager am;
+        run(f, am);
+    }
+
+    // Runs the pass with analyses cached by the manager and drops those the pass has not preserved
+    PreservedAnalyses run(Function &f, AnalysisManager &am) {
+        const auto preserved = static_cast<Pass *>(this)->run_impl(f, am);
+        am.invalidate(f, preserved);
+        return preserved;
+    }
 };
 
 } // namespace bjac
@@ -0,0 +1,326 @@
+#ifndef INCLUDE_BJAC_TRANSFORMS_PATTERN_MATCH_HPP
+#define INCLUDE_BJAC_TRANSFORMS_PATTERN_MATCH_HPP
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "bjac/IR/binary_operator.hpp"
+#include "bjac/IR/constant_instruction.hpp"
+#include "bjac/IR/instruction.hpp"
+
+// Declarative rules over instruction trees, e.g.
+//
+//     Rule{m_c_Add(m_Value(x), m_Zero()), [](BinaryOperator &, const Bindings &b) static {
+//         return b[x];
+//     }}
+//
+// Rules are collected into a RuleSet, which merges the rules of every opcode into a decision made
+// on the opcodes of the instruction and of its operands before any rule is tried
+namespace bjac::pattern {
+
+inline constexpr std::size_t kOpcodesCount = std::to_underlying(Instruction::Opcode::kOtherEnd);
+
+// Set of opcodes an instruction matched by a pattern may have
+using OpcodeMask = std::uint32_t;
+static_assert(kOpcodesCount <= std::numeric_limits<OpcodeMask>::digits);
+
+inline constexpr OpcodeMask kAnyOpcode = std::numeric_limits<OpcodeMask>::max();
+
+constexpr OpcodeMask mask_of(Instruction::Opcode opcode) noexcept {
+    return OpcodeMask{1} << std::to_underlying(opcode);
+}
+
+inline constexpr std::size_t kMaxBindings = 4;
+
+// Placeholder naming an instruction bound by a pattern
+template <std::size_t I>
+struct Var final {
+    static_assert(I < kMaxBindings);
+    static constexpr std::size_t kIndex = I;
+};
+
+inline constexpr Var<0> x;
+inline constexpr Var<1> y;
+inline constexpr Var<2> c1;
+inline constexpr Var<3> c2;
+
+class Bindings final {
+  public:
+    template <std::size_t I>
+    Instruction *operator[](Var<I>) const noexcept {
+        return values_[I];
+    }
+
+    // Value of a placeholder bound by m_Constant() or by a constant pattern
+    template <std::size_t I>
+    std::uintmax_t constant(Var<I>) const noexcept {
+        return static_cast<const ConstInstruction *>(values_[I])->get_value();
+    }
+
+    template <std::size_t I>
+    void bind(Var<I>, Instruction *instr) noexcept {
+        values_[I] = instr;
+    }
+
+  private:
+    std::array<Instruction *, kMaxBindings> values_{};
+};
+
+template <typename P>
+concept Pattern = requires(const P &pattern, Instruction *instr, Bindings &bindings) {
+    { P::kOpcodes } -> std::convertible_to<OpcodeMask>;
+    { pattern.match(instr, bindings) } -> std::same_as<bool>;
+};
+
+// Leaf patterns ===================================================================================
+
+struct AnyPattern final {
+    static constexpr OpcodeMask kOpcodes = kAnyOpcode;
+
+    bool match([[maybe_unused]] Instruction *instr, [[maybe_unused]] Bindings &bindings) const {
+        return true;
+    }
+};
+
+template <std::size_t I>
+struct ValuePattern final {
+    static constexpr OpcodeMask kOpcodes = kAnyOpcode;
+
+    bool match(Instruction *instr, Bindings &bindings) const {
+        bindings.bind(Var<I>{}, instr);
+        return true;
+    }
+};
+
+// Matches the instruction bound to the placeholder by a pattern matched before
+template <std::size_t I>
+struct DeferredPattern final {
+    static constexpr OpcodeMask kOpcodes = kAnyOpcode;
+
+    bool match(Instruction *instr, Bindings &bindings) const {
+        return bindings[Var<I>{}] == instr;
+    }
+};
+
+enum class ConstantKind { kAny, kZero, kOne, kAllOnes };
+
+inline constexpr std::size_t kUnbound = kMaxBindings;
+
+template <ConstantKind kKind, std::size_t I = kUnbound>
+struct ConstantPattern final {
+    static constexpr OpcodeMask kOpcodes = mask_of(Instruction::Opcode::kConst);
+
+    bool match(Instruction *instr, Bindings &bindings) const {
+        if (instr->get_opcode() != Instruction::Opcode::kConst) {
+            return false;
+        }
+
+        const auto &constant = static_cast<const ConstInstruction &>(*instr);
+        if constexpr (kKind == ConstantKind::kZero) {
+            if (constant.get_value() != 0) {
+                return false;
+            }
+        } else if constexpr (kKind == ConstantKind::kOne) {
+            if (constant.get_value() != 1) {
+                return false;
+            }
+        } else if constexpr (kKind == ConstantKind::kAllOnes) {
+            if (constant.get_value() != constant.max_value()) {
+                return false;
+            }
+        }
+
+        if constexpr (I != kUnbound) {
+            bindings.bind(Var<I>{}, instr);
+        }
+        return true;
+    }
+};
+
+constexpr AnyPattern m_Any() noexcept { return {}; }
+
+template <std::size_t I>
+constexpr ValuePattern<I> m_Value(Var<I>) noexcept {
+    return {};
+}
+
+template <std::size_t I>
+constexpr DeferredPattern<I> m_Deferred(Var<I>) noexcept {
+    return {};
+}
+
+template <std::size_t I>
+constexpr ConstantPattern<ConstantKind::kAny, I> m_Constant(Var<I>) noexcept {
+    return {};
+}
+
+#define BJAC_CONSTANT_PATTERN(Name, Kind)                                                          \
+    constexpr ConstantPattern<ConstantKind::Kind> m_##Name() noexcept { return {}; }               \
+                                                                                                   \
+    template <std::size_t I>                                                                       \
+    constexpr ConstantPattern<ConstantKind::Kind, I> m_##Name(Var<I>) noexcept {                   \
+        return {};                                                                                 \
+    }
+
+BJAC_CONSTANT_PATTERN(Zero, kZero)
+BJAC_CONSTANT_PATTERN(One, kOne)
+BJAC_CONSTANT_PATTERN(AllOnes, kAllOnes)
+
+#undef BJAC_CONSTANT_PATTERN
+
+// Binary operators ================================================================================
+
+// Commutable patterns also try the operands swapped. Placeholders are bound left to right, so
+// m_Deferred() may only refer to placeholders to the left of it
+template <Instruction::Opcode kOpcode, Pattern L, Pattern R, bool kCommutable>
+struct BinaryPattern final {
+    static constexpr OpcodeMask kOpcodes = mask_of(kOpcode);
+    static constexpr OpcodeMask kLhsOpcodes = kCommutable ? L::kOpcodes | R::kOpcodes : L::kOpcodes;
+    static constexpr OpcodeMask kRhsOpcodes = kCommutable ? L::kOpcodes | R::kOpcodes : R::kOpcodes;
+
+    bool match(Instruction *instr, Bindings &bindings) const {
+        return instr->get_opcode() == kOpcode &&
+               match_operands(static_cast<BinaryOperator &>(*instr), bindings);
+    }
+
+    bool match_operands(BinaryOperator &bin_op, Bindings &bindings) const {
+        auto *op_lhs = bin_op.get_lhs();
+        auto *op_rhs = bin_op.get_rhs();
+        if (lhs.match(op_lhs, bindings) && rhs.match(op_rhs, bindings)) {
+            return true;
+        }
+        if constexpr (kCommutable) {
+            return lhs.match(op_rhs, bindings) && rhs.match(op_lhs, bindings);
+        } else {
+            return false;
+        }
+    }
+
+    [[no_unique_address]] L lhs;
+    [[no_unique_address]] R rhs;
+};
+
+#define HANDLE_BINARY_INSTR(N, Opcode, Class, Name)                                                \
+    template <Pattern L, Pattern R>                                                                \
+    constexpr auto m_##Opcode(L lhs, R rhs) noexcept {                                             \
+        return BinaryPattern<Instruction::Opcode::k##Opcode, L, R, false>{lhs, rhs};               \
+    }                                                                                              \
+                                                                                                   \
+    template <Pattern L, Pattern R>                                                                \
+    constexpr auto m_c_##Opcode(L lhs, R rhs) noexcept {                                           \
+        return BinaryPattern<Instruction::Opcode::k##Opcode, L, R, true>{lhs, rhs};                \
+    }
+#include "bjac/IR/instructions.def"
+
+// Rules ===========================================================================================
+
+template <typename P>
+concept RootPattern = Pattern<P> && requires {
+    { P::kLhsOpcodes } -> std::convertible_to<OpcodeMask>;
+    { P::kRhsOpcodes } -> std::convertible_to<OpcodeMask>;
+};
+
+// The action gets the matched instruction and returns the value replacing it, the instruction
+// itself if it has been changed in place, or nullptr if the rule turned out not to apply
+template <RootPattern P, typename Action>
+    requires std::is_invocable_r_v<Instruction *, const Action &, BinaryOperator &,
+                                   const Bindings &>
+struct Rule final {
+    using pattern_type = P;
+
+    [[no_unique_address]] P pattern;
+    [[no_unique_address]] Action action;
+};
+
+namespace detail {
+
+using RuleMask = std::uint64_t;
+
+// For every opcode, the set of rules whose pattern admits the opcode at the given position
+template <std::size_t N>
+constexpr auto rules_by_opcode(const std::array<OpcodeMask, N> &masks) {
+    std::array<RuleMask, kOpcodesCount> table{};
+    for (std::size_t rule = 0; rule != N; ++rule) {
+        for (std::size_t opcode = 0; opcode != kOpcodesCount; ++opcode) {
+            if ((masks[rule] >> opcode & 1) != 0) {
+                table[opcode] |= RuleMask{1} << rule;
+            }
+        }
+    }
+    return table;
+}
+
+} // namespace detail
+
+// Rules are tried in the order they are given, the first one applied wins. The opcodes of the
+// instruction and of its operands select the rules that may match with three table lookups, and
+// only those rules check the rest of their patterns
+template <typename... Rules>
+class RuleSet final {
+    static_assert(sizeof...(Rules) <= std::numeric_limits<detail::RuleMask>::digits);
+
+  public:
+    constexpr explicit RuleSet(Rules... rules) : rules_{rules...} {}
+
+    static constexpr std::size_t size() noexcept { return sizeof...(Rules); }
+
+    // Returns what the action of the applied rule returns, or nullptr if no rule applies
+    Instruction *apply(Instruction &instr) const {
+        auto candidates = kByRoot[std::to_underlying(instr.get_opcode())];
+        if (candidates == 0) {
+            return nullptr;
+        }
+
+        auto &bin_op = static_cast<BinaryOperator &>(instr);
+        candidates &= kByLhs[std::to_underlying(bin_op.get_lhs()->get_opcode())];
+        candidates &= kByRhs[std::to_underlying(bin_op.get_rhs()->get_opcode())];
+
+        for (; candidates != 0; candidates &= candidates - 1) {
+            if (auto *result = kAppliers[std::countr_zero(candidates)](*this, bin_op)) {
+                return result;
+            }
+        }
+        return nullptr;
+    }
+
+  private:
+    using Applier = Instruction *(*)(const RuleSet &, BinaryOperator &);
+
+    template <std::size_t I>
+    static Instruction *apply_rule(const RuleSet &rule_set, BinaryOperator &bin_op) {
+        const auto &rule = std::get<I>(rule_set.rules_);
+        // the opcode of the root has been checked by the lookup
+        if (Bindings bindings; rule.pattern.match_operands(bin_op, bindings)) {
+            return rule.action(bin_op, bindings);
+        }
+        return nullptr;
+    }
+
+    static constexpr std::array<OpcodeMask, sizeof...(Rules)> kRootMasks{
+        Rules::pattern_type::kOpcodes...};
+    static constexpr std::array<OpcodeMask, sizeof...(Rules)> kLhsMasks{
+        Rules::pattern_type::kLhsOpcodes...};
+    static constexpr std::array<OpcodeMask, sizeof...(Rules)> kRhsMasks{
+        Rules::pattern_type::kRhsOpcodes...};
+
+    static constexpr auto kByRoot = detail::rules_by_opcode(kRootMasks);
+    static constexpr auto kByLhs = detail::rules_by_opcode(kLhsMasks);
+    static constexpr auto kByRhs = detail::rules_by_opcode(kRhsMasks);
+
+    static constexpr auto kAppliers = []<std::size_t... Is>(std::index_sequence<Is...>) {
+        return std::array<Applier, sizeof...(Rules)>{&apply_rule<Is>...};
+    }(std::index_sequence_for<Rules...>{});
+
+    std::tuple<Rules...> rules_;
+};
+
+} // namespace bjac::pattern
+
+#endif // INCLUDE_BJAC_TRANSFORMS_PATTERN_MATCH_HPP
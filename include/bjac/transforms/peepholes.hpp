@@ -9,7 +9,10 @@ class PeepholePass final : public PassMixin<PeepholePass> {
   public:
     PeepholePass() = default;
 
-    void run(Function &f);
+  private:
+    friend class PassMixin<PeepholePass>;
+
+    PreservedAnalyses run_impl(Function &f, AnalysisManager &am);
 };
 
 } // namespace bjac
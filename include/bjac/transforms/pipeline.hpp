@@ -0,0 +1,90 @@
+#ifndef INCLUDE_BJAC_TRANSFORMS_PIPELINE_HPP
+#define INCLUDE_BJAC_TRANSFORMS_PIPELINE_HPP
+
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "bjac/IR/function.hpp"
+
+#include "bjac/transforms/analysis_manager.hpp"
+#include "bjac/transforms/pass.hpp"
+
+namespace bjac {
+
+// Runs a sequence of passes sharing one analysis manager and collects statistics of every pass in
+// the sequence. The time of a pass includes the analyses it has requested and not found cached
+class PassPipeline final {
+  public:
+    using Runner = std::function<PreservedAnalyses(Function &, AnalysisManager &)>;
+
+    struct Options {
+        // Repeat the sequence while some pass changes the function
+        bool fixed_point = false;
+        // Bounds the number of repetitions in case passes undo the changes of each other
+        std::size_t max_iterations = 16;
+    };
+
+    struct PassStats {
+        std::string name;
+        std::size_t runs = 0;
+        // runs that changed the function
+        std::size_t changes = 0;
+        std::chrono::duration<double, std::milli> time{};
+        std::size_t instructions_added = 0;
+        std::size_t instructions_removed = 0;
+        // chunks allocated from the arena of the function
+        std::size_t allocations = 0;
+    };
+
+    PassPipeline() : PassPipeline{Options{}} {}
+    explicit PassPipeline(Options options) : options_{options} {}
+
+    // The spec lists passes separated by commas, e.g. "constant-folding, peepholes, dce".
+    // Throws std::invalid_argument if a name is not one of known_passes()
+    explicit PassPipeline(std::string_view spec, Options options = {});
+
+    static std::span<const std::string_view> known_passes() noexcept;
+
+    template <typename Pass>
+        requires std::derived_from<Pass, PassMixin<Pass>>
+    PassPipeline &add(std::string name, Pass pass = Pass{}) {
+        return add(std::move(name), [pass = std::move(pass)](Function &f,
+                                                             AnalysisManager &am) mutable {
+            return pass.run(f, am);
+        });
+    }
+
+    PassPipeline &add(std::string name, Runner runner);
+
+    // Returns the number of times the sequence has been run
+    std::size_t run(Function &f, AnalysisManager &am);
+    std::size_t run(Function &f) {
+        AnalysisManager am;
+        return run(f, am);
+    }
+
+    // Accumulated over all runs of the pipeline, in the order of the passes
+    std::span<const PassStats> stats() const noexcept { return stats_; }
+    std::size_t iterations_count() const noexcept { return iterations_count_; }
+
+    void print_stats(std::ostream &os) const;
+    std::string stats_to_json() const;
+
+  private:
+    Options options_;
+    std::vector<Runner> runners_;
+    std::vector<PassStats> stats_;
+    std::size_t iterations_count_ = 0;
+};
+
+} // namespace bjac
+
+#endif // INCLUDE_BJAC_TRANSFORMS_PIPELINE_HPP
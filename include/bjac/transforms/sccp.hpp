@@ -0,0 +1,35 @@
+#ifndef INCLUDE_BJAC_TRANSFORMS_SCCP_HPP
+#define INCLUDE_BJAC_TRANSFORMS_SCCP_HPP
+
+#include <cstddef>
+
+#include "bjac/transforms/pass.hpp"
+
+namespace bjac {
+
+// Sparse conditional constant propagation by Wegman and Zadeck. Values are propagated along SSA
+// edges only through blocks reachable by branches whose conditions aren't known to be constant, so
+// constants passing through PHI instructions and loops are found too. Instructions computing
+// constants are replaced with constant instructions, and branches on constant conditions become
+// jumps. Blocks and instructions left unreachable or unused are removed by the following DCE
+class SCCPPass final : public PassMixin<SCCPPass> {
+  public:
+    SCCPPass() = default;
+
+    // Instructions replaced with constants by all runs of the pass
+    std::size_t folded_instructions_count() const noexcept { return folded_instructions_count_; }
+    // Conditional branches replaced with jumps by all runs of the pass
+    std::size_t folded_branches_count() const noexcept { return folded_branches_count_; }
+
+  private:
+    friend class PassMixin<SCCPPass>;
+
+    PreservedAnalyses run_impl(Function &f, AnalysisManager &am);
+
+    std::size_t folded_instructions_count_ = 0;
+    std::size_t folded_branches_count_ = 0;
+};
+
+} // namespace bjac
+
+#endif // INCLUDE_BJAC_TRANSFORMS_SCCP_HPP
@@ -0,0 +1,145 @@
+#ifndef INCLUDE_BJAC_UTILS_ARENA_HPP
+#define INCLUDE_BJAC_UTILS_ARENA_HPP
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace bjac {
+
+// Slab allocator for small objects. Memory is bump-allocated from slabs of kSlabSize bytes;
+// deallocated chunks go to free lists, one per size class, and are reused by subsequent
+// allocations of the same size class. All slabs are released at once when the arena is destroyed,
+// so objects owning nothing but chunks of the arena need not be destroyed one by one.
+//
+// Slabs are aligned to their size and start with a pointer to the arena, so owner() finds the arena
+// by the address of a chunk. Allocations greater than kMaxChunkSize bypass slabs and are forwarded
+// to the global operator new; those not deallocated by then are released with the slabs.
+class Arena final : public std::pmr::memory_resource {
+  public:
+    static constexpr std::size_t kSlabSize = 64 * 1024;
+    static constexpr std::size_t kGranularity = alignof(std::max_align_t);
+    static constexpr std::size_t kMaxChunkSize = 1024;
+
+    Arena() = default;
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    Arena(Arena &&) = delete("chunks refer to the arena by its address");
+    Arena &operator=(Arena &&) = delete("chunks refer to the arena by its address");
+
+    ~Arena() override {
+        for (void *slab : slabs_) {
+            ::operator delete(slab, std::align_val_t{kSlabSize});
+        }
+        for (auto [chunk, alignment] : large_chunks_) {
+            ::operator delete(chunk, std::align_val_t{alignment});
+        }
+    }
+
+    // Returns the arena that allocated p. p shall be a chunk of at most kMaxChunkSize bytes
+    static Arena &owner(const void *p) noexcept {
+        const auto slab = reinterpret_cast<std::uintptr_t>(p) & ~(kSlabSize - 1);
+        return *reinterpret_cast<const SlabHeader *>(slab)->arena;
+    }
+
+    std::size_t slabs_count() const noexcept { return slabs_.size(); }
+
+    // Chunks handed out and taken back over the lifetime of the arena, large ones included
+    std::size_t allocations_count() const noexcept { return allocations_count_; }
+    std::size_t deallocations_count() const noexcept { return deallocations_count_; }
+
+  private:
+    struct SlabHeader {
+        Arena *arena;
+    };
+
+    struct FreeChunk {
+        FreeChunk *next;
+    };
+
+    static constexpr std::size_t kHeaderSize =
+        (sizeof(SlabHeader) + kGranularity - 1) / kGranularity * kGranularity;
+
+    static constexpr std::size_t size_class(std::size_t bytes) noexcept {
+        return (bytes + kGranularity - 1) / kGranularity;
+    }
+
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+        ++allocations_count_;
+        if (bytes > kMaxChunkSize || alignment > kGranularity) {
+            void *chunk = ::operator new(bytes, std::align_val_t{alignment});
+            try {
+                large_chunks_.emplace(chunk, alignment);
+            } catch (...) {
+                ::operator delete(chunk, std::align_val_t{alignment});
+                throw;
+            }
+            return chunk;
+        }
+
+        const auto sc = size_class(bytes == 0 ? 1 : bytes);
+        if (auto *chunk = free_lists_[sc]) {
+            free_lists_[sc] = chunk->next;
+            return chunk;
+        }
+
+        const auto chunk_size = sc * kGranularity;
+        if (static_cast<std::size_t>(end_ - current_) < chunk_size) {
+            add_slab();
+        }
+
+        return std::exchange(current_, current_ + chunk_size);
+    }
+
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override {
+        ++deallocations_count_;
+        if (bytes > kMaxChunkSize || alignment > kGranularity) {
+            large_chunks_.erase(p);
+            ::operator delete(p, bytes, std::align_val_t{alignment});
+            return;
+        }
+
+        assert(std::addressof(owner(p)) == this);
+
+        const auto sc = size_class(bytes == 0 ? 1 : bytes);
+        free_lists_[sc] = ::new (p) FreeChunk{free_lists_[sc]};
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+
+    void add_slab() {
+        // reserve the place for the slab first not to leak it if push_back throws
+        auto &slab_ptr = slabs_.emplace_back(nullptr);
+        auto *slab =
+            static_cast<std::byte *>(::operator new(kSlabSize, std::align_val_t{kSlabSize}));
+        slab_ptr = slab;
+
+        ::new (slab) SlabHeader{this};
+        current_ = slab + kHeaderSize;
+        end_ = slab + kSlabSize;
+    }
+
+    std::vector<void *> slabs_;
+    // chunks bypassing slabs and their alignments
+    std::unordered_map<void *, std::size_t> large_chunks_;
+    std::byte *current_ = nullptr;
+    std::byte *end_ = nullptr;
+    std::array<FreeChunk *, kMaxChunkSize / kGranularity + 1> free_lists_{};
+    std::size_t allocations_count_ = 0;
+    std::size_t deallocations_count_ = 0;
+};
+
+} // namespace bjac
+
+#endif // INCLUDE_BJAC_UTILS_ARENA_HPP
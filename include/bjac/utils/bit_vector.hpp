@@ -0,0 +1,164 @@
+#ifndef INCLUDE_BJAC_UTILS_BIT_VECTOR_HPP
+#define INCLUDE_BJAC_UTILS_BIT_VECTOR_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+namespace bjac {
+
+// Fixed-size dense set of integers [0; size). Set operations process whole words in plain loops
+// without branches, so compilers vectorize them
+class BitVector final {
+  public:
+    using word_type = std::uint64_t;
+
+    static constexpr std::size_t kWordBits = std::numeric_limits<word_type>::digits;
+
+  private:
+    // Iterates over indices of set bits in ascending order
+    class set_bit_iterator final {
+      public:
+        using difference_type = std::ptrdiff_t;
+        using value_type = std::size_t;
+        using iterator_category = std::forward_iterator_tag;
+
+        set_bit_iterator() = default;
+        set_bit_iterator(const word_type *word, const word_type *last) noexcept
+            : word_{word}, last_{last} {
+            skip_empty();
+        }
+
+        value_type operator*() const noexcept {
+            assert(bits_ != 0);
+            return base_ + std::countr_zero(bits_);
+        }
+
+        set_bit_iterator &operator++() noexcept {
+            bits_ &= bits_ - 1; // clears the lowest set bit
+            if (bits_ == 0) {
+                ++word_;
+                base_ += kWordBits;
+                skip_empty();
+            }
+            return *this;
+        }
+        set_bit_iterator operator++(int) noexcept {
+            auto old = *this;
+            ++*this;
+            return old;
+        }
+
+        friend bool operator==(const set_bit_iterator &lhs, const set_bit_iterator &rhs) noexcept {
+            return lhs.word_ == rhs.word_ && lhs.bits_ == rhs.bits_;
+        }
+
+      private:
+        void skip_empty() noexcept {
+            for (; word_ != last_; ++word_, base_ += kWordBits) {
+                if (*word_ != 0) {
+                    bits_ = *word_;
+                    return;
+                }
+            }
+            bits_ = 0;
+        }
+
+        const word_type *word_ = nullptr;
+        const word_type *last_ = nullptr;
+        word_type bits_ = 0;
+        std::size_t base_ = 0;
+    };
+
+  public:
+    using const_iterator = set_bit_iterator;
+    using iterator = const_iterator;
+
+    BitVector() = default;
+
+    explicit BitVector(std::size_t size)
+        : words_((size + kWordBits - 1) / kWordBits), size_{size} {}
+
+    std::size_t size() const noexcept { return size_; }
+
+    bool none() const noexcept {
+        return std::ranges::all_of(words_, [](word_type w) static { return w == 0; });
+    }
+    bool any() const noexcept { return !none(); }
+
+    std::size_t count() const noexcept {
+        std::size_t n = 0;
+        for (auto w : words_) {
+            n += std::popcount(w);
+        }
+        return n;
+    }
+
+    bool test(std::size_t i) const noexcept {
+        assert(i < size_);
+        return (words_[i / kWordBits] >> (i % kWordBits)) & 1;
+    }
+
+    void set(std::size_t i) noexcept {
+        assert(i < size_);
+        words_[i / kWordBits] |= word_type{1} << (i % kWordBits);
+    }
+
+    void reset(std::size_t i) noexcept {
+        assert(i < size_);
+        words_[i / kWordBits] &= ~(word_type{1} << (i % kWordBits));
+    }
+
+    void clear() noexcept { std::ranges::fill(words_, 0); }
+
+    BitVector &operator|=(const BitVector &other) noexcept {
+        assert(size_ == other.size_);
+        for (std::size_t i = 0; i != words_.size(); ++i) {
+            words_[i] |= other.words_[i];
+        }
+        return *this;
+    }
+
+    BitVector &operator&=(const BitVector &other) noexcept {
+        assert(size_ == other.size_);
+        for (std::size_t i = 0; i != words_.size(); ++i) {
+            words_[i] &= other.words_[i];
+        }
+        return *this;
+    }
+
+    // Removes all elements of other from the set
+    BitVector &subtract(const BitVector &other) noexcept {
+        assert(size_ == other.size_);
+        for (std::size_t i = 0; i != words_.size(); ++i) {
+            words_[i] &= ~other.words_[i];
+        }
+        return *this;
+    }
+
+    const_iterator begin() const noexcept {
+        return {words_.data(), words_.data() + words_.size()};
+    }
+    const_iterator cbegin() const noexcept { return begin(); }
+
+    const_iterator end() const noexcept {
+        const auto *last = words_.data() + words_.size();
+        return {last, last};
+    }
+    const_iterator cend() const noexcept { return end(); }
+
+    bool operator==(const BitVector &) const = default;
+
+  private:
+    std::vector<word_type> words_;
+    std::size_t size_ = 0;
+};
+
+} // namespace bjac
+
+#endif // INCLUDE_BJAC_UTILS_BIT_VECTOR_HPP
@@ -215,6 +215,12 @@ class ilist {
     }
 
   protected:
+    // Forgets all nodes without destroying them, for owners releasing their memory in bulk
+    void release_all() noexcept {
+        sentinel_.reset();
+        size_ = 0;
+    }
+
     static iterator get_iterator(node_type &node) noexcept {
         return iterator{std::addressof(node)};
     }
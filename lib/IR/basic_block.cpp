@@ -1,24 +1,87 @@
+#include <algorithm>
 #include <cassert>
 #include <format>
-#include <iterator>
+#include <memory>
 #include <ostream>
 #include <ranges>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include "bjac/IR/basic_block.hpp"
 #include "bjac/IR/call_instruction.hpp"
 #include "bjac/IR/function.hpp"
+#include "bjac/IR/phi_instruction.hpp"
 
 namespace bjac {
 
 BasicBlock::BasicBlock(Function &parent)
-    : Value{std::make_unique<NoneType>()}, first_non_phi_{end()}, parent_{std::addressof(parent)},
-      id_{parent.get_next_bb_id()}, next_instr_id_{0} {}
+    : Value{NoneType::get()}, first_non_phi_{end()}, parent_{std::addressof(parent)},
+      id_{parent.get_next_bb_id()}, next_instr_id_{0},
+      predecessors_(Edges<4>::allocator_type{std::addressof(parent.get_arena())}),
+      successors_(Edges<2>::allocator_type{std::addressof(parent.get_arena())}) {}
+
+Arena &BasicBlock::get_arena() noexcept { return get_parent().get_arena(); }
+
+void BasicBlock::add_predecessor(BasicBlock &bb) {
+    if (predecessor_index(bb)) {
+        return;
+    }
+
+    predecessors_.push_back(std::addressof(bb));
+    for (auto &phi : phi_instructions()) {
+        static_cast<PHIInstruction &>(phi).add_incoming();
+    }
+}
+
+void BasicBlock::remove_predecessor(BasicBlock &bb) {
+    const auto i = predecessor_index(bb);
+    if (!i) {
+        return;
+    }
+
+    predecessors_[*i] = predecessors_.back();
+    predecessors_.pop_back();
+    for (auto &phi : phi_instructions()) {
+        static_cast<PHIInstruction &>(phi).remove_incoming(*i);
+    }
+}
+
+void BasicBlock::replace_predecessor(BasicBlock &from, BasicBlock &to) noexcept {
+    if (auto i = predecessor_index(from)) {
+        assert(!predecessor_index(to));
+        predecessors_[*i] = std::addressof(to);
+    }
+}
+
+void BasicBlock::replace_successor(std::size_t i, BasicBlock &bb) {
+    assert(i < successors_.size());
+    auto *old = std::exchange(successors_[i], std::addressof(bb));
+    if (!std::ranges::contains(successors_, old)) {
+        old->remove_predecessor(*this);
+    }
+    bb.add_predecessor(*this);
+}
+
+void BasicBlock::add_successors(BranchInstruction &br) {
+    assert(successors_.empty());
+    for (auto *succ : br.successors()) {
+        successors_.push_back(succ);
+        succ->add_predecessor(*this);
+    }
+}
+
+void BasicBlock::remove_successors() {
+    for (auto *succ : successors_) {
+        succ->remove_predecessor(*this);
+    }
+    successors_.clear();
+}
 
 void BasicBlock::replace_instruction(iterator from, Instruction &to) {
     assert(std::addressof(from->get_parent()) == this);
 
     from->replace_with(to);
-    from->remove_as_user();
     erase(from);
 }
 
@@ -31,7 +94,6 @@ void BasicBlock::remove_instruction(iterator it) {
                         it->to_string())};
     }
 
-    it->remove_as_user();
     erase(it);
 }
 
@@ -49,12 +111,15 @@ void BasicBlock::print(std::ostream &os) const {
     os << std::format("%bb{}:", get_id());
 
     if (!predecessors_.empty()) {
-        os << " ; preds: ";
-        auto prev_end = std::ranges::prev(predecessors_.end());
-        for (const auto *pred : std::ranges::subrange(predecessors_.begin(), prev_end)) {
-            os << std::format("%bb{}, ", pred->get_id());
-        }
-        os << std::format("%bb{}", (*prev_end)->get_id());
+        // predecessors are printed in the order of their numbers rather than the order of edges
+        std::vector<const BasicBlock *> preds{std::from_range, predecessors()};
+        std::ranges::sort(preds, {}, &BasicBlock::get_id);
+
+        using namespace std::string_view_literals;
+        auto names = preds | std::views::transform([](const auto *pred) static {
+                         return std::format("%bb{}", pred->get_id());
+                     });
+        os << std::format(" ; preds: {:s}", std::views::join_with(names, ", "sv));
     }
 
     os << '\n';
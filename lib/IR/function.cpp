@@ -4,6 +4,7 @@
 #include <stdexcept>
 #include <string_view>
 #include <unordered_map>
+#include <utility>
 
 #include "bjac/IR/argument_instruction.hpp"
 #include "bjac/IR/binary_operator.hpp"
@@ -31,6 +32,20 @@ void Function::print(std::ostream &os) const {
     }
 }
 
+void Function::renumber() const noexcept {
+    unsigned bb_number = 0;
+    unsigned instr_number = 0;
+    for (const auto &bb : *this) {
+        bb.number_ = bb_number++;
+        for (const auto &instr : bb) {
+            instr.number_ = instr_number++;
+        }
+    }
+
+    numbered_blocks_count_ = bb_number;
+    numbered_instructions_count_ = instr_number;
+}
+
 std::ostream &operator<<(std::ostream &os, const Function &f) {
     f.print(os);
     return os;
@@ -101,9 +116,11 @@ class InlineHelper final {
                 } else {
                     assert(ret_val_);
                     assert(ret_val_->get_opcode() == Instruction::Opcode::kPHI);
+                    // the path is added after the edge, since PHI operands are aligned with it
+                    caller_bb.emplace_back<BranchInstruction>(bb_after_call_);
                     auto *ret_phi = static_cast<PHIInstruction *>(ret_val_);
-                    ret_phi->add_path(get_caller_bb(ret.get_parent()),
-                                      get_caller_instr(ret.get_ret_value()));
+                    ret_phi->add_path(caller_bb, get_caller_instr(ret.get_ret_value()));
+                    return nullptr;
                 }
             }
             caller_bb.emplace_back<BranchInstruction>(bb_after_call_);
@@ -111,7 +128,8 @@ class InlineHelper final {
         }
         case kPHI: { // simply insert empty PHI instructions, assign paths on the second pass
             auto &phi = static_cast<PHIInstruction &>(callee_instr);
-            auto &caller_phi = caller_bb.emplace_back<PHIInstruction>(phi.get_type().clone());
+            auto &caller_phi =
+                caller_bb.emplace_back<PHIInstruction>(std::addressof(phi.get_type()));
             callee_caller_phis_.emplace_back(std::addressof(phi), std::addressof(caller_phi));
             return &caller_phi;
         }
@@ -129,7 +147,7 @@ class InlineHelper final {
     };
 
     Instruction &do_clone(BasicBlock &caller_bb, ConstInstruction &const_instr) const {
-        return caller_bb.emplace_back<ConstInstruction>(const_instr.get_type().clone(),
+        return caller_bb.emplace_back<ConstInstruction>(std::addressof(const_instr.get_type()),
                                                         const_instr.get_value());
     }
 
@@ -185,11 +203,11 @@ class InlineHelper final {
     }
 
     static PHIInstruction *try_create_ret_phi(const Function &callee, BasicBlock &bb_after_call) {
-        const auto &ret_type = callee.return_type();
-        if (ret_type.id() == Type::ID::kVoid || callee.rets_count() < 2) {
+        const auto *ret_type = std::addressof(callee.return_type());
+        if (ret_type->id() == Type::ID::kVoid || callee.rets_count() < 2) {
             return nullptr;
         }
-        return std::addressof(bb_after_call.emplace_front<PHIInstruction>(ret_type.clone()));
+        return std::addressof(bb_after_call.emplace_front<PHIInstruction>(ret_type));
     }
 
     CallInstruction &call_;
@@ -254,6 +272,14 @@ auto Function::split_bb_at(Instruction &instr) -> iterator {
 
     bb_1.splice(bb_1.end(), bb_0, after_instr_it, bb_0.end());
 
+    // the terminator has moved to bb_1 together with the edges to successors, so it's bb_1 that
+    // values of PHIs in successors come from now
+    bb_1.successors_ = std::move(bb_0.successors_);
+    bb_0.successors_.clear();
+    for (auto *succ : bb_1.successors()) {
+        succ->replace_predecessor(bb_0, bb_1);
+    }
+
     return bb_1_it;
 }
 
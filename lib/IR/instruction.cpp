@@ -1,9 +1,12 @@
+#include <algorithm>
 #include <format>
 #include <memory>
 #include <ranges>
 #include <stdexcept>
 #include <string>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 #include "bjac/IR/basic_block.hpp"
 #include "bjac/IR/function.hpp"
@@ -22,73 +25,31 @@
 
 namespace bjac {
 
-Instruction::Instruction(BasicBlock &parent, Opcode opcode, std::unique_ptr<Type> type)
-    : Value{std::move(type)}, opcode_{opcode}, parent_{std::addressof(parent)},
+Instruction::Instruction(BasicBlock &parent, Opcode opcode, const Type *type)
+    : Value{type}, opcode_{opcode}, parent_{std::addressof(parent)},
       id_{parent.get_next_instr_id()} {}
 
 void Instruction::replace_with(Instruction &other) {
-    for (auto it = users_.begin(), ite = users_.end(); it != ite;) {
-        auto *user = *it;
-        if (user->is_binary_op()) {
-            if (auto *bin_op = static_cast<BinaryOperator *>(user); bin_op->get_lhs() == this) {
-                if (bin_op->get_rhs() == this) {
-                    it = std::next(it, 2);
-                    bin_op->set_lhs(other);
-                    bin_op->set_rhs(other);
-                } else {
-                    ++it;
-                    bin_op->set_lhs(other);
-                }
-            } else if (bin_op->get_rhs() == this) {
-                ++it;
-                bin_op->set_rhs(other);
-            } else {
-                ++it;
-            }
-        } else {
-            switch (user->get_opcode()) {
-            case Opcode::kICmp:
-                if (auto *icmp = static_cast<ICmpInstruction *>(user); icmp->get_lhs() == this) {
-                    if (icmp->get_rhs() == this) {
-                        it = std::next(it, 2);
-                        icmp->set_lhs(other);
-                        icmp->set_rhs(other);
-                    } else {
-                        ++it;
-                        icmp->set_lhs(other);
-                    }
-                } else if (icmp->get_rhs() == this) {
-                    ++it;
-                    icmp->set_rhs(other);
-                } else {
-                    ++it;
-                }
-                break;
-            case Opcode::kRet:
-                ++it;
-                static_cast<ReturnInstruction *>(user)->set_ret_value(other);
-                break;
-            case Opcode::kBr:
-                ++it;
-                static_cast<BranchInstruction *>(user)->set_condition(other);
-                break;
-            case Opcode::kPHI:
-                ++it;
-                static_cast<PHIInstruction *>(user)->replace_value(*this, other);
-                break;
-            default:
-                ++it;
-                break;
-            }
-        }
+    if (this == std::addressof(other)) {
+        return;
+    }
+    if (!get_type().is_equal(other.get_type())) {
+        throw std::invalid_argument{std::format("trying to replace {} value with {} value",
+                                                get_type().to_string(),
+                                                other.get_type().to_string())};
+    }
+
+    // every redirected use leaves the list, so the head of the list is always the next one
+    while (first_use_) {
+        first_use_->set(std::addressof(other));
     }
 }
 
 namespace {
 
-std::unique_ptr<Type> get_arg_type(const Function &f, unsigned pos) {
+const Type *get_arg_type(const Function &f, unsigned pos) {
     if (const auto args = f.arguments(); pos < args.size()) {
-        return args[pos]->clone();
+        return args[pos];
     }
     throw ArgOutOfRange{"function parameter index is out of range"};
 }
@@ -97,12 +58,18 @@ std::string ssa_value_to_string(const Instruction &instr) {
     return std::format("%{}.{}", instr.get_parent().get_id(), instr.get_id());
 }
 
+// Users are printed in the order of their appearance in the function (provided that basic blocks
+// are numbered in their order) rather than in the order of their addresses
 std::string users_to_string(const Instruction &instr) {
-    std::ranges::bidirectional_range auto users = instr.get_users();
+    std::vector<const Instruction *> users{std::from_range, instr.get_users()};
     if (users.empty()) {
         return {};
     }
 
+    std::ranges::sort(users, {}, [](const auto *user) static {
+        return std::pair{user->get_parent().get_id(), user->get_id()};
+    });
+
     using namespace std::string_view_literals;
     auto values = users | std::views::transform(
                               [](const auto *user) static { return ssa_value_to_string(*user); });
@@ -121,15 +88,25 @@ std::string ArgumentInstruction::to_string() const {
 
 std::string BinaryOperator::to_string() const {
     return std::format("{} = {} {} {}, {}{}", ssa_value_to_string(*this), get_type().to_string(),
-                       opcode_, ssa_value_to_string(*lhs_), ssa_value_to_string(*rhs_),
+                       opcode_, ssa_value_to_string(*get_lhs()), ssa_value_to_string(*get_rhs()),
                        users_to_string(*this));
 }
 
+void BranchInstruction::set_path(std::size_t i, BasicBlock &bb) {
+    paths_[i] = std::addressof(bb);
+
+    // a branch moved to another block by splitting is not the terminator of its parent anymore
+    if (auto &parent = get_parent();
+        parent.get_terminator() == this && i < std::ranges::size(parent.successors())) {
+        parent.replace_successor(i, bb);
+    }
+}
+
 std::string BranchInstruction::to_string() const {
     if (is_conditional()) {
         return std::format("{} {} {} {}, label %bb{}, label %bb{}{}", ssa_value_to_string(*this),
-                           Opcode::kBr, condition_->get_type().to_string(),
-                           ssa_value_to_string(*condition_), get_true_path()->get_id(),
+                           Opcode::kBr, get_condition()->get_type().to_string(),
+                           ssa_value_to_string(*get_condition()), get_true_path()->get_id(),
                            get_false_path()->get_id(), users_to_string(*this));
     } else {
         return std::format("{} {} label %bb{}{}", ssa_value_to_string(*this), Opcode::kBr,
@@ -144,18 +121,52 @@ std::string ConstInstruction::to_string() const {
 
 std::string ICmpInstruction::to_string() const {
     return std::format("{} = {} {} {} {}, {}{}", ssa_value_to_string(*this), Opcode::kICmp, kind_,
-                       lhs_->get_type().to_string(), ssa_value_to_string(*lhs_),
-                       ssa_value_to_string(*rhs_), users_to_string(*this));
+                       get_lhs()->get_type().to_string(), ssa_value_to_string(*get_lhs()),
+                       ssa_value_to_string(*get_rhs()), users_to_string(*this));
+}
+
+PHIInstruction::PHIInstruction(BasicBlock &parent, const Type *type)
+    : Instruction(parent, Opcode::kPHI, type), values_{parent.get_arena()} {
+    const auto preds_count = std::ranges::size(parent.predecessors());
+    values_.reserve(*this, preds_count);
+    for (std::size_t i = 0; i != preds_count; ++i) {
+        values_.emplace_back(*this, nullptr);
+    }
+    set_operands(values_.span());
+}
+
+void PHIInstruction::add_path(BasicBlock &bb, Instruction &value) {
+    if (!get_type().is_equal(value.get_type())) {
+        throw PHITypeMismatch{"adding path of different type to a phi instruction"};
+    }
+    if (auto i = get_parent().predecessor_index(bb)) {
+        values_[*i].set(std::addressof(value));
+    } else {
+        throw std::invalid_argument{
+            std::format("trying to add a path from %bb{}, which is not a predecessor of %bb{}",
+                        bb.get_id(), get_parent().get_id())};
+    }
+}
+
+void PHIInstruction::remove_path(BasicBlock &bb) {
+    if (auto i = get_parent().predecessor_index(bb)) {
+        values_[*i].set(nullptr);
+    }
 }
 
 std::string PHIInstruction::to_string() const {
-    if (records_.empty()) {
+    auto records = get_paths() | std::ranges::to<std::vector>();
+    if (records.empty()) {
         return std::format("{} = {} {}{}", ssa_value_to_string(*this), Opcode::kPHI,
                            get_type().to_string(), users_to_string(*this));
     } else {
-        auto phi_strings = records_ | std::views::transform([](const auto &r) static {
-                               return std::format("[{}, %bb{}]", ssa_value_to_string(*r.second),
-                                                  r.first->get_id());
+        std::ranges::sort(records, {},
+                          [](const auto &r) static { return std::get<0>(r)->get_id(); });
+
+        auto phi_strings = records | std::views::transform([](const auto &r) static {
+                               auto [bb, value] = r;
+                               return std::format("[{}, %bb{}]", ssa_value_to_string(*value),
+                                                  bb->get_id());
                            });
         using namespace std::string_view_literals;
         return std::format("{} = {} {} {:s}{}", ssa_value_to_string(*this), Opcode::kPHI,
@@ -165,7 +176,7 @@ std::string PHIInstruction::to_string() const {
 }
 
 ReturnInstruction::ReturnInstruction(BasicBlock &parent)
-    : Instruction(parent, Opcode::kRet, std::make_unique<VoidType>()), ret_val_{nullptr} {
+    : Instruction(parent, Opcode::kRet, VoidType::get()), ret_val_{*this, nullptr} {
     if (auto ret_type_id = parent.get_parent().return_type_id(); ret_type_id != Type::ID::kVoid) {
         throw std::invalid_argument{std::format("trying to create {} {} in a function returning {}",
                                                 Opcode::kRet, Type::ID::kVoid, ret_type_id)};
@@ -173,8 +184,9 @@ ReturnInstruction::ReturnInstruction(BasicBlock &parent)
 }
 
 ReturnInstruction::ReturnInstruction(BasicBlock &parent, Instruction &ret_val)
-    : Instruction(parent, Opcode::kRet, std::make_unique<VoidType>()),
-      ret_val_{std::addressof(ret_val)} {
+    : Instruction(parent, Opcode::kRet, VoidType::get()),
+      ret_val_{*this, std::addressof(ret_val)} {
+    set_operands({std::addressof(ret_val_), 1});
     auto &callee = parent.get_parent();
     auto &owner = ret_val.get_parent().get_parent();
     if (std::addressof(owner) != std::addressof(callee)) {
@@ -189,39 +201,40 @@ ReturnInstruction::ReturnInstruction(BasicBlock &parent, Instruction &ret_val)
                                                 Opcode::kRet, ret_val.get_type().to_string(),
                                                 ret_type.to_string())};
     }
-
-    ret_val.add_user(this);
 }
 
 std::string ReturnInstruction::to_string() const {
-    if (ret_val_) {
+    if (const auto *ret_val = get_ret_value()) {
         return std::format("{} {} {} {}", ssa_value_to_string(*this), Opcode::kRet,
-                           ret_val_->get_type().to_string(), ssa_value_to_string(*ret_val_));
+                           ret_val->get_type().to_string(), ssa_value_to_string(*ret_val));
     }
     return std::format("{} {} {}", ssa_value_to_string(*this), Opcode::kRet, Type::ID::kVoid);
 }
 
 CallInstruction::CallInstruction(BasicBlock &parent, Function &callee,
                                  std::vector<Instruction *> args)
-    : Instruction(parent, Opcode::kCall, callee.return_type().clone()),
-      callee_{std::addressof(callee)}, args_(std::move(args)) {
-    auto parameters =
-        callee.arguments() |
-        std::views::transform([](const auto &u_ptr) static -> const Type & { return *u_ptr; });
-    auto arguments = args_ | std::views::transform([](const auto *arg) static -> const Type & {
-                         return arg->get_type();
+    : Instruction(parent, Opcode::kCall, std::addressof(callee.return_type())),
+      callee_{std::addressof(callee)}, args_{parent.get_arena()} {
+    // types are interned, so they are compared by addresses
+    auto arg_types = args | std::views::transform([](const auto *arg) static {
+                         return std::addressof(arg->get_type());
                      });
-    if (!std::ranges::equal(parameters, arguments,
-                            [](const auto &lhs, const auto &rhs) { return lhs.is_equal(rhs); })) {
+    if (!std::ranges::equal(callee.arguments(), arg_types)) {
         throw std::invalid_argument{std::format(
             "types of call arguments mismatch with parameters of function '{}'", callee.name())};
     }
+
+    args_.reserve(*this, args.size());
+    for (auto *arg : args) {
+        args_.emplace_back(*this, arg);
+    }
+    set_operands(args_.span());
 }
 
 std::string CallInstruction::to_string() const {
-    std::ranges::view auto arg_string = args_ | std::views::transform([](const auto *arg) static {
-                                            return ssa_value_to_string(*arg);
-                                        });
+    std::ranges::view auto arg_string =
+        arguments() |
+        std::views::transform([](const auto *arg) static { return ssa_value_to_string(*arg); });
     using namespace std::string_view_literals;
     return std::format("{} = {} {}({:s})", ssa_value_to_string(*this), Opcode::kCall,
                        callee_->name(), std::views::join_with(arg_string, ", "sv));
@@ -231,8 +244,9 @@ Function &CallInstruction::caller() noexcept { return get_parent().get_parent();
 const Function &CallInstruction::caller() const noexcept { return get_parent().get_parent(); }
 
 NullCheckInstruction::NullCheckInstruction(BasicBlock &parent, Instruction &input)
-    : Instruction{parent, Opcode::kNullCheck, std::make_unique<VoidType>()},
-      input_{std::addressof(input)} {
+    : Instruction{parent, Opcode::kNullCheck, VoidType::get()},
+      operands_{{{*this, std::addressof(input)}}} {
+    set_operands(operands_);
     if (input.get_type_id() != Type::ID::kPointer) {
         throw std::invalid_argument{
             std::format("'{}' does not have pointer type and cannot be used as the "
@@ -243,13 +257,14 @@ NullCheckInstruction::NullCheckInstruction(BasicBlock &parent, Instruction &inpu
 
 std::string NullCheckInstruction::to_string() const {
     return std::format("{} {} {} {}", ssa_value_to_string(*this), Opcode::kNullCheck,
-                       Type::ID::kPointer, ssa_value_to_string(*input_));
+                       Type::ID::kPointer, ssa_value_to_string(*get_input()));
 }
 
 BoundsCheckInstruction::BoundsCheckInstruction(BasicBlock &parent, Instruction &array,
                                                Instruction &index)
-    : Instruction{parent, Opcode::kBoundsCheck, std::make_unique<VoidType>()},
-      array_{std::addressof(array)}, index_{std::addressof(index)} {
+    : Instruction{parent, Opcode::kBoundsCheck, VoidType::get()},
+      operands_{{{*this, std::addressof(array)}, {*this, std::addressof(index)}}} {
+    set_operands(operands_);
     if (array.get_type_id() != Type::ID::kArray) {
         throw std::invalid_argument{std::format(
             "'{}' does not have array type and cannot be used as an input of a {} instruction",
@@ -264,12 +279,13 @@ BoundsCheckInstruction::BoundsCheckInstruction(BasicBlock &parent, Instruction &
 
 std::string BoundsCheckInstruction::to_string() const {
     return std::format("{} {} {} {}, {} {}", ssa_value_to_string(*this), Opcode::kBoundsCheck,
-                       array_->get_type().to_string(), ssa_value_to_string(*array_), Type::ID::kI64,
-                       ssa_value_to_string(*index_));
+                       get_array()->get_type().to_string(), ssa_value_to_string(*get_array()),
+                       Type::ID::kI64, ssa_value_to_string(*get_index()));
 }
 
-LoadInstruction::LoadInstruction(BasicBlock &parent, std::unique_ptr<Type> type, Instruction &addr)
-    : Instruction(parent, Opcode::kLoad, std::move(type)), addr_{std::addressof(addr)} {
+LoadInstruction::LoadInstruction(BasicBlock &parent, const Type *type, Instruction &addr)
+    : Instruction(parent, Opcode::kLoad, type), operands_{{{*this, std::addressof(addr)}}} {
+    set_operands(operands_);
     using enum Type::ID;
 
     switch (const auto type_id = get_type_id()) {
@@ -290,7 +306,7 @@ LoadInstruction::LoadInstruction(BasicBlock &parent, std::unique_ptr<Type> type,
 
 std::string LoadInstruction::to_string() const {
     return std::format("{} = {} {}, {} {}{}", ssa_value_to_string(*this), Opcode::kLoad,
-                       get_type().to_string(), Type::ID::kPointer, ssa_value_to_string(*addr_),
+                       get_type().to_string(), Type::ID::kPointer, ssa_value_to_string(*get_addr()),
                        users_to_string(*this));
 }
 
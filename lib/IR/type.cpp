@@ -0,0 +1,60 @@
+#include <array>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "bjac/IR/type.hpp"
+
+namespace bjac {
+
+namespace {
+
+// Position of an integral type in tables indexed by integral types
+std::size_t integral_index(Type::ID kind) {
+    return static_cast<std::size_t>(kind) - static_cast<std::size_t>(Type::ID::kI1);
+}
+
+} // unnamed namespace
+
+const NoneType *NoneType::get() {
+    static const NoneType type;
+    return &type;
+}
+
+const VoidType *VoidType::get() {
+    static const VoidType type;
+    return &type;
+}
+
+const IntegralType *IntegralType::get(ID kind) {
+    using enum ID;
+    static const std::array<IntegralType, 5> types{IntegralType{kI1}, IntegralType{kI8},
+                                                   IntegralType{kI16}, IntegralType{kI32},
+                                                   IntegralType{kI64}};
+    return &types[integral_index(check_if_integral(kind))];
+}
+
+const PointerType *PointerType::get(ID referenced_kind) {
+    using enum ID;
+    static const std::array<PointerType, 5> types{PointerType{kI1}, PointerType{kI8},
+                                                  PointerType{kI16}, PointerType{kI32},
+                                                  PointerType{kI64}};
+    return &types[integral_index(check_if_integral(referenced_kind))];
+}
+
+const ArrayType *ArrayType::get(ID referenced_kind, std::size_t size) {
+    static std::mutex mutex;
+    static std::map<std::pair<ID, std::size_t>, std::unique_ptr<const ArrayType>> types;
+
+    std::scoped_lock lock{mutex};
+
+    auto &type = types[{referenced_kind, size}];
+    if (!type) {
+        type.reset(new ArrayType{referenced_kind, size});
+    }
+    return type.get();
+}
+
+} // namespace bjac
@@ -0,0 +1,646 @@
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "bjac/analysis/graph_coloring.hpp"
+#include "bjac/analysis/lifetime.hpp"
+#include "bjac/analysis/liveness.hpp"
+#include "bjac/analysis/reg_alloc.hpp"
+
+#include "bjac/IR/basic_block.hpp"
+#include "bjac/IR/dense_map.hpp"
+#include "bjac/IR/function.hpp"
+#include "bjac/IR/instruction.hpp"
+#include "bjac/IR/phi_instruction.hpp"
+
+namespace bjac {
+
+namespace {
+
+using Storage = RegAlloc::Storage;
+using Segment = Lifetime::Segment;
+
+// Points are numbered as in RegAlloc: operands are read at point 2n and the result is written at
+// point 2n + 1 of the instruction at position n
+constexpr std::size_t read_point(std::size_t position) noexcept { return 2 * position; }
+constexpr std::size_t write_point(std::size_t position) noexcept { return 2 * position + 1; }
+
+constexpr auto kInfinity = std::numeric_limits<double>::infinity();
+
+Storage register_storage(std::size_t reg) {
+    return {.kind = Storage::Kind::kRegister, .index = reg};
+}
+
+Storage rematerialized_storage() {
+    return {.kind = Storage::Kind::kRematerialized, .index = 0};
+}
+
+// Positions of instructions reading the value from a register in ascending order. Operands of PHI
+// instructions and arguments of calls are not read from registers
+std::vector<std::size_t> register_uses(const LivenessAnalysis &liveness, const Instruction &value) {
+    std::vector<std::size_t> positions;
+    for (const auto *user : value.get_users()) {
+        if (!user->is_phi() && user->get_opcode() != Instruction::Opcode::kCall &&
+            liveness.has_position(*user)) {
+            positions.push_back(liveness.position(*user));
+        }
+    }
+    std::ranges::sort(positions);
+    const auto [first, last] = std::ranges::unique(positions);
+    positions.erase(first, last);
+    return positions;
+}
+
+// A node of the interference graph: the whole lifetime of a value in points or, once the value is
+// spilled, a temporary holding it in a register for one point at its definition or at a use
+struct Node {
+    bool is_temporary() const noexcept { return spill_cost == kInfinity; }
+
+    const Instruction *value;
+    Lifetime range;
+    double spill_cost;
+};
+
+Node make_whole_node(const LivenessAnalysis &liveness, std::span<const double> frequencies,
+                     const Instruction &value) {
+    const auto &lifetime = liveness.at(value);
+
+    // the first segment begins with the result written, the others with operands read at the
+    // first instructions of blocks the value is live into
+    Lifetime range;
+    for (auto it = lifetime.rbegin(); it != lifetime.rend(); ++it) {
+        const auto start = it->start() == lifetime.start_point() ? write_point(it->start())
+                                                                  : read_point(it->start());
+        range.add(Segment{start, std::max(start, read_point(it->end()))});
+    }
+
+    double spill_cost = 0.0;
+    if (!value.is_phi() && !RegAlloc::is_rematerializable(value)) {
+        spill_cost += frequencies[liveness.position(value)];
+    }
+    for (auto use : register_uses(liveness, value)) {
+        spill_cost += frequencies[use];
+    }
+
+    return Node{
+        .value = std::addressof(value), .range = std::move(range), .spill_cost = spill_cost};
+}
+
+Node make_temporary(const Instruction &value, std::size_t point) {
+    return Node{.value = std::addressof(value),
+                .range = Lifetime{Segment{point, point}},
+                .spill_cost = kInfinity};
+}
+
+// Iterated register coalescing of George and Appel for graphs without precolored nodes. Worklists
+// are vectors, and nodes leaving a worklist stay in it until they are popped and found to be in
+// another state
+class IteratedCoalescing final {
+    enum class State : unsigned char {
+        kSimplify,
+        kFreeze,
+        kSpill,
+        kCoalesced,
+        kSelected,
+        kColored,
+        kSpilled
+    };
+    enum class MoveState : unsigned char { kWorklist, kActive, kCoalesced, kConstrained, kFrozen };
+
+  public:
+    using Move = std::pair<std::size_t, std::size_t>;
+
+    IteratedCoalescing(std::span<const Node> nodes, std::span<const Move> moves,
+                       std::size_t colors_count)
+        : moves_(std::from_range, moves), move_states_(moves.size(), MoveState::kWorklist),
+          worklist_moves_(std::from_range, std::views::iota(0uz, moves.size())),
+          adj_list_(nodes.size()), degree_(nodes.size()), move_list_(nodes.size()),
+          alias_(nodes.size()), states_(nodes.size()), colors_(nodes.size(), kNoColor),
+          spill_costs_(std::from_range, nodes | std::views::transform(&Node::spill_cost)),
+          colors_count_{colors_count} {
+        build(nodes);
+        for (auto [k, move] : std::views::enumerate(moves_)) {
+            move_list_[move.first].push_back(static_cast<std::size_t>(k));
+            move_list_[move.second].push_back(static_cast<std::size_t>(k));
+        }
+
+        for (std::size_t n = 0; n != nodes.size(); ++n) {
+            if (degree_[n] >= colors_count_) {
+                push(n, State::kSpill);
+            } else if (is_move_related(n)) {
+                push(n, State::kFreeze);
+            } else {
+                push(n, State::kSimplify);
+            }
+        }
+    }
+
+    // Colors the graph and returns nodes left without colors
+    std::vector<std::size_t> run() {
+        for (;;) {
+            if (auto n = pop(simplify_worklist_, State::kSimplify)) {
+                simplify(*n);
+            } else if (auto k = pop_move()) {
+                coalesce(*k);
+            } else if (auto frozen = pop(freeze_worklist_, State::kFreeze)) {
+                push(*frozen, State::kSimplify);
+                freeze_moves(*frozen);
+            } else if (auto spilled = select_spill()) {
+                push(*spilled, State::kSimplify);
+                freeze_moves(*spilled);
+            } else {
+                break;
+            }
+        }
+        return assign_colors();
+    }
+
+    std::size_t color(std::size_t n) const { return colors_[n]; }
+
+    std::span<const std::size_t> neighbours(std::size_t n) const { return adj_list_[n]; }
+
+    std::size_t coalesced_moves_count() const {
+        return static_cast<std::size_t>(std::ranges::count(move_states_, MoveState::kCoalesced));
+    }
+
+  private:
+    static constexpr auto kNoColor = std::numeric_limits<std::size_t>::max();
+
+    // Nodes interfere if their ranges intersect. Segments are swept in the order of their starts,
+    // each one interfering with the segments still open
+    void build(std::span<const Node> nodes) {
+        std::vector<std::tuple<std::size_t, std::size_t, std::size_t>> segments;
+        for (auto [n, node] : std::views::enumerate(nodes)) {
+            for (const auto &seg : node.range) {
+                segments.emplace_back(seg.start(), seg.end(), static_cast<std::size_t>(n));
+            }
+        }
+        std::ranges::sort(segments);
+
+        std::vector<std::pair<std::size_t, std::size_t>> open;
+        for (auto [start, end, n] : segments) {
+            std::erase_if(open, [start](const auto &segment) { return segment.first < start; });
+            for (const auto &segment : open) {
+                add_edge(n, segment.second);
+            }
+            open.emplace_back(end, n);
+        }
+    }
+
+    static std::uint64_t edge_key(std::size_t u, std::size_t v) {
+        return (std::uint64_t{std::min(u, v)} << 32) | std::max(u, v);
+    }
+
+    bool interfere(std::size_t u, std::size_t v) const {
+        return adj_set_.contains(edge_key(u, v));
+    }
+
+    void add_edge(std::size_t u, std::size_t v) {
+        if (u != v && adj_set_.insert(edge_key(u, v)).second) {
+            adj_list_[u].push_back(v);
+            adj_list_[v].push_back(u);
+            ++degree_[u];
+            ++degree_[v];
+        }
+    }
+
+    // Neighbours still in the graph
+    auto adjacent(std::size_t n) const {
+        return adj_list_[n] | std::views::filter([this](std::size_t m) {
+                   return states_[m] != State::kSelected && states_[m] != State::kCoalesced;
+               });
+    }
+
+    auto node_moves(std::size_t n) const {
+        return move_list_[n] | std::views::filter([this](std::size_t k) {
+                   return move_states_[k] == MoveState::kWorklist ||
+                          move_states_[k] == MoveState::kActive;
+               });
+    }
+
+    bool is_move_related(std::size_t n) const { return !std::ranges::empty(node_moves(n)); }
+
+    std::size_t alias(std::size_t n) const {
+        while (states_[n] == State::kCoalesced) {
+            n = alias_[n];
+        }
+        return n;
+    }
+
+    void push(std::size_t n, State state) {
+        states_[n] = state;
+        switch (state) {
+        case State::kSimplify:
+            simplify_worklist_.push_back(n);
+            break;
+        case State::kFreeze:
+            freeze_worklist_.push_back(n);
+            break;
+        case State::kSpill:
+            spill_worklist_.push_back(n);
+            break;
+        default:
+            assert(false && "not a worklist");
+        }
+    }
+
+    std::optional<std::size_t> pop(std::vector<std::size_t> &worklist, State state) {
+        while (!worklist.empty()) {
+            const auto n = worklist.back();
+            worklist.pop_back();
+            if (states_[n] == state) {
+                return n;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::optional<std::size_t> pop_move() {
+        while (!worklist_moves_.empty()) {
+            const auto k = worklist_moves_.back();
+            worklist_moves_.pop_back();
+            if (move_states_[k] == MoveState::kWorklist) {
+                return k;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void simplify(std::size_t n) {
+        states_[n] = State::kSelected;
+        select_stack_.push_back(n);
+        for (auto m : adjacent(n)) {
+            decrement_degree(m);
+        }
+    }
+
+    void decrement_degree(std::size_t m) {
+        if (degree_[m]-- != colors_count_) {
+            return;
+        }
+        enable_moves(m);
+        for (auto n : adjacent(m)) {
+            enable_moves(n);
+        }
+        if (states_[m] == State::kSpill) {
+            push(m, is_move_related(m) ? State::kFreeze : State::kSimplify);
+        }
+    }
+
+    void enable_moves(std::size_t n) {
+        for (auto k : move_list_[n]) {
+            if (move_states_[k] == MoveState::kActive) {
+                move_states_[k] = MoveState::kWorklist;
+                worklist_moves_.push_back(k);
+            }
+        }
+    }
+
+    void add_to_simplify(std::size_t n) {
+        if (states_[n] == State::kFreeze && !is_move_related(n) && degree_[n] < colors_count_) {
+            push(n, State::kSimplify);
+        }
+    }
+
+    // Briggs: the coalesced node has fewer neighbours of significant degree than there are colors
+    bool is_conservative(std::size_t u, std::size_t v) const {
+        std::vector<std::size_t> neighbours(std::from_range, adjacent(u));
+        neighbours.append_range(adjacent(v));
+        std::ranges::sort(neighbours);
+        const auto [first, last] = std::ranges::unique(neighbours);
+        neighbours.erase(first, last);
+        return std::ranges::count_if(neighbours, [this](std::size_t n) {
+                   return degree_[n] >= colors_count_;
+               }) < static_cast<std::ptrdiff_t>(colors_count_);
+    }
+
+    void coalesce(std::size_t k) {
+        const auto u = alias(moves_[k].first);
+        const auto v = alias(moves_[k].second);
+
+        if (u == v) {
+            move_states_[k] = MoveState::kCoalesced;
+            add_to_simplify(u);
+        } else if (interfere(u, v)) {
+            move_states_[k] = MoveState::kConstrained;
+            add_to_simplify(u);
+            add_to_simplify(v);
+        } else if (is_conservative(u, v)) {
+            move_states_[k] = MoveState::kCoalesced;
+            combine(u, v);
+            add_to_simplify(u);
+        } else {
+            move_states_[k] = MoveState::kActive;
+        }
+    }
+
+    void combine(std::size_t u, std::size_t v) {
+        states_[v] = State::kCoalesced;
+        alias_[v] = u;
+        move_list_[u].append_range(move_list_[v]);
+        enable_moves(v);
+        // adding edges to u never changes the adjacency list of v
+        for (auto t : adjacent(v)) {
+            add_edge(t, u);
+            decrement_degree(t);
+        }
+        if (degree_[u] >= colors_count_ && states_[u] == State::kFreeze) {
+            push(u, State::kSpill);
+        }
+    }
+
+    void freeze_moves(std::size_t u) {
+        for (auto k : move_list_[u]) {
+            if (move_states_[k] != MoveState::kWorklist && move_states_[k] != MoveState::kActive) {
+                continue;
+            }
+            const auto x = alias(moves_[k].first);
+            const auto y = alias(moves_[k].second);
+            const auto v = y == alias(u) ? x : y;
+            move_states_[k] = MoveState::kFrozen;
+            add_to_simplify(v);
+        }
+    }
+
+    // The node of the least spill cost per interference is removed from the graph optimistically:
+    // it may still get a color if its neighbours share colors
+    std::optional<std::size_t> select_spill() {
+        std::erase_if(spill_worklist_,
+                      [this](std::size_t n) { return states_[n] != State::kSpill; });
+        if (spill_worklist_.empty()) {
+            return std::nullopt;
+        }
+        const auto it = std::ranges::min_element(spill_worklist_, {}, [this](std::size_t n) {
+            return spill_costs_[n] / static_cast<double>(degree_[n]);
+        });
+        const auto n = *it;
+        spill_worklist_.erase(it);
+        return n;
+    }
+
+    std::vector<std::size_t> assign_colors() {
+        std::vector<std::size_t> spilled;
+        std::vector<bool> taken(colors_count_);
+        for (auto n : select_stack_ | std::views::reverse) {
+            std::ranges::fill(taken, false);
+            for (auto w : adj_list_[n]) {
+                if (const auto a = alias(w); states_[a] == State::kColored) {
+                    taken[colors_[a]] = true;
+                }
+            }
+
+            if (auto it = std::ranges::find(taken, false); it != taken.end()) {
+                states_[n] = State::kColored;
+                colors_[n] = static_cast<std::size_t>(it - taken.begin());
+            } else {
+                states_[n] = State::kSpilled;
+                spilled.push_back(n);
+            }
+        }
+        select_stack_.clear();
+
+        for (std::size_t n = 0; n != states_.size(); ++n) {
+            if (states_[n] != State::kCoalesced) {
+                continue;
+            }
+            if (const auto a = alias(n); states_[a] == State::kColored) {
+                colors_[n] = colors_[a];
+            } else {
+                spilled.push_back(n);
+            }
+        }
+        return spilled;
+    }
+
+    std::vector<Move> moves_;
+    std::vector<MoveState> move_states_;
+    std::vector<std::size_t> worklist_moves_;
+
+    std::unordered_set<std::uint64_t> adj_set_;
+    std::vector<std::vector<std::size_t>> adj_list_;
+    std::vector<std::size_t> degree_;
+    std::vector<std::vector<std::size_t>> move_list_;
+    std::vector<std::size_t> alias_;
+
+    std::vector<State> states_;
+    std::vector<std::size_t> colors_;
+    std::vector<double> spill_costs_;
+    std::size_t colors_count_;
+
+    std::vector<std::size_t> simplify_worklist_;
+    std::vector<std::size_t> freeze_worklist_;
+    std::vector<std::size_t> spill_worklist_;
+    std::vector<std::size_t> select_stack_;
+};
+
+} // unnamed namespace
+
+GraphColoringRegAlloc::GraphColoringRegAlloc(const Function &func, std::size_t free_regs_count) {
+    if (free_regs_count == 0) {
+        throw std::invalid_argument{"register allocation with 0 registers is meaningless"};
+    }
+    if (free_regs_count == 1) {
+        throw std::invalid_argument{
+            "register allocation needs at least 2 registers for operands of binary instructions"};
+    }
+
+    const LivenessAnalysis liveness{func};
+
+    // estimated execution frequencies of instructions indexed by their positions
+    std::vector<double> frequencies(func.numbered_instructions_count());
+    for (const auto &bb : func) {
+        if (!liveness.has_position(bb.front())) {
+            continue;
+        }
+        const auto frequency = liveness.frequency(bb);
+        for (const auto &instr : bb) {
+            frequencies[liveness.position(instr)] = frequency;
+        }
+    }
+
+    std::vector<const Instruction *> values(std::from_range,
+                                            liveness | std::views::transform([](const auto &pair) {
+                                                return pair.first;
+                                            }));
+
+    // copies of inputs of PHI instructions on incoming edges are candidates for coalescing
+    std::vector<std::pair<const Instruction *, const Instruction *>> copies;
+    for (const auto *value : values) {
+        if (!value->is_phi()) {
+            continue;
+        }
+        for (const auto *input : static_cast<const PHIInstruction &>(*value).get_values()) {
+            if (input != value && liveness.has_position(*input)) {
+                copies.emplace_back(value, input);
+            }
+        }
+    }
+
+    // Build, color and rewrite until every node gets a color. Spilled values are replaced by
+    // temporaries that cannot be spilled, and the graph is built anew
+    std::vector<bool> is_spilled(func.numbered_instructions_count());
+    std::vector<Node> nodes;
+    DenseMap<Instruction, std::size_t> whole_nodes;
+    std::vector<std::size_t> colors;
+    for (;;) {
+        nodes.clear();
+        whole_nodes = DenseMap<Instruction, std::size_t>{func.numbered_instructions_count()};
+        for (const auto *value : values) {
+            if (!is_spilled[value->get_number()]) {
+                whole_nodes[*value] = nodes.size();
+                nodes.push_back(make_whole_node(liveness, frequencies, *value));
+                continue;
+            }
+            if (!value->is_phi() && !RegAlloc::is_rematerializable(*value)) {
+                nodes.push_back(make_temporary(*value, write_point(liveness.position(*value))));
+            }
+            for (auto use : register_uses(liveness, *value)) {
+                nodes.push_back(make_temporary(*value, read_point(use)));
+            }
+        }
+
+        std::vector<IteratedCoalescing::Move> moves;
+        for (const auto &[phi, input] : copies) {
+            if (whole_nodes.contains(*phi) && whole_nodes.contains(*input)) {
+                moves.emplace_back(whole_nodes.at(*phi), whole_nodes.at(*input));
+            }
+        }
+
+        IteratedCoalescing graph{nodes, moves, free_regs_count};
+        const auto uncolored = graph.run();
+        if (uncolored.empty()) {
+            colors.assign_range(std::views::iota(0uz, nodes.size()) |
+                                std::views::transform([&graph](std::size_t n) {
+                                    return graph.color(n);
+                                }));
+            coalesced_moves_count_ = graph.coalesced_moves_count();
+            break;
+        }
+
+        for (auto n : uncolored) {
+            if (!nodes[n].is_temporary()) {
+                is_spilled[nodes[n].value->get_number()] = true;
+                continue;
+            }
+
+            // a temporary is left without a color by values living through its point
+            bool spilled_any = false;
+            for (auto m : graph.neighbours(n)) {
+                if (!nodes[m].is_temporary()) {
+                    is_spilled[nodes[m].value->get_number()] = true;
+                    spilled_any = true;
+                }
+            }
+            if (!spilled_any) {
+                throw std::invalid_argument{"too few registers for operands of an instruction"};
+            }
+        }
+    }
+
+    // spilled values not rematerializable share stack slots unless their lifetimes intersect
+    std::vector<const Instruction *> stored;
+    for (const auto *value : values) {
+        if (is_spilled[value->get_number()] && !RegAlloc::is_rematerializable(*value)) {
+            stored.push_back(value);
+        }
+    }
+    std::vector<Lifetime> lifetimes(std::from_range,
+                                    stored | std::views::transform([&liveness](const auto *value) {
+                                        return liveness.at(*value);
+                                    }));
+    const auto [slots, slots_count] = color_greedily(lifetimes);
+    stack_slots_count_ = slots_count;
+
+    DenseMap<Instruction, Storage> spill_locations(func.numbered_instructions_count());
+    for (auto [i, value] : std::views::enumerate(stored)) {
+        spill_locations[*value] = {.kind = Storage::Kind::kStackSlot, .index = slots[i]};
+    }
+
+    // Nodes of a value follow each other in the order of their points, so a spilled value is
+    // described by walking its temporaries: a definition is stored right after it, and a use is
+    // preceded by a reload
+    instr_to_parts_ = Container{func.numbered_instructions_count()};
+    std::size_t n = 0;
+    for (const auto *value : values) {
+        auto &parts = instr_to_parts_[*value];
+        const auto start = liveness.at(*value).start_point();
+
+        if (!is_spilled[value->get_number()]) {
+            parts.push_back({.position = start, .storage = register_storage(colors[n++])});
+            continue;
+        }
+
+        const auto location = RegAlloc::is_rematerializable(*value)
+                                  ? rematerialized_storage()
+                                  : spill_locations.at(*value);
+        auto add_part = [&parts](std::size_t position, const Storage &storage) {
+            if (!parts.empty() && parts.back().position == position) {
+                parts.back().storage = storage;
+            } else {
+                parts.push_back({.position = position, .storage = storage});
+            }
+            if (parts.size() > 1 && std::prev(parts.end(), 2)->storage == parts.back().storage) {
+                parts.pop_back();
+            }
+        };
+
+        // a PHI instruction is written to its location by copies on incoming edges, and a
+        // rematerializable value is never stored
+        if (value->is_phi() || RegAlloc::is_rematerializable(*value)) {
+            add_part(start, location);
+        }
+        for (; n != nodes.size() && nodes[n].value == value; ++n) {
+            const auto point = nodes[n].range.start_point();
+            const auto position = point / 2;
+            const auto reg = register_storage(colors[n]);
+            if (point == write_point(position)) {
+                add_part(position, reg);
+                moves_.push_back(
+                    {.value = value, .from = reg, .to = location, .position = position + 1});
+            } else {
+                // a use right after the definition takes the value from the register it's
+                // written to, as the store happens at the same time
+                const auto from = parts.back().position != position ? parts.back().storage
+                                   : parts.size() > 1 ? std::prev(parts.end(), 2)->storage
+                                                      : location;
+                if (from != reg) {
+                    moves_.push_back(
+                        {.value = value, .from = from, .to = reg, .position = position});
+                }
+                add_part(position, reg);
+            }
+            add_part(position + 1, location);
+        }
+    }
+
+    for (const auto &move : moves_) {
+        if (move.from.kind == Storage::Kind::kStackSlot ||
+            move.to.kind == Storage::Kind::kStackSlot) {
+            spill_cost_ += frequencies[move.position];
+        }
+    }
+}
+
+const GraphColoringRegAlloc::Storage &GraphColoringRegAlloc::at(const Instruction &instr,
+                                                                std::size_t position) const {
+    const auto value_parts = parts(instr);
+    // the last part beginning not after the position
+    auto it = std::ranges::upper_bound(value_parts, position, {}, &Part::position);
+    if (it == value_parts.begin()) {
+        throw std::out_of_range{"the value is not defined yet at this position"};
+    }
+    return std::prev(it)->storage;
+}
+
+} // namespace bjac
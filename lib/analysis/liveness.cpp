@@ -1,73 +1,140 @@
 #include <cassert>
+#include <cmath>
 #include <cstddef>
 #include <memory>
 #include <ranges>
-#include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
 #include "bjac/analysis/liveness.hpp"
 
 #include "bjac/graphs/linear_order.hpp"
 
+#include "bjac/IR/dense_map.hpp"
 #include "bjac/IR/function.hpp"
 #include "bjac/IR/instruction.hpp"
 #include "bjac/IR/phi_instruction.hpp"
 
+#include "bjac/utils/bit_vector.hpp"
+
 namespace bjac {
 
-LivenessAnalysis::LivenessAnalysis(const Function &func) {
-    using LiveIn = std::unordered_set<const Instruction *>;
-    using Segment = Lifetime::Segment;
+namespace {
+
+// Numbers instructions of the function densely and returns the bound of their numbers
+std::size_t renumber(const Function &func) {
+    func.renumber();
+    return func.numbered_instructions_count();
+}
 
+} // unnamed namespace
+
+LivenessAnalysis::LivenessAnalysis(const Function &func)
+    : base(renumber(func)), positions_(func.numbered_instructions_count()),
+      loop_depths_(func.numbered_blocks_count()) {
     const DFS<ConstFunctionGraphTraits> dfs{func};
     const DominatorTree<ConstFunctionGraphTraits> dom_tree{func, dfs};
     const LoopTree<ConstFunctionGraphTraits> loop_tree{func, dfs, dom_tree};
-    const LinearOrder<ConstFunctionGraphTraits> linear_order{func, dom_tree, loop_tree};
+    compute(func, loop_tree, LinearOrder<ConstFunctionGraphTraits>{func, dom_tree, loop_tree});
+}
+
+template <typename Traits>
+LivenessAnalysis::LivenessAnalysis(typename Traits::graph_type &func,
+                                   const DominatorTree<Traits> &dom_tree,
+                                   const LoopTree<Traits> &loop_tree)
+    : base(renumber(func)), positions_(func.numbered_instructions_count()),
+      loop_depths_(func.numbered_blocks_count()) {
+    compute(func, loop_tree, LinearOrder<Traits>{func, dom_tree, loop_tree});
+}
+
+template LivenessAnalysis::LivenessAnalysis(Function &,
+                                            const DominatorTree<MutFunctionGraphTraits> &,
+                                            const LoopTree<MutFunctionGraphTraits> &);
+template LivenessAnalysis::LivenessAnalysis(const Function &,
+                                            const DominatorTree<ConstFunctionGraphTraits> &,
+                                            const LoopTree<ConstFunctionGraphTraits> &);
+
+template <typename Traits>
+void LivenessAnalysis::compute(const Function &func, const LoopTree<Traits> &loop_tree,
+                               const LinearOrder<Traits> &linear_order) {
+    using Segment = Lifetime::Segment;
+
+    for (const auto *bb : linear_order) {
+        loop_depths_[*bb] = 0;
+    }
+    // vertices of a loop include vertices of its inner loops
+    auto nest = [this](this const auto &self, const auto &loop) -> void {
+        for (const auto *bb : loop.vertices()) {
+            ++loop_depths_[*bb];
+        }
+        for (const auto *inner_loop : loop.inner_loops()) {
+            self(*inner_loop);
+        }
+    };
+    for (const auto *loop : loop_tree.loops()) {
+        nest(*loop);
+    }
 
-    std::unordered_map<const BasicBlock *, LiveIn> live_ins;
-    live_ins.reserve(func.size());
+    // Live-in sets are bit vectors indexed by numbers of instructions. A set is allocated when its
+    // block is visited and released once all predecessors of the block have been visited, so only
+    // the sets of blocks on the frontier of the backward traversal are kept in memory
+    const auto n_instrs = func.numbered_instructions_count();
+    std::vector<BitVector> live_ins(func.numbered_blocks_count());
+    // counts edges rather than predecessors since a branch may have the same block on both paths
+    std::vector<std::size_t> unvisited_in_edges(func.numbered_blocks_count());
 
-    std::unordered_map<const Instruction *, std::size_t> numbering;
+    // maps bits of live sets back to instructions
+    std::vector<const Instruction *> instrs(n_instrs);
     for (std::size_t n = 0; const auto *bb : linear_order) {
+        for (const auto *succ : bb->successors()) {
+            ++unvisited_in_edges[succ->get_number()];
+        }
+
         std::ranges::view auto phi_instructions = bb->phi_instructions();
         for (const auto &instr : phi_instructions) {
-            numbering.emplace(std::addressof(instr), n);
+            positions_[instr] = n;
+            instrs[instr.get_number()] = std::addressof(instr);
         }
 
         n += !phi_instructions.empty();
 
         for (const auto &instr : bb->non_phi_instructions()) {
-            numbering.emplace(std::addressof(instr), n++);
+            positions_[instr] = n++;
+            instrs[instr.get_number()] = std::addressof(instr);
         }
     }
 
-    for (const auto *bb : linear_order | std::views::reverse) {
-        auto &live_in = live_ins[bb];
+    for (auto *bb : linear_order | std::views::reverse) {
+        auto &live_in = live_ins[bb->get_number()] = BitVector(n_instrs);
 
         for (const auto *succ : bb->successors()) {
-            live_in.insert_range(live_ins[succ]);
+            // the live-in set of a loop header is not computed yet when its latch is visited
+            if (const auto &succ_live_in = live_ins[succ->get_number()]; succ_live_in.size() != 0) {
+                live_in |= succ_live_in;
+            }
+
+            // operands of PHI instructions are aligned with predecessors of their block
+            const auto pred_index = succ->predecessor_index(*bb);
+            assert(pred_index);
             for (const auto &phi : succ->phi_instructions()) {
-                // TODO: try to deal with constness issues and remove const_cast
-                auto *input = static_cast<const PHIInstruction &>(phi).get_value(
-                    const_cast<BasicBlock &>(*bb));
+                auto *input = static_cast<const PHIInstruction &>(phi).get_value(*pred_index);
                 assert(input);
-                live_in.insert(input);
+                live_in.set(input->get_number());
             }
         }
 
-        const auto first_instr_n = numbering.at(std::addressof(bb->front()));
-        const auto last_instr_n = numbering.at(std::addressof(bb->back()));
+        const auto first_instr_n = positions_.at(bb->front());
+        const auto last_instr_n = positions_.at(bb->back());
 
-        for (const auto *instr : live_in) {
-            assert(instr);
-            (*this)[instr].add(Segment{first_instr_n, last_instr_n});
+        for (auto instr_number : live_in) {
+            assert(instrs[instr_number]);
+            (*this)[*instrs[instr_number]].add(Segment{first_instr_n, last_instr_n});
         }
 
         for (const auto &instr : bb->non_phi_instructions() | std::views::reverse) {
-            const auto instr_n = numbering.at(std::addressof(instr));
+            const auto instr_n = positions_.at(instr);
 
             if (instr.get_type_id() != Type::ID::kVoid) {
-                auto &lt = (*this)[std::addressof(instr)];
+                auto &lt = (*this)[instr];
                 auto seg = Segment{instr_n, last_instr_n};
                 if (auto it = lt.find(seg); it == lt.end()) {
                     lt.add(seg);
@@ -79,29 +146,43 @@ LivenessAnalysis::LivenessAnalysis(const Function &func) {
                     assert(it->start() == instr_n);
                 }
 
-                live_in.erase(std::addressof(instr));
+                live_in.reset(instr.get_number());
             }
 
             for (const auto *input : instr.inputs()) {
                 assert(input);
-                (*this)[input].add(Segment{first_instr_n, instr_n});
-                live_in.insert(input);
+                (*this)[*input].add(Segment{first_instr_n, instr_n});
+                live_in.set(input->get_number());
             }
         }
 
         for (const auto &phi : bb->phi_instructions()) {
-            live_in.erase(std::addressof(phi));
+            live_in.reset(phi.get_number());
         }
 
         if (loop_tree.is_header(bb)) {
             const auto &last_loop_instr = loop_tree.get_loop(bb).vertices().back()->back();
-            const auto loop_end = numbering.at(std::addressof(last_loop_instr));
-            for (const auto *instr : live_in) {
-                assert(instr);
-                (*this)[instr].add(Segment{first_instr_n, loop_end});
+            const auto loop_end = positions_.at(last_loop_instr);
+            for (auto instr_number : live_in) {
+                assert(instrs[instr_number]);
+                (*this)[*instrs[instr_number]].add(Segment{first_instr_n, loop_end});
             }
         }
+
+        for (const auto *succ : bb->successors()) {
+            if (--unvisited_in_edges[succ->get_number()] == 0) {
+                live_ins[succ->get_number()] = BitVector{};
+            }
+        }
+        if (unvisited_in_edges[bb->get_number()] == 0) {
+            live_ins[bb->get_number()] = BitVector{};
+        }
     }
 }
 
+double LivenessAnalysis::frequency(const BasicBlock &bb) const {
+    constexpr double kLoopFrequency = 10.0;
+    return std::pow(kLoopFrequency, static_cast<double>(loop_depth(bb)));
+}
+
 } // namespace bjac
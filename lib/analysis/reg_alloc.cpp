@@ -1,101 +1,698 @@
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <deque>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <optional>
+#include <queue>
 #include <ranges>
+#include <set>
+#include <span>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
+#include "bjac/analysis/lifetime.hpp"
 #include "bjac/analysis/liveness.hpp"
 #include "bjac/analysis/reg_alloc.hpp"
 
+#include "bjac/IR/argument_instruction.hpp"
+#include "bjac/IR/basic_block.hpp"
+#include "bjac/IR/call_instruction.hpp"
+#include "bjac/IR/dense_map.hpp"
 #include "bjac/IR/function.hpp"
+#include "bjac/IR/instruction.hpp"
+#include "bjac/IR/phi_instruction.hpp"
+
+#include "bjac/utils/bit_vector.hpp"
 
 namespace bjac {
 
+namespace {
+
+// Points of the allocator interleave reads and writes: the instruction at position n of the linear
+// order reads its operands at point 2n and writes its result at point 2n + 1. Hence an operand
+// dying at an instruction and the result of the instruction may share a register
+constexpr std::size_t read_point(std::size_t position) noexcept { return 2 * position; }
+constexpr std::size_t write_point(std::size_t position) noexcept { return 2 * position + 1; }
+
+// A value reloaded into a register shall be there before the instruction reads its operands
+constexpr std::size_t reload_point(std::size_t use) noexcept { return use & ~std::size_t{1}; }
+
+constexpr auto kNever = std::numeric_limits<std::size_t>::max();
+
+// Re-emitting a value is assumed to be twice as cheap as reloading it from the stack
+constexpr double kRematerializationDiscount = 0.5;
+
+// A part of the lifetime of a value in points of the allocator
+struct Interval {
+    std::size_t start() const { return range.start_point(); }
+    std::size_t end() const { return range.end_point(); }
+
+    // The first point not less than given one where the value must be in a register
+    std::size_t next_use(std::size_t point) const {
+        auto it = std::ranges::lower_bound(uses, point);
+        return it == uses.end() ? kNever : *it;
+    }
+
+    // The first segment not ending before given point: the one covering the point or, if the point
+    // is in a lifetime hole, the next one
+    Lifetime::const_iterator segment_at(std::size_t point) const {
+        return std::ranges::lower_bound(range, point, {}, &Lifetime::Segment::end);
+    }
+
+    // The last point before given one where the value must be in a register
+    std::size_t last_use_before(std::size_t point) const {
+        auto it = std::ranges::lower_bound(uses, point);
+        return it == uses.begin() ? start() : std::max(start(), *std::prev(it));
+    }
+
+    const Instruction *value;
+    std::size_t id;
+    Lifetime range;
+    std::vector<std::size_t> uses;
+    // uses of the value weighted by execution frequencies; shared by all parts of the value
+    double spill_weight;
+    RegAlloc::Storage storage;
+};
+
+Interval make_interval(const LivenessAnalysis &liveness, std::span<const double> frequencies,
+                       const Instruction &value, const Lifetime &lifetime, std::size_t id) {
+    using Segment = Lifetime::Segment;
+
+    // segments are visited in descending order to be appended to the range
+    Lifetime range;
+    for (auto it = lifetime.rbegin(); it != lifetime.rend(); ++it) {
+        const auto start = it->start() == lifetime.start_point() ? write_point(it->start())
+                                                                  : read_point(it->start());
+        range.add(Segment{start, std::max(start, read_point(it->end()))});
+    }
+
+    // a rematerializable value needs no register until its first use
+    std::vector<std::size_t> uses;
+    if (!value.is_phi() && !RegAlloc::is_rematerializable(value)) {
+        uses.push_back(write_point(liveness.position(value)));
+    }
+    for (const auto &use : value.get_uses()) {
+        // operands of PHI instructions are copied on control flow edges, and arguments of calls are
+        // passed according to the calling convention, so neither need to be in registers
+        const auto *user = use.get_user();
+        if (user->is_phi() || user->get_opcode() == Instruction::Opcode::kCall ||
+            !liveness.has_position(*user)) {
+            continue;
+        }
+        uses.push_back(read_point(liveness.position(*user)));
+    }
+    std::ranges::sort(uses);
+    const auto [first, last] = std::ranges::unique(uses);
+    uses.erase(first, last);
+
+    double spill_weight = 0.0;
+    for (auto use : uses) {
+        spill_weight += frequencies[use / 2];
+    }
+    if (RegAlloc::is_rematerializable(value)) {
+        spill_weight *= kRematerializationDiscount;
+    }
+
+    return Interval{.value = std::addressof(value),
+                    .id = id,
+                    .range = std::move(range),
+                    .uses = std::move(uses),
+                    .spill_weight = spill_weight,
+                    .storage = {}};
+}
+
+// An interval holding a register and the point it changes its state at. Ties are broken by ids of
+// intervals, so the order does not depend on addresses
+struct StateChange {
+    bool operator<(const StateChange &other) const {
+        return std::pair{point, interval->id} < std::pair{other.point, other.interval->id};
+    }
+
+    std::size_t point;
+    Interval *interval;
+};
+
+// Cuts the part of the interval starting at given point off into a new interval
+Interval &split(std::deque<Interval> &intervals, Interval &interval, std::size_t point) {
+    using Segment = Lifetime::Segment;
+
+    assert(interval.start() < point && point <= interval.end());
+
+    Lifetime head;
+    Lifetime tail;
+    for (auto it = interval.range.rbegin(); it != interval.range.rend(); ++it) {
+        if (it->start() >= point) {
+            tail.add(*it);
+        } else if (it->end() < point) {
+            head.add(*it);
+        } else {
+            tail.add(Segment{point, it->end()});
+            head.add(Segment{it->start(), point - 1});
+        }
+    }
+
+    const auto first_tail_use = std::ranges::lower_bound(interval.uses, point);
+    auto &part = intervals.emplace_back(
+        Interval{.value = interval.value,
+                 .id = intervals.size(),
+                 .range = std::move(tail),
+                 .uses = std::vector<std::size_t>(first_tail_use, interval.uses.end()),
+                 .spill_weight = interval.spill_weight,
+                 .storage = interval.storage});
+
+    interval.uses.erase(first_tail_use, interval.uses.end());
+    interval.range = std::move(head);
+
+    return part;
+}
+
+// The register the calling convention puts the value in: arguments of the function and of calls
+// are passed in argument registers, and results of calls and returned values in the return one
+std::optional<std::size_t> convention_register(const Instruction &value) {
+    using enum Instruction::Opcode;
+
+    if (value.get_opcode() == kArg) {
+        return RegAlloc::argument_register(
+            static_cast<const ArgumentInstruction &>(value).get_position());
+    }
+    if (value.get_opcode() == kCall) {
+        return RegAlloc::kReturnRegister;
+    }
+    for (const auto *user : value.get_users()) {
+        if (user->get_opcode() == kRet) {
+            return RegAlloc::kReturnRegister;
+        }
+        if (user->get_opcode() == kCall) {
+            const auto args = static_cast<const CallInstruction *>(user)->arguments();
+            const auto it = std::ranges::find(args, std::addressof(value));
+            return RegAlloc::argument_register(
+                static_cast<std::size_t>(std::ranges::distance(args.begin(), it)));
+        }
+    }
+    return std::nullopt;
+}
+
+} // unnamed namespace
+
+bool RegAlloc::is_rematerializable(const Instruction &value) noexcept {
+    using enum Instruction::Opcode;
+    return value.get_opcode() == kConst;
+}
+
 RegAlloc::RegAlloc(const Function &func, std::size_t free_regs_count) {
     if (free_regs_count == 0) {
         throw std::invalid_argument{"register allocation with 0 registers is meaningless"};
     }
+    if (free_regs_count == 1) {
+        throw std::invalid_argument{
+            "register allocation needs at least 2 registers for operands of binary instructions"};
+    }
 
-    constexpr bool kFree = true;
-    constexpr bool kOccupied = false;
-    std::vector<bool> free_regs(free_regs_count, kFree);
+    const LivenessAnalysis liveness{func};
 
-    struct LTInfo {
-        const Instruction *instr;
-        const Lifetime *lifetime;
+    // Estimated execution frequencies of instructions indexed by their positions. Uses are weighted
+    // by them, so values used in loops are the last to be evicted
+    std::vector<double> frequencies(func.numbered_instructions_count());
+    // read points of terminators of reachable blocks in ascending order
+    std::vector<std::size_t> block_ends;
+    for (const auto &bb : func) {
+        if (!liveness.has_position(bb.front())) {
+            continue;
+        }
+        const auto frequency = liveness.frequency(bb);
+        for (const auto &instr : bb) {
+            frequencies[liveness.position(instr)] = frequency;
+        }
+        block_ends.push_back(read_point(liveness.position(bb.back())));
+    }
+    std::ranges::sort(block_ends);
+
+    // intervals are never moved, so pointers to them stay valid while new ones are split off
+    std::deque<Interval> intervals;
+    for (const auto &[value, lifetime] : liveness) {
+        assert(!lifetime.empty());
+        intervals.push_back(
+            make_interval(liveness, frequencies, *value, lifetime, intervals.size()));
+    }
+
+    // intervals of values are enumerated in the order of instruction numbers, so ids break ties
+    // between intervals starting at the same point deterministically
+    auto starts_later = [](const Interval *lhs, const Interval *rhs) static {
+        return std::pair{lhs->start(), lhs->id} > std::pair{rhs->start(), rhs->id};
     };
+    std::priority_queue<Interval *, std::vector<Interval *>, decltype(starts_later)> unhandled;
+    for (auto &interval : intervals) {
+        unhandled.push(std::addressof(interval));
+    }
+
+    // Active intervals occupy their registers at the current point; inactive ones are in their
+    // lifetime holes and will need their registers later. Both sets are ordered by the points their
+    // intervals change state at: the end of the current segment of an active interval and the start
+    // of the next segment of an inactive one. Moving to the next point touches only the intervals
+    // changing state
+    std::set<StateChange> active;
+    std::set<StateChange> inactive;
 
-    struct EndPointCompare {
-        bool operator()(const LTInfo &lhs, const LTInfo &rhs) const {
-            return lhs.lifetime->end_point() < rhs.lifetime->end_point();
+    // Intervals of both sets holding each register. Registers of no interval are vacant, and
+    // registers of no active interval are unblocked, that is free at least at the current point.
+    // Both masks follow the intervals changing state, so only unblocked registers are looked at
+    // when no register is vacant, and only holders of a register are evicted from it
+    std::vector<std::vector<Interval *>> holders(free_regs_count);
+    std::vector<std::size_t> active_holders(free_regs_count);
+    BitVector vacant(free_regs_count);
+    BitVector unblocked(free_regs_count);
+    for (std::size_t reg = 0; reg != free_regs_count; ++reg) {
+        vacant.set(reg);
+        unblocked.set(reg);
+    }
+
+    auto release = [&](Interval &interval, std::size_t reg) {
+        std::erase(holders[reg], std::addressof(interval));
+        if (holders[reg].empty()) {
+            vacant.set(reg);
         }
     };
 
-    std::map<LTInfo, std::size_t, EndPointCompare> active;
+    auto deactivate = [&](std::set<StateChange>::const_iterator it) {
+        const auto reg = it->interval->storage.index;
+        active.erase(it);
+        if (--active_holders[reg] == 0) {
+            unblocked.set(reg);
+        }
+    };
 
-    auto expire_old_intervals = [&active, &free_regs](std::size_t current_point) -> void {
-        for (auto it = active.begin(), ite = active.end(); it != ite;) {
-            auto active_it = it++;
-            if (const auto [info, reg] = *active_it; info.lifetime->end_point() <= current_point) {
-                active.erase(active_it);
-                free_regs[reg] = kFree;
+    // Puts an interval holding a register to the set matching its state at given point or releases
+    // the register if the interval ends before the point
+    auto place = [&](Interval &interval, std::size_t point) {
+        const auto reg = interval.storage.index;
+        const auto seg = interval.segment_at(point);
+        if (seg == interval.range.end()) {
+            release(interval, reg);
+        } else if (seg->start() <= point) {
+            active.insert(StateChange{seg->end(), std::addressof(interval)});
+            if (active_holders[reg]++ == 0) {
+                unblocked.reset(reg);
             }
+        } else {
+            inactive.insert(StateChange{seg->start(), std::addressof(interval)});
         }
     };
 
-    auto spill_at_interval = [this, &active](LTInfo current_info) -> const Instruction * {
-        assert(!active.empty());
+    // Takes an interval holding a register out of the set it's in at given point. The interval has
+    // not changed state since it was placed, so the segment it was placed by is found again
+    auto displace = [&](Interval &interval, std::size_t point) {
+        const auto seg = interval.segment_at(point);
+        if (seg->start() <= point) {
+            const auto it = active.find(StateChange{seg->end(), std::addressof(interval)});
+            assert(it != active.end());
+            deactivate(it);
+        } else {
+            [[maybe_unused]] const auto erased =
+                inactive.erase(StateChange{seg->start(), std::addressof(interval)});
+            assert(erased == 1);
+        }
+    };
 
-        auto spill_it = std::prev(active.end());
-        const auto [spill_info, spill_reg] = *spill_it;
-        if (spill_info.lifetime->end_point() <= current_info.lifetime->end_point()) {
-            return current_info.instr;
+    auto activate = [&](Interval &interval) {
+        const auto reg = interval.storage.index;
+        holders[reg].push_back(std::addressof(interval));
+        vacant.reset(reg);
+        place(interval, interval.start());
+    };
+
+    // Constants are never stored: they are produced again at their uses instead. Arguments arrive
+    // in allocatable registers, which may be taken by other values once they are evicted, so
+    // arguments are stored like any other value
+    DenseMap<Instruction, std::size_t> stack_slots(func.numbered_instructions_count());
+    auto spill_storage = [this, &stack_slots](const Instruction &value) -> Storage {
+        if (value.get_opcode() == Instruction::Opcode::kConst) {
+            return {.kind = Storage::Kind::kRematerialized, .index = 0};
+        }
+        if (!stack_slots.contains(value)) {
+            stack_slots[value] = stack_slots_count_++;
         }
+        return {.kind = Storage::Kind::kStackSlot, .index = stack_slots.at(value)};
+    };
 
-        instr_to_reg_.try_emplace(current_info.instr, Storage::Kind::kRegister, spill_reg);
+    auto register_storage = [](std::size_t reg) static -> Storage {
+        return {.kind = Storage::Kind::kRegister, .index = reg};
+    };
 
-        auto node_handle = active.extract(spill_it);
-        node_handle.key() = current_info;
-        active.insert(std::move(node_handle));
+    // Registers values were given last. A part of a value prefers the register of the previous
+    // one, and PHI instructions and their inputs prefer each other's registers, so that no move
+    // is needed between them. Otherwise the calling convention decides, saving moves around calls
+    DenseMap<Instruction, std::size_t> last_registers(func.numbered_instructions_count());
+    auto preferred_register = [&](const Instruction &value) -> std::optional<std::size_t> {
+        if (last_registers.contains(value)) {
+            return last_registers.at(value);
+        }
+        if (value.is_phi()) {
+            for (const auto *input : static_cast<const PHIInstruction &>(value).get_values()) {
+                if (last_registers.contains(*input)) {
+                    return last_registers.at(*input);
+                }
+            }
+        }
+        for (const auto *user : value.get_users()) {
+            if (user->is_phi() && last_registers.contains(*user)) {
+                return last_registers.at(*user);
+            }
+        }
+        if (const auto reg = convention_register(value); reg && *reg < free_regs_count) {
+            return reg;
+        }
+        return std::nullopt;
+    };
 
-        return spill_info.instr;
+    auto assign_register = [&](Interval &interval, std::size_t reg) {
+        interval.storage = register_storage(reg);
+        last_registers[*interval.value] = reg;
     };
 
-    const std::vector<LTInfo> sorted_lifetimes = [&func] {
-        const LivenessAnalysis lifetimes{func};
-        std::vector<LTInfo> lifetime_infos{
-            std::from_range,
-            lifetimes | std::views::transform([](const auto &pair) static -> LTInfo {
-                return {.instr = pair.first, .lifetime = std::addressof(pair.second)};
-            })};
-        std::ranges::sort(lifetime_infos, {}, [](const LTInfo &info) static {
-            const auto *lt = info.lifetime;
-            assert(lt);
-            assert(!lt->empty());
-            return lt->start_point();
-        });
-        return lifetime_infos;
-    }();
-
-    for (std::size_t stack_loc = 0; const LTInfo &info : sorted_lifetimes) {
-        expire_old_intervals(info.lifetime->start_point());
-
-        if (active.size() == free_regs_count) {
-            const auto *instr = spill_at_interval(info);
-            instr_to_reg_[instr] = {.kind = Storage::Kind::kStackSlot, .index = stack_loc++};
-        } else {
-            auto free_reg_it = std::ranges::find(free_regs, kFree);
-            assert(free_reg_it != free_regs.end());
-            *free_reg_it = kOccupied;
-            const auto free_reg = free_reg_it - free_regs.begin();
+    std::vector<std::size_t> free_until(free_regs_count);
+    auto try_allocate_free_reg = [&](Interval &current) -> bool {
+        const auto position = current.start();
+        const auto preferred = preferred_register(*current.value);
 
-            instr_to_reg_.try_emplace(info.instr, Storage::Kind::kRegister, free_reg);
+        // A vacant register is free for the whole interval, and the lowest one is found by a scan
+        // of words of the bitmask. Otherwise, or if the preferred register is taken, a register
+        // held by active intervals is not free at all, and one held by inactive intervals only is
+        // free until the first of them intersects the current one
+        if (auto first_vacant = vacant.begin(); first_vacant != vacant.end()) {
+            if (!preferred || vacant.test(*preferred)) {
+                assign_register(current, preferred.value_or(*first_vacant));
+                activate(current);
+                return true;
+            }
+        }
 
-            active.emplace(info, free_reg);
+        std::size_t reg = 0;
+        std::size_t until = 0;
+        for (auto candidate : unblocked) {
+            auto &candidate_until = free_until[candidate];
+            candidate_until = kNever;
+            for (const auto *interval : holders[candidate]) {
+                if (auto point = interval->range.next_intersection(current.range, position)) {
+                    candidate_until = std::min(candidate_until, *point);
+                }
+            }
+            if (candidate_until > until) {
+                reg = candidate;
+                until = candidate_until;
+            }
         }
+
+        // the preferred register is taken if it's free for the whole interval
+        if (preferred && unblocked.test(*preferred) && free_until[*preferred] > current.end()) {
+            reg = *preferred;
+            until = free_until[reg];
+        }
+        if (until <= position) {
+            return false;
+        }
+
+        // the register is free only for the beginning of the interval
+        if (until <= current.end()) {
+            const auto point = reload_point(until);
+            if (point <= position) {
+                return false;
+            }
+            unhandled.push(std::addressof(split(intervals, current, point)));
+        }
+
+        assign_register(current, reg);
+        activate(current);
+        return true;
+    };
+
+    // A value not used in (from; to] may be stored to the stack anywhere in this range. The store
+    // is placed before the terminator of the least frequently executed block ending in the range if
+    // that block is executed less often than the point itself, so stores are hoisted out of loops
+    auto hoisted_split_point = [&](std::size_t from, std::size_t to) {
+        auto best = to;
+        const auto first = std::ranges::upper_bound(block_ends, from);
+        const auto last = std::ranges::upper_bound(block_ends, to);
+        for (auto end : std::ranges::subrange(first, last) | std::views::reverse) {
+            if (frequencies[end / 2] < frequencies[best / 2]) {
+                best = end;
+            }
+        }
+        return best;
+    };
+
+    // Moves the part of the interval starting at given point to the stack. The part is split again
+    // before its next use, and the rest of it waits for a register. Returns whether the whole
+    // interval has left its register
+    auto spill_from = [&](Interval &interval, std::size_t point) -> bool {
+        if (const auto use = interval.next_use(point); use == kNever || reload_point(use) > point) {
+            point = hoisted_split_point(interval.last_use_before(point), point);
+        }
+
+        auto &spilled = interval.start() < point ? split(intervals, interval, point) : interval;
+
+        if (const auto use = spilled.next_use(spilled.start()); use != kNever) {
+            if (const auto reload = reload_point(use); reload > spilled.start()) {
+                unhandled.push(std::addressof(split(intervals, spilled, reload)));
+            } else {
+                // the part is needed in a register right away
+                unhandled.push(std::addressof(spilled));
+                return std::addressof(spilled) == std::addressof(interval);
+            }
+        }
+
+        spilled.storage = spill_storage(*spilled.value);
+        return std::addressof(spilled) == std::addressof(interval);
+    };
+
+    std::vector<std::size_t> next_use(free_regs_count);
+    std::vector<double> eviction_cost(free_regs_count);
+    auto allocate_blocked_reg = [&](Interval &current) -> void {
+        const auto position = current.start();
+
+        // An interval holding a register occupies it if it's active or if it intersects the
+        // current one later. Returns the point it has to leave the register from
+        auto occupied_from = [&](const Interval &interval) -> std::optional<std::size_t> {
+            if (interval.segment_at(position)->start() <= position) {
+                return position;
+            }
+            return interval.range.next_intersection(current.range, position);
+        };
+
+        std::ranges::fill(next_use, kNever);
+        std::ranges::fill(eviction_cost, 0.0);
+        for (std::size_t reg = 0; reg != free_regs_count; ++reg) {
+            for (const auto *interval : holders[reg]) {
+                if (occupied_from(*interval)) {
+                    next_use[reg] = std::min(next_use[reg], interval->next_use(position));
+                    eviction_cost[reg] += interval->spill_weight;
+                }
+            }
+        }
+
+        // values needing their registers at the current point cannot be evicted
+        constexpr auto kInfinity = std::numeric_limits<double>::infinity();
+        for (std::size_t reg = 0; reg != free_regs_count; ++reg) {
+            if (reload_point(next_use[reg]) <= position) {
+                eviction_cost[reg] = kInfinity;
+            }
+        }
+
+        // the cheapest register to take away; ties are broken in favour of the one needed later
+        const auto reg = *std::ranges::min_element(
+            std::views::iota(0uz, free_regs_count), {}, [&](std::size_t i) {
+                return std::pair{eviction_cost[i], kNever - next_use[i]};
+            });
+        const auto first_use = current.next_use(position);
+        const auto needs_reg_now = first_use != kNever && reload_point(first_use) <= position;
+
+        // the current value is cheaper to keep on the stack until its first use than the values
+        // occupying any register
+        if (!needs_reg_now && (first_use == kNever || current.spill_weight <= eviction_cost[reg])) {
+            current.storage = spill_storage(*current.value);
+            if (first_use != kNever) {
+                const auto reload = reload_point(first_use);
+                assert(reload > position);
+                unhandled.push(std::addressof(split(intervals, current, reload)));
+            }
+            return;
+        }
+
+        // otherwise the register is taken away from the values occupying it. If all registers are
+        // needed right now, the one needed the latest is chosen
+        const auto victim =
+            eviction_cost[reg] != kInfinity
+                ? reg
+                : static_cast<std::size_t>(std::ranges::max_element(next_use) - next_use.begin());
+        assign_register(current, victim);
+
+        // intervals holding the register are evicted from the points they intersect the current
+        // one at; parts of them before these points keep the register
+        std::vector<std::pair<Interval *, std::size_t>> evicted;
+        for (auto *interval : holders[victim]) {
+            if (const auto point = occupied_from(*interval)) {
+                evicted.emplace_back(interval, *point);
+            }
+        }
+        for (auto [interval, point] : evicted) {
+            displace(*interval, position);
+            if (spill_from(*interval, point)) {
+                release(*interval, victim);
+            } else {
+                place(*interval, position);
+            }
+        }
+
+        activate(current);
+    };
+
+    while (!unhandled.empty()) {
+        auto &current = *unhandled.top();
+        unhandled.pop();
+
+        const auto position = current.start();
+
+        // only intervals whose segments have ended or begun by the position change their sets
+        while (!active.empty() && active.begin()->point < position) {
+            auto &interval = *active.begin()->interval;
+            deactivate(active.begin());
+            place(interval, position);
+        }
+        while (!inactive.empty() && inactive.begin()->point <= position) {
+            auto &interval = *inactive.begin()->interval;
+            inactive.erase(inactive.begin());
+            place(interval, position);
+        }
+
+        // a constant read only by PHI instructions and calls never needs a register
+        if (is_rematerializable(*current.value) && current.uses.empty()) {
+            current.storage = spill_storage(*current.value);
+            continue;
+        }
+
+        if (!try_allocate_free_reg(current)) {
+            allocate_blocked_reg(current);
+        }
+    }
+
+    // Stack slot coloring. A value occupies its slot from the move storing it until the move
+    // reloading it, so values whose stack parts never overlap share one slot
+    std::vector<Lifetime> occupancies(stack_slots_count_);
+    for (const auto &interval : intervals) {
+        if (interval.storage.kind == Storage::Kind::kStackSlot) {
+            occupancies[interval.storage.index].add(
+                Lifetime::Segment{interval.start() / 2, (interval.end() + 1) / 2});
+        }
+    }
+
+    const auto [slots, slots_count] = color_greedily(occupancies);
+    for (auto &interval : intervals) {
+        if (interval.storage.kind == Storage::Kind::kStackSlot) {
+            interval.storage.index = slots[interval.storage.index];
+        }
+    }
+    stack_slots_count_ = slots_count;
+
+    // positions of the first instructions of reachable blocks
+    std::vector<bool> is_block_start(func.numbered_instructions_count());
+    for (const auto &bb : func) {
+        if (liveness.has_position(bb.front())) {
+            is_block_start[liveness.position(bb.front())] = true;
+        }
+    }
+
+    // The first part of a value begins at its definition, others begin at the first instruction
+    // reading the value from them. Adjacent intervals in the same location form one part
+    std::ranges::sort(intervals, {}, [](const Interval &interval) static {
+        return std::pair{interval.value->get_number(), interval.start()};
+    });
+
+    instr_to_parts_ = Container{func.numbered_instructions_count()};
+    for (const auto &interval : intervals) {
+        const auto start = interval.start();
+        auto &parts = instr_to_parts_[*interval.value];
+        if (parts.empty()) {
+            parts.push_back({.position = start / 2, .storage = interval.storage});
+            continue;
+        }
+
+        const auto from = parts.back().storage;
+        if (interval.storage == from) {
+            continue;
+        }
+
+        // moves at the beginning of a block are resolved on its incoming edges
+        if (interval.storage.kind != Storage::Kind::kRematerialized &&
+            (start != read_point(start / 2) || !is_block_start[start / 2])) {
+            moves_.push_back({.value = interval.value,
+                              .from = from,
+                              .to = interval.storage,
+                              .position = start / 2});
+        }
+        parts.push_back({.position = (start + 1) / 2, .storage = interval.storage});
+    }
+
+    // a value live into a block may be in different locations at the ends of its predecessors
+    for (const auto &[value, parts] : instr_to_parts_) {
+        if (parts.size() == 1) {
+            continue;
+        }
+
+        const auto &lifetime = liveness.at(*value);
+        for (const auto &bb : func) {
+            if (!liveness.has_position(bb.front())) {
+                continue;
+            }
+
+            const auto start = liveness.position(bb.front());
+            if (start == lifetime.start_point() || !lifetime.intersects(start)) {
+                continue;
+            }
+
+            const auto &to = at(*value, start);
+            if (to.kind == Storage::Kind::kRematerialized) {
+                continue;
+            }
+            for (const auto *pred : bb.predecessors()) {
+                if (!liveness.has_position(pred->back())) {
+                    continue;
+                }
+
+                const auto end = liveness.position(pred->back());
+                if (const auto &from = at(*value, end); from != to) {
+                    moves_.push_back({.value = value,
+                                      .from = from,
+                                      .to = to,
+                                      .position = end,
+                                      .successor = std::addressof(bb)});
+                }
+            }
+        }
+    }
+
+    for (const auto &move : moves_) {
+        if (move.from.kind != Storage::Kind::kStackSlot &&
+            move.to.kind != Storage::Kind::kStackSlot) {
+            continue;
+        }
+        // a move on an edge runs as often as the rarer of its ends
+        spill_cost_ += move.successor ? std::min(frequencies[move.position],
+                                                 liveness.frequency(*move.successor))
+                                      : frequencies[move.position];
+    }
+}
+
+const RegAlloc::Storage &RegAlloc::at(const Instruction &instr, std::size_t position) const {
+    const auto value_parts = parts(instr);
+    // the last part beginning not after the position
+    auto it = std::ranges::upper_bound(value_parts, position, {}, &Part::position);
+    if (it == value_parts.begin()) {
+        throw std::out_of_range{"the value is not defined yet at this position"};
     }
+    return std::prev(it)->storage;
 }
 
 } // namespace bjac
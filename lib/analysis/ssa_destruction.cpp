@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <vector>
+
+#include "bjac/analysis/graph_coloring.hpp"
+#include "bjac/analysis/liveness.hpp"
+#include "bjac/analysis/reg_alloc.hpp"
+#include "bjac/analysis/ssa_destruction.hpp"
+
+#include "bjac/IR/basic_block.hpp"
+#include "bjac/IR/dense_map.hpp"
+#include "bjac/IR/function.hpp"
+#include "bjac/IR/instruction.hpp"
+#include "bjac/IR/phi_instruction.hpp"
+
+namespace bjac {
+
+namespace {
+
+SSADestruction::Placement placement(const BasicBlock &pred, const BasicBlock &succ) {
+    using enum SSADestruction::Placement;
+    if (std::ranges::size(pred.successors()) == 1) {
+        return kPredecessorEnd;
+    }
+    if (std::ranges::size(succ.predecessors()) == 1) {
+        return kSuccessorStart;
+    }
+    return kSplitEdge;
+}
+
+} // unnamed namespace
+
+template <RegisterAllocator Allocator>
+SSADestruction::SSADestruction(const Function &func, const Allocator &allocator,
+                               std::optional<Storage> scratch) {
+    const LivenessAnalysis liveness{func};
+
+    // parallel copies of all edges entering reachable blocks; edges of a block are contiguous and
+    // follow the order of its predecessors
+    std::vector<Edge> edges;
+    DenseMap<BasicBlock, std::size_t> first_edges(func.numbered_blocks_count());
+    for (const auto &succ : func) {
+        if (!liveness.has_position(succ.front())) {
+            continue;
+        }
+        first_edges[succ] = edges.size();
+        for (const auto *pred : succ.predecessors()) {
+            edges.push_back(Edge{.pred = pred,
+                                 .succ = std::addressof(succ),
+                                 .placement = placement(*pred, succ),
+                                 .copies = {}});
+        }
+    }
+
+    // PHI instructions without users have no lifetimes and get no locations
+    for (const auto *value : liveness | std::views::keys) {
+        if (!value->is_phi()) {
+            continue;
+        }
+        const auto &phi = static_cast<const PHIInstruction &>(*value);
+        const auto &succ = phi.get_parent();
+        const auto &to = allocator.at(phi);
+        for (auto [i, pred] : std::views::enumerate(succ.predecessors())) {
+            if (!liveness.has_position(pred->back())) {
+                continue;
+            }
+            const auto *input = phi.get_value(static_cast<std::size_t>(i));
+            assert(input);
+            const auto &from = allocator.at(*input, liveness.position(pred->back()));
+            if (from == to) {
+                ++coalesced_copies_count_;
+                continue;
+            }
+            edges[first_edges.at(succ) + static_cast<std::size_t>(i)].copies.push_back(
+                Copy{.kind = Copy::kMove, .value = input, .from = from, .to = to});
+        }
+    }
+
+    // the allocator resolves locations of other values on the edges
+    for (const auto &move : allocator.moves()) {
+        if (move.successor == nullptr) {
+            continue;
+        }
+        const auto preds = move.successor->predecessors();
+        auto it = std::ranges::find_if(preds, [&liveness, &move](const BasicBlock *pred) {
+            return liveness.has_position(pred->back()) &&
+                   liveness.position(pred->back()) == move.position;
+        });
+        assert(it != preds.end());
+        const auto i = static_cast<std::size_t>(std::ranges::distance(preds.begin(), it));
+        edges[first_edges.at(*move.successor) + i].copies.push_back(
+            Copy{.kind = Copy::kMove, .value = move.value, .from = move.from, .to = move.to});
+    }
+
+    for (auto &edge : edges) {
+        if (edge.copies.empty()) {
+            continue;
+        }
+        edge.copies = sequentialize(edge.copies, scratch);
+        copies_count_ += edge.copies.size();
+        split_edges_count_ += edge.placement == Placement::kSplitEdge;
+        edges_.push_back(std::move(edge));
+    }
+}
+
+template SSADestruction::SSADestruction(const Function &, const RegAlloc &,
+                                         std::optional<Storage>);
+template SSADestruction::SSADestruction(const Function &, const GraphColoringRegAlloc &,
+                                         std::optional<Storage>);
+
+std::vector<SSADestruction::Copy> SSADestruction::sequentialize(std::span<const Copy> parallel,
+                                                                std::optional<Storage> scratch) {
+    std::vector<Copy> pending;
+    for (const auto &copy : parallel) {
+        assert(copy.kind == Copy::kMove);
+        assert(std::ranges::none_of(parallel, [&copy](const Copy &other) {
+            return std::addressof(other) != std::addressof(copy) && other.to == copy.to;
+        }));
+        if (copy.from != copy.to) {
+            pending.push_back(copy);
+        }
+    }
+
+    // moves reading from a location read from the other one now, and those left in place vanish
+    auto redirect = [&pending](const Storage &from, const Storage &to) {
+        for (auto &copy : pending) {
+            if (copy.from == from) {
+                copy.from = to;
+            }
+        }
+        std::erase_if(pending, [](const Copy &copy) static { return copy.from == copy.to; });
+    };
+
+    std::vector<Copy> sequence;
+    while (!pending.empty()) {
+        // a move whose destination is read by no other move can be done right away
+        auto ready = std::ranges::find_if(pending, [&pending](const Copy &copy) {
+            return std::ranges::none_of(
+                pending, [&copy](const Copy &other) { return other.from == copy.to; });
+        });
+        if (ready != pending.end()) {
+            sequence.push_back(*ready);
+            pending.erase(ready);
+            continue;
+        }
+
+        // Every destination is read, so the moves left form disjoint cycles: each location is
+        // written once and read once. The cycle is broken at its first move
+        const auto copy = pending.front();
+        if (scratch) {
+            const auto reader = std::ranges::find(pending, copy.to, &Copy::from);
+            sequence.push_back(
+                Copy{.kind = Copy::kMove, .value = reader->value, .from = copy.to, .to = *scratch});
+            redirect(copy.to, *scratch);
+        } else {
+            // the source receives the value of the destination, which the next move of the cycle
+            // reads now from there
+            sequence.push_back(
+                Copy{.kind = Copy::kSwap, .value = copy.value, .from = copy.from, .to = copy.to});
+            pending.erase(pending.begin());
+            redirect(copy.to, copy.from);
+        }
+    }
+    return sequence;
+}
+
+} // namespace bjac
@@ -0,0 +1,84 @@
+#include <memory>
+#include <utility>
+
+#include "bjac/transforms/analysis_manager.hpp"
+
+#include "bjac/graphs/dfs.hpp"
+#include "bjac/graphs/dominator_tree.hpp"
+#include "bjac/graphs/loop_tree.hpp"
+
+#include "bjac/IR/function.hpp"
+
+namespace bjac {
+
+const DFS<AnalysisManager::Traits> &AnalysisManager::dfs(Function &f) {
+    auto &results = results_[std::addressof(f)];
+    if (!results.dfs) {
+        results.dfs.emplace(f);
+        ++computations_count_;
+    }
+    return *results.dfs;
+}
+
+const DominatorTree<AnalysisManager::Traits> &AnalysisManager::dom_tree(Function &f) {
+    const auto &dfs = this->dfs(f);
+    auto &results = results_[std::addressof(f)];
+    if (!results.dom_tree) {
+        results.dom_tree.emplace(f, dfs);
+        ++computations_count_;
+    }
+    return *results.dom_tree;
+}
+
+const LoopTree<AnalysisManager::Traits> &AnalysisManager::loop_tree(Function &f) {
+    const auto &dom_tree = this->dom_tree(f);
+    auto &results = results_[std::addressof(f)];
+    if (!results.loop_tree) {
+        results.loop_tree.emplace(f, *results.dfs, dom_tree);
+        ++computations_count_;
+    }
+    return *results.loop_tree;
+}
+
+bool AnalysisManager::is_cached(const Function &f, Analysis analysis) const {
+    auto it = results_.find(std::addressof(f));
+    if (it == results_.end()) {
+        return false;
+    }
+
+    const auto &results = it->second;
+    switch (analysis) {
+    case Analysis::kDFS:
+        return results.dfs.has_value();
+    case Analysis::kDominatorTree:
+        return results.dom_tree.has_value();
+    case Analysis::kLoopTree:
+        return results.loop_tree.has_value();
+    default:
+        std::unreachable();
+    }
+}
+
+void AnalysisManager::invalidate(const Function &f, PreservedAnalyses preserved) {
+    auto it = results_.find(std::addressof(f));
+    if (it == results_.end()) {
+        return;
+    }
+
+    // dependent analyses are dropped first
+    auto &results = it->second;
+    if (!preserved.is_preserved(Analysis::kLoopTree) ||
+        !preserved.is_preserved(Analysis::kDominatorTree) ||
+        !preserved.is_preserved(Analysis::kDFS)) {
+        results.loop_tree.reset();
+    }
+    if (!preserved.is_preserved(Analysis::kDominatorTree) ||
+        !preserved.is_preserved(Analysis::kDFS)) {
+        results.dom_tree.reset();
+    }
+    if (!preserved.is_preserved(Analysis::kDFS)) {
+        results_.erase(it);
+    }
+}
+
+} // namespace bjac
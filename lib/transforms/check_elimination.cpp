@@ -13,6 +13,7 @@
 #include "bjac/IR/bounds_check.hpp"
 #include "bjac/IR/null_check.hpp"
 
+#include "bjac/transforms/analysis_manager.hpp"
 #include "bjac/transforms/check_elimination.hpp"
 
 #include "bjac/graphs/dfs.hpp"
@@ -85,9 +86,9 @@ class CheckHandler {
 
 } // unnamed namespace
 
-void CheckEliminationPass::run(Function &f) {
-    const DFS<MutFunctionGraphTraits> dfs{f};
-    const DominatorTree<MutFunctionGraphTraits> dom_tree{f, dfs};
+PreservedAnalyses CheckEliminationPass::run_impl(Function &f, AnalysisManager &am) {
+    const auto &dfs = am.dfs(f);
+    const auto &dom_tree = am.dom_tree(f);
 
     std::vector<BasicBlock::iterator> to_remove;
 
@@ -114,6 +115,9 @@ void CheckEliminationPass::run(Function &f) {
     for (auto check_it : to_remove) {
         check_it->get_parent().remove_instruction(check_it);
     }
+
+    // checks are never terminators, so blocks and edges stay
+    return to_remove.empty() ? PreservedAnalyses::all() : PreservedAnalyses::cfg();
 }
 
 } // namespace bjac
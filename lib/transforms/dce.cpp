@@ -3,14 +3,27 @@
 
 #include "bjac/graphs/dfs.hpp"
 
+#include "bjac/transforms/analysis_manager.hpp"
 #include "bjac/transforms/dce.hpp"
 
 namespace bjac {
 
 namespace {
 
-void remove_unreachable_blocks(Function &f) {
-    const DFS<MutFunctionGraphTraits> dfs{f};
+// Returns whether any block has been removed
+bool remove_unreachable_blocks(Function &f, const DFS<MutFunctionGraphTraits> &dfs) {
+    if (dfs.post_order().size() == f.size()) {
+        return false;
+    }
+
+    // Function::erase() doesn't go through BasicBlock::erase(), so terminators are removed first for
+    // successors to drop the blocks from their predecessors and PHI instructions
+    for (auto &bb : f) {
+        if (!dfs.contains(std::addressof(bb)) && bb.get_terminator() != nullptr) {
+            bb.pop_back();
+        }
+    }
+
     for (auto it = f.begin(), ite = f.end(); it != ite;) {
         if (dfs.contains(std::addressof(*it))) {
             ++it;
@@ -20,27 +33,35 @@ void remove_unreachable_blocks(Function &f) {
             it = next_it;
         }
     }
+    return true;
 }
 
-void remove_unused_instructions(Function &f) {
+// Returns whether any instruction has been removed
+bool remove_unused_instructions(Function &f) {
+    bool changed = false;
     for (auto &bb : f) {
         for (auto it = bb.begin(), ite = bb.end(); it != ite;) {
             if (it->get_type_id() != Type::ID::kVoid && it->users_count() == 0) {
                 auto next_it = std::next(it);
                 bb.erase(it);
                 it = next_it;
+                changed = true;
             } else {
                 ++it;
             }
         }
     }
+    return changed;
 }
 
 } // unnamed namespace
 
-void DCE::run(Function &f) {
-    remove_unreachable_blocks(f);
-    remove_unused_instructions(f);
+PreservedAnalyses DCE::run_impl(Function &f, AnalysisManager &am) {
+    if (remove_unreachable_blocks(f, am.dfs(f))) {
+        remove_unused_instructions(f);
+        return PreservedAnalyses::none();
+    }
+    return remove_unused_instructions(f) ? PreservedAnalyses::cfg() : PreservedAnalyses::all();
 }
 
 } // namespace bjac
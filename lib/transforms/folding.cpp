@@ -0,0 +1,175 @@
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <utility>
+
+#include "bjac/IR/binary_operator.hpp"
+#include "bjac/IR/constant_instruction.hpp"
+#include "bjac/IR/icmp_instruction.hpp"
+#include "bjac/IR/instruction.hpp"
+#include "bjac/IR/type.hpp"
+
+#include "bjac/transforms/folding.hpp"
+
+namespace bjac {
+
+namespace {
+
+// Operands narrower than int are promoted, so results are truncated back to the width of the type
+template <typename F>
+std::uintmax_t apply_bin_op(F op, const Type::ID type_id, std::uintmax_t lhs, std::uintmax_t rhs) {
+    using enum Type::ID;
+    switch (type_id) {
+    case kI1:
+        return op(static_cast<bool>(lhs), static_cast<bool>(rhs)) & 1u;
+    case kI8:
+        return static_cast<std::uint8_t>(
+            op(static_cast<std::uint8_t>(lhs), static_cast<std::uint8_t>(rhs)));
+    case kI16:
+        return static_cast<std::uint16_t>(
+            op(static_cast<std::uint16_t>(lhs), static_cast<std::uint16_t>(rhs)));
+    case kI32:
+        return static_cast<std::uint32_t>(
+            op(static_cast<std::uint32_t>(lhs), static_cast<std::uint32_t>(rhs)));
+    case kI64:
+        return op(static_cast<std::uint64_t>(lhs), static_cast<std::uint64_t>(rhs));
+    default:
+        std::unreachable();
+    }
+}
+
+} // unnamed namespace
+
+std::optional<std::uintmax_t> fold_binary_operator(Instruction::Opcode opcode, const Type &type,
+                                                  std::uintmax_t lhs, std::uintmax_t rhs) {
+    using enum Instruction::Opcode;
+
+    const Type::ID type_id = type.id();
+    switch (opcode) {
+    case kAdd:
+        return apply_bin_op(std::plus{}, type_id, lhs, rhs);
+    case kSub:
+        return apply_bin_op(std::minus{}, type_id, lhs, rhs);
+    case kMul:
+        return apply_bin_op(std::multiplies{}, type_id, lhs, rhs);
+    case kUDiv:
+        if (rhs == 0) { // do not optimize if encounter division by 0
+            return std::nullopt;
+        }
+        return apply_bin_op(std::divides{}, type_id, lhs, rhs);
+    case kSDiv:
+        if (rhs == 0) { // do not optimize if encounter division by 0
+            return std::nullopt;
+        }
+        return apply_bin_op(
+            [](std::uintmax_t l, std::uintmax_t r) -> std::uintmax_t {
+                return static_cast<std::intmax_t>(l) / static_cast<std::intmax_t>(r);
+            },
+            type_id, lhs, rhs);
+
+    case kURem:
+        if (rhs == 0) { // do not optimize if encounter division by 0
+            return std::nullopt;
+        }
+        return apply_bin_op(std::modulus{}, type_id, lhs, rhs);
+    case kSRem:
+        if (rhs == 0) { // do not optimize if encounter division by 0
+            return std::nullopt;
+        }
+        return apply_bin_op(
+            [](std::uintmax_t l, std::uintmax_t r) -> std::uintmax_t {
+                return static_cast<std::intmax_t>(l) % static_cast<std::intmax_t>(r);
+            },
+            type_id, lhs, rhs);
+    case kShl:
+        if (rhs >=
+            bit_width(type)) { // do not optimize shifts for more than type's width
+            return std::nullopt;
+        }
+        return apply_bin_op([](std::uintmax_t l, std::uintmax_t r) { return l << r; }, type_id, lhs,
+                            rhs);
+    case kShrA:
+        if (rhs >=
+            bit_width(type)) { // do not optimize shifts for more than type's width
+            return std::nullopt;
+        }
+        return apply_bin_op(
+            [](std::uintmax_t l, std::uintmax_t r) -> std::uintmax_t {
+                return static_cast<std::intmax_t>(l) >> r;
+            },
+            type_id, lhs, rhs);
+    case kShrL:
+        if (rhs >=
+            bit_width(type)) { // do not optimize shifts for more than type's width
+            return std::nullopt;
+        }
+        return apply_bin_op([](std::uintmax_t l, std::uintmax_t r) { return l >> r; }, type_id, lhs,
+                            rhs);
+    case kAnd:
+        return apply_bin_op(std::bit_and{}, type_id, lhs, rhs);
+    case kOr:
+        return apply_bin_op(std::bit_or{}, type_id, lhs, rhs);
+    case kXor:
+        return apply_bin_op(std::bit_xor{}, type_id, lhs, rhs);
+    default:
+        std::unreachable();
+    }
+}
+
+bool fold_icmp(ICmpInstruction::Kind kind, std::uintmax_t lhs, std::uintmax_t rhs) {
+    using enum ICmpInstruction::Kind;
+    switch (kind) {
+    case eq:
+        return lhs == rhs;
+    case ne:
+        return lhs != rhs;
+    case ugt:
+        return lhs > rhs;
+    case uge:
+        return lhs >= rhs;
+    case ult:
+        return lhs < rhs;
+    case ule:
+        return lhs <= rhs;
+    case sgt:
+        return static_cast<std::intmax_t>(lhs) > static_cast<std::intmax_t>(rhs);
+    case sge:
+        return static_cast<std::intmax_t>(lhs) >= static_cast<std::intmax_t>(rhs);
+    case slt:
+        return static_cast<std::intmax_t>(lhs) < static_cast<std::intmax_t>(rhs);
+    case sle:
+        return static_cast<std::intmax_t>(lhs) <= static_cast<std::intmax_t>(rhs);
+    default:
+        std::unreachable();
+    }
+}
+
+std::optional<std::uintmax_t> fold(const Instruction &instr) {
+    using enum Instruction::Opcode;
+
+    auto constant = [](const Instruction *input) static -> std::optional<std::uintmax_t> {
+        if (input->get_opcode() != kConst) {
+            return std::nullopt;
+        }
+        return static_cast<const ConstInstruction *>(input)->get_value();
+    };
+
+    if (instr.is_binary_op()) {
+        const auto &bin_op = static_cast<const BinaryOperator &>(instr);
+        const auto lhs = constant(bin_op.get_lhs());
+        const auto rhs = constant(bin_op.get_rhs());
+        if (lhs && rhs) {
+            return fold_binary_operator(bin_op.get_opcode(), bin_op.get_type(), *lhs, *rhs);
+        }
+    } else if (instr.get_opcode() == kICmp) {
+        const auto &icmp = static_cast<const ICmpInstruction &>(instr);
+        const auto lhs = constant(icmp.get_lhs());
+        const auto rhs = constant(icmp.get_rhs());
+        if (lhs && rhs) {
+            return fold_icmp(icmp.get_kind(), *lhs, *rhs);
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace bjac
@@ -0,0 +1,364 @@
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <ranges>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "bjac/graphs/dfs.hpp"
+
+#include "bjac/IR/basic_block.hpp"
+#include "bjac/IR/binary_operator.hpp"
+#include "bjac/IR/constant_instruction.hpp"
+#include "bjac/IR/function.hpp"
+#include "bjac/IR/icmp_instruction.hpp"
+#include "bjac/IR/instruction.hpp"
+#include "bjac/IR/type.hpp"
+
+#include "bjac/transforms/analysis_manager.hpp"
+#include "bjac/transforms/folding.hpp"
+#include "bjac/transforms/inst_combine.hpp"
+
+namespace bjac {
+
+namespace {
+
+std::optional<std::uintmax_t> constant(const Instruction *instr) {
+    if (instr->get_opcode() != Instruction::Opcode::kConst) {
+        return std::nullopt;
+    }
+    return static_cast<const ConstInstruction *>(instr)->get_value();
+}
+
+std::uintmax_t all_ones(const Type &type) {
+    const auto width = bit_width(type);
+    return width == std::numeric_limits<std::uintmax_t>::digits
+               ? std::numeric_limits<std::uintmax_t>::max()
+               : (std::uintmax_t{1} << width) - 1;
+}
+
+// (x op c1) op c2 == x op (c1 op c2)
+bool is_associative(Instruction::Opcode opcode) {
+    using enum Instruction::Opcode;
+    return opcode == kAdd || opcode == kMul || opcode == kAnd || opcode == kOr || opcode == kXor;
+}
+
+// Returns y if instr is 0 - y
+Instruction *negated(Instruction *instr) {
+    if (instr->get_opcode() != Instruction::Opcode::kSub) {
+        return nullptr;
+    }
+    auto &sub = static_cast<BinaryOperator &>(*instr);
+    return constant(sub.get_lhs()) == 0 ? sub.get_rhs() : nullptr;
+}
+
+// Instructions without side effects, which are erased once they have no users
+bool is_pure(const Instruction &instr) {
+    using enum Instruction::Opcode;
+    return instr.is_binary_op() || instr.get_opcode() == kICmp || instr.get_opcode() == kConst;
+}
+
+class Combiner final {
+  public:
+    // Instructions are visited in the reverse post order of blocks, so operands usually come
+    // before their users
+    explicit Combiner(const DFS<MutFunctionGraphTraits> &dfs) {
+        for (auto *bb : dfs.post_order()) {
+            for (auto &instr : *bb | std::views::reverse) {
+                push(instr);
+            }
+        }
+    }
+
+    // Returns the number of instructions rewritten or erased
+    std::size_t run() {
+        std::size_t rewrites = 0;
+        while (!worklist_.empty()) {
+            auto *instr = worklist_.back();
+            worklist_.pop_back();
+            // the instruction has been erased since it was queued
+            if (queued_.erase(instr) == 0) {
+                continue;
+            }
+            rewrites += combine(*instr);
+        }
+        return rewrites;
+    }
+
+  private:
+    void push(Instruction &instr) {
+        if (queued_.insert(std::addressof(instr)).second) {
+            worklist_.push_back(std::addressof(instr));
+        }
+    }
+
+    void push_users(Instruction &instr) {
+        for (auto *user : instr.get_users()) {
+            push(*user);
+        }
+    }
+
+    void push_operands(Instruction &instr) {
+        for (auto *input : instr.inputs()) {
+            push(*input);
+        }
+    }
+
+    bool combine(Instruction &instr) {
+        if (instr.users_count() == 0 && is_pure(instr)) {
+            push_operands(instr);
+            erase(instr);
+            return true;
+        }
+
+        auto *result = simplify(instr);
+        if (result == nullptr) {
+            return false;
+        }
+
+        push_users(instr);
+        if (result == std::addressof(instr)) {
+            push(instr);
+        } else {
+            // operands may be left without users
+            push_operands(instr);
+            push(*result);
+            replace(instr, *result);
+        }
+        return true;
+    }
+
+    // Returns the value replacing the instruction, the instruction itself if it has been changed
+    // in place, or nullptr
+    Instruction *simplify(Instruction &instr) {
+        if (const auto value = fold(instr)) {
+            return std::addressof(make_const(instr, *value));
+        }
+        if (instr.is_binary_op()) {
+            return simplify_binary_operator(static_cast<BinaryOperator &>(instr));
+        }
+        if (instr.get_opcode() == Instruction::Opcode::kICmp) {
+            return simplify_icmp(static_cast<ICmpInstruction &>(instr));
+        }
+        return nullptr;
+    }
+
+    Instruction *simplify_binary_operator(BinaryOperator &bin_op) {
+        using enum Instruction::Opcode;
+
+        const auto opcode = bin_op.get_opcode();
+        const auto &type = bin_op.get_type();
+        auto *lhs = bin_op.get_lhs();
+        auto *rhs = bin_op.get_rhs();
+
+        // constants of commutative operations go to the right, so the rules below look only there
+        if (is_associative(opcode) && constant(lhs) && !constant(rhs)) {
+            bin_op.set_lhs(*rhs);
+            bin_op.set_rhs(*lhs);
+            return std::addressof(bin_op);
+        }
+
+        if (lhs == rhs) {
+            switch (opcode) {
+            case kSub: // x - x -> 0
+            case kXor: // x ^ x -> 0
+                return std::addressof(make_const(bin_op, 0));
+            case kAnd: // x & x -> x
+            case kOr:  // x | x -> x
+                return lhs;
+            default:
+                break;
+            }
+        }
+
+        if (constant(lhs) == 0) {
+            switch (opcode) {
+            case kShl:  // 0 << x -> 0
+            case kShrA: // 0 >> x -> 0
+            case kShrL: // 0 >> x -> 0
+                return lhs;
+            default:
+                break;
+            }
+        }
+
+        const auto c = constant(rhs);
+        if (!c) {
+            if (opcode == kAdd) {
+                if (auto *y = negated(rhs)) { // x + (0 - y) -> x - y
+                    return std::addressof(make_binary_operator(bin_op, kSub, *lhs, *y));
+                }
+                if (auto *y = negated(lhs)) { // (0 - y) + x -> x - y
+                    return std::addressof(make_binary_operator(bin_op, kSub, *rhs, *y));
+                }
+            } else if (opcode == kSub) {
+                if (auto *y = negated(rhs)) { // x - (0 - y) -> x + y
+                    return std::addressof(make_binary_operator(bin_op, kAdd, *lhs, *y));
+                }
+            }
+            return nullptr;
+        }
+
+        switch (opcode) {
+        case kAdd:
+        case kXor:
+        case kShl:
+        case kShrA:
+        case kShrL:
+            if (*c == 0) { // x op 0 -> x
+                return lhs;
+            }
+            break;
+        case kSub: {
+            if (*c == 0) { // x - 0 -> x
+                return lhs;
+            }
+            // x - c -> x + (-c), so that constants of chains of additions meet
+            auto &minus_c = make_const(bin_op, *fold_binary_operator(kSub, type, 0, *c));
+            return std::addressof(make_binary_operator(bin_op, kAdd, *lhs, minus_c));
+        }
+        case kMul:
+            if (*c == 0) { // x * 0 -> 0
+                return rhs;
+            }
+            if (*c == 1) { // x * 1 -> x
+                return lhs;
+            }
+            if (std::has_single_bit(*c)) { // x * 2^k -> x << k
+                auto &k = make_const(bin_op, static_cast<std::uintmax_t>(std::countr_zero(*c)));
+                return std::addressof(make_binary_operator(bin_op, kShl, *lhs, k));
+            }
+            break;
+        case kUDiv:
+            if (*c == 1) { // x / 1 -> x
+                return lhs;
+            }
+            if (std::has_single_bit(*c)) { // x / 2^k -> x >> k
+                auto &k = make_const(bin_op, static_cast<std::uintmax_t>(std::countr_zero(*c)));
+                return std::addressof(make_binary_operator(bin_op, kShrL, *lhs, k));
+            }
+            break;
+        case kSDiv:
+            if (*c == 1) { // x / 1 -> x
+                return lhs;
+            }
+            break;
+        case kURem:
+            if (*c == 1) { // x % 1 -> 0
+                return std::addressof(make_const(bin_op, 0));
+            }
+            if (std::has_single_bit(*c)) { // x % 2^k -> x & (2^k - 1)
+                auto &mask = make_const(bin_op, *c - 1);
+                return std::addressof(make_binary_operator(bin_op, kAnd, *lhs, mask));
+            }
+            break;
+        case kSRem:
+            if (*c == 1) { // x % 1 -> 0
+                return std::addressof(make_const(bin_op, 0));
+            }
+            break;
+        case kAnd:
+            if (*c == 0) { // x & 0 -> 0
+                return rhs;
+            }
+            if (*c == all_ones(type)) { // x & 1..1 -> x
+                return lhs;
+            }
+            break;
+        case kOr:
+            if (*c == 0) { // x | 0 -> x
+                return lhs;
+            }
+            if (*c == all_ones(type)) { // x | 1..1 -> 1..1
+                return rhs;
+            }
+            break;
+        default:
+            break;
+        }
+
+        // (x op c1) op c2 -> x op (c1 op c2)
+        if (is_associative(opcode) && lhs->get_opcode() == opcode) {
+            auto &inner = static_cast<BinaryOperator &>(*lhs);
+            if (const auto inner_c = constant(inner.get_rhs())) {
+                auto &combined =
+                    make_const(bin_op, *fold_binary_operator(opcode, type, *inner_c, *c));
+                bin_op.set_lhs(*inner.get_lhs());
+                bin_op.set_rhs(combined);
+                // the inner operation and the old constant may be left without users
+                push(inner);
+                push(*rhs);
+                return std::addressof(bin_op);
+            }
+        }
+
+        // (x shift c1) shift c2 -> x shift (c1 + c2) while the sum is less than the width
+        if ((opcode == kShl || opcode == kShrL) && lhs->get_opcode() == opcode) {
+            auto &inner = static_cast<BinaryOperator &>(*lhs);
+            const auto width = bit_width(type);
+            if (const auto inner_c = constant(inner.get_rhs());
+                inner_c && *inner_c < width && *c < width && *inner_c + *c < width) {
+                auto &combined = make_const(bin_op, *inner_c + *c);
+                bin_op.set_lhs(*inner.get_lhs());
+                bin_op.set_rhs(combined);
+                push(inner);
+                push(*rhs);
+                return std::addressof(bin_op);
+            }
+        }
+
+        return nullptr;
+    }
+
+    Instruction *simplify_icmp(ICmpInstruction &icmp) {
+        if (icmp.get_lhs() != icmp.get_rhs()) {
+            return nullptr;
+        }
+        // x cmp x holds for comparisons including equality
+        return std::addressof(make_const(icmp, fold_icmp(icmp.get_kind(), 0, 0)));
+    }
+
+    // New instructions are inserted right before the instruction being simplified
+    static ConstInstruction &make_const(Instruction &before, std::uintmax_t value) {
+        auto &bb = before.get_parent();
+        return static_cast<ConstInstruction &>(*bb.emplace<ConstInstruction>(
+            BasicBlock::get_iterator(before), std::addressof(before.get_type()), value));
+    }
+
+    static BinaryOperator &make_binary_operator(Instruction &before, Instruction::Opcode opcode,
+                                                Instruction &lhs, Instruction &rhs) {
+        auto &bb = before.get_parent();
+        return static_cast<BinaryOperator &>(
+            *bb.emplace<BinaryOperator>(BasicBlock::get_iterator(before), opcode, lhs, rhs));
+    }
+
+    void replace(Instruction &instr, Instruction &value) {
+        queued_.erase(std::addressof(instr));
+        instr.get_parent().replace_instruction(BasicBlock::get_iterator(instr), value);
+    }
+
+    void erase(Instruction &instr) {
+        queued_.erase(std::addressof(instr));
+        instr.get_parent().erase(BasicBlock::get_iterator(instr));
+    }
+
+    // the back of the worklist is visited first; an instruction is queued at most once
+    std::vector<Instruction *> worklist_;
+    std::unordered_set<Instruction *> queued_;
+};
+
+} // unnamed namespace
+
+PreservedAnalyses InstCombinePass::run_impl(Function &f, AnalysisManager &am) {
+    Combiner combiner{am.dfs(f)};
+    const auto rewrites = combiner.run();
+    rewrites_count_ += rewrites;
+
+    // instructions are rewritten but no branches, so blocks and edges stay
+    return rewrites == 0 ? PreservedAnalyses::all() : PreservedAnalyses::cfg();
+}
+
+} // namespace bjac
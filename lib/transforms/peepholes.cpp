@@ -1,8 +1,7 @@
-#include <cassert>
-#include <functional>
+#include <cstdint>
 #include <iterator>
+#include <memory>
 #include <ranges>
-#include <utility>
 
 #include "bjac/graphs/dfs.hpp"
 
@@ -10,341 +9,118 @@
 #include "bjac/IR/binary_operator.hpp"
 #include "bjac/IR/constant_instruction.hpp"
 #include "bjac/IR/function.hpp"
+#include "bjac/IR/instruction.hpp"
 
+#include "bjac/transforms/analysis_manager.hpp"
+#include "bjac/transforms/folding.hpp"
+#include "bjac/transforms/pattern_match.hpp"
 #include "bjac/transforms/peepholes.hpp"
 
 namespace bjac {
 
 namespace {
 
-auto process_add(std::bidirectional_iterator auto it) -> decltype(it) {
-    using enum Instruction::Opcode;
+using namespace pattern;
 
-    auto &add_instr = static_cast<BinaryOperator &>(*it);
-    assert(add_instr.get_opcode() == kAdd);
-
-    auto &bb = it->get_parent();
-    auto next_it = std::next(it);
-
-    auto *lhs = add_instr.get_lhs();
-    auto *rhs = add_instr.get_rhs();
-
-    if (lhs->get_opcode() == kConst) {
-        if (static_cast<ConstInstruction *>(lhs)->get_value() == 0) { // 0 + x -> x
-            bb.replace_instruction(it, *rhs);
-        }
-    } else if (rhs->get_opcode() == kConst) {
-        if (static_cast<ConstInstruction *>(rhs)->get_value() == 0) { // x + 0 -> x
-            bb.replace_instruction(it, *lhs);
-        }
-    } else {
-        auto [sub, other] = [lhs, rhs] -> std::pair<BinaryOperator *, Instruction *> {
-            if (lhs->get_opcode() == kSub) {
-                return {static_cast<BinaryOperator *>(lhs), rhs};
-            } else if (rhs->get_opcode() == kSub) {
-                return {static_cast<BinaryOperator *>(rhs), lhs};
-            }
-            return {};
-        }();
-
-        if (!sub) {
-            return next_it;
-        }
-
-        if (sub->get_lhs()->get_opcode() == kConst &&
-            static_cast<ConstInstruction *>(sub->get_lhs())->get_value() == 0) {
-            auto new_it = bb.template emplace<BinaryOperator>(it, kSub, *other, *sub->get_rhs());
-            bb.replace_instruction(it, *new_it);
-            return new_it;
-        }
-    }
-
-    return next_it;
+// New instructions are inserted right before the instruction being rewritten
+Instruction *make_const(Instruction &before, std::uintmax_t value) {
+    auto &bb = before.get_parent();
+    return std::addressof(*bb.emplace<ConstInstruction>(BasicBlock::get_iterator(before),
+                                                        std::addressof(before.get_type()), value));
 }
 
-auto process_shrl(std::bidirectional_iterator auto it) -> decltype(it) {
-    using enum Instruction::Opcode;
-
-    auto &shrl_instr = static_cast<BinaryOperator &>(*it);
-    assert(shrl_instr.get_opcode() == kShrL);
-
-    auto &bb = it->get_parent();
-    auto next_it = std::next(it);
-
-    auto *lhs = shrl_instr.get_lhs();
-    auto *rhs = shrl_instr.get_rhs();
-
-    if (lhs->get_opcode() == kConst) {
-        if (static_cast<ConstInstruction *>(lhs)->get_value() == 0) { // 0 >> x -> 0
-            bb.replace_instruction(it, *lhs);
-        }
-    } else if (rhs->get_opcode() == kConst) {
-        if (static_cast<ConstInstruction *>(rhs)->get_value() == 0) { // x >> 0 -> x
-            bb.replace_instruction(it, *lhs);
-        }
-    }
-
-    return next_it;
+Instruction *make_binary_operator(Instruction &before, Instruction::Opcode opcode,
+                                  Instruction &lhs, Instruction &rhs) {
+    auto &bb = before.get_parent();
+    return std::addressof(
+        *bb.emplace<BinaryOperator>(BasicBlock::get_iterator(before), opcode, lhs, rhs));
 }
 
-/*
- * Case 1:
- * ----------------------------------------------
- * Before:
- * %0.0 = <some-instruction> <---- rhs_rhs
- * %0.1 = i64 constant 42    <---- rhs_lhs
- * %0.2 = i64 and %0.1, %0.0 <---- rhs
- * %0.3 = i64 constant 43    <---- lhs
- * %0.4 = i64 and %0.3, %0.2 <---- bit_instr
- *
- * After:
- * %0.0 = <some-instruction>
- * %0.1 = i64 constant 42
- * %0.2 = i64 and %0.1, %0.0
- * %0.3 = i64 constant 43
- * %0.5 = i64 constant (42 & 43)
- * %0.4 = i64 and %0.0, %0.5
- * ----------------------------------------------
- *
- * Case 2:
- * ----------------------------------------------
- * Before:
- * %0.0 = <some-instruction> <---- rhs_lhs
- * %0.1 = i64 constant 42    <---- rhs_rhs
- * %0.2 = i64 and %0.0, %0.1 <---- rhs
- * %0.3 = i64 constant 43    <---- lhs
- * %0.4 = i64 and %0.3, %0.2 <---- bit_instr
- *
- * After:
- * %0.0 = <some-instruction>
- * %0.1 = i64 constant 42
- * %0.2 = i64 and %0.0, %0.1
- * %0.3 = i64 constant 43
- * %0.5 = i64 constant (42 & 43)
- * %0.4 = i64 and %0.0, %0.5
- * ----------------------------------------------
- *
- * Case 3:
- * ----------------------------------------------
- * Before:
- * %0.0 = <some-instruction> <---- lhs_rhs
- * %0.1 = i64 constant 42    <---- lhs_lhs
- * %0.2 = i64 and %0.1, %0.0 <---- lhs
- * %0.3 = i64 constant 43    <---- rhs
- * %0.4 = i64 and %0.2, %0.3 <---- bit_instr
- *
- * After:
- * %0.0 = <some-instruction>
- * %0.1 = i64 constant 42
- * %0.2 = i64 and %0.1, %0.0
- * %0.3 = i64 constant 43
- * %0.5 = i64 constant (42 & 43)
- * %0.4 = i64 and %0.0, %0.5
- * ----------------------------------------------
- *
- * Case 4:
- * ----------------------------------------------
- * Before:
- * %0.0 = <some-instruction> <---- lhs_lhs
- * %0.1 = i64 constant 42    <---- lhs_rhs
- * %0.2 = i64 and %0.0, %0.1 <---- lhs
- * %0.3 = i64 constant 43    <---- rhs
- * %0.4 = i64 and %0.2, %0.3 <---- bit_instr
- *
- * After:
- * %0.0 = <some-instruction>
- * %0.1 = i64 constant 42
- * %0.2 = i64 and %0.0, %0.1
- * %0.3 = i64 constant 43
- * %0.5 = i64 constant (42 & 43)
- * %0.4 = i64 and %0.0, %0.5
- * ----------------------------------------------
- */
-void bitwise_instr_chaining(std::bidirectional_iterator auto it, auto op) {
-    using enum Instruction::Opcode;
-
-    assert(it->get_opcode() == kAnd || it->get_opcode() == kOr || it->get_opcode() == kXor);
-
-    auto *bit_instr = static_cast<BinaryOperator *>(std::addressof(*it));
-    auto *lhs = bit_instr->get_lhs();
-    auto *rhs = bit_instr->get_rhs();
-
-    auto [instr, constant] = [lhs, rhs, op] -> std::pair<Instruction *, std::uintmax_t> {
-        if (lhs->get_opcode() == kConst) {
-            if (rhs->get_opcode() == kAnd) {
-                auto *rhs_lhs = static_cast<BinaryOperator *>(rhs)->get_lhs();
-                auto *rhs_rhs = static_cast<BinaryOperator *>(rhs)->get_rhs();
-                if (rhs_lhs->get_opcode() == kConst) {
-                    return {rhs_rhs, op(static_cast<ConstInstruction *>(lhs)->get_value(),
-                                        static_cast<ConstInstruction *>(rhs_lhs)->get_value())};
-                } else if (rhs_rhs->get_opcode() == kConst) {
-                    return {rhs_lhs, op(static_cast<ConstInstruction *>(lhs)->get_value(),
-                                        static_cast<ConstInstruction *>(rhs_rhs)->get_value())};
-                }
-            }
-        } else if (rhs->get_opcode() == kConst) {
-            if (lhs->get_opcode() == kAnd) {
-                auto *lhs_lhs = static_cast<BinaryOperator *>(lhs)->get_lhs();
-                auto *lhs_rhs = static_cast<BinaryOperator *>(lhs)->get_rhs();
-                if (lhs_lhs->get_opcode() == kConst) {
-                    return {lhs_rhs, op(static_cast<ConstInstruction *>(rhs)->get_value(),
-                                        static_cast<ConstInstruction *>(lhs_lhs)->get_value())};
-                } else if (lhs_rhs->get_opcode() == kConst) {
-                    return {lhs_lhs, op(static_cast<ConstInstruction *>(rhs)->get_value(),
-                                        static_cast<ConstInstruction *>(lhs_rhs)->get_value())};
-                }
-            }
-        }
-
-        return {nullptr, 0};
-    }();
-
-    if (instr != nullptr) {
-        auto &bb = it->get_parent();
-        assert(it != bb.begin());
-        auto new_it =
-            bb.template emplace<ConstInstruction>(it, bit_instr->get_type().clone(), constant);
-        bit_instr->set_lhs(*instr);
-        bit_instr->set_rhs(*new_it);
-    }
+Instruction *bound_x(BinaryOperator &, const Bindings &b) { return b[x]; }
+Instruction *bound_c1(BinaryOperator &, const Bindings &b) { return b[c1]; }
+
+// (x op c1) op c2 -> x op (c1 op c2)
+Instruction *reassociate(BinaryOperator &bin_op, const Bindings &b) {
+    const auto value = *fold_binary_operator(bin_op.get_opcode(), bin_op.get_type(),
+                                             b.constant(c1), b.constant(c2));
+    auto *combined = make_const(bin_op, value);
+    bin_op.set_lhs(*b[x]);
+    bin_op.set_rhs(*combined);
+    return std::addressof(bin_op);
 }
 
-auto process_and(std::bidirectional_iterator auto it) -> decltype(it) {
-    using enum Instruction::Opcode;
-
-    auto &and_instr = static_cast<BinaryOperator &>(*it);
-    assert(and_instr.get_opcode() == kAnd);
-
-    auto &bb = it->get_parent();
-    auto next_it = std::next(it);
-
-    auto *lhs = and_instr.get_lhs();
-    auto *rhs = and_instr.get_rhs();
-
-    if (lhs->get_opcode() == kConst) {
-        auto *const_lhs = static_cast<ConstInstruction *>(lhs);
-        if (const auto value = const_lhs->get_value(); value == 0) { // 0 & x -> 0
-            bb.replace_instruction(it, *lhs);
-        } else if (value == const_lhs->max_value()) { // 1..1 & x -> x
-            bb.replace_instruction(it, *rhs);
-        } else {
-            bitwise_instr_chaining(it, std::bit_and{});
+// Earlier rules take precedence over later ones
+constexpr RuleSet kRules{
+    // x + 0 -> x
+    Rule{m_c_Add(m_Value(x), m_Zero()), bound_x},
+    // x + (0 - y) -> x - y
+    Rule{m_c_Add(m_Value(x), m_Sub(m_Zero(), m_Value(y))),
+         [](BinaryOperator &add, const Bindings &b) static {
+             return make_binary_operator(add, Instruction::Opcode::kSub, *b[x], *b[y]);
+         }},
+
+    // 0 >> x -> 0
+    Rule{m_ShrL(m_Zero(c1), m_Any()), bound_c1},
+    // x >> 0 -> x
+    Rule{m_ShrL(m_Value(x), m_Zero()), bound_x},
+
+    // x & 0 -> 0
+    Rule{m_c_And(m_Any(), m_Zero(c1)), bound_c1},
+    // x & 1..1 -> x
+    Rule{m_c_And(m_Value(x), m_AllOnes()), bound_x},
+    // x & x -> x
+    Rule{m_And(m_Value(x), m_Deferred(x)), bound_x},
+    Rule{m_c_And(m_c_And(m_Value(x), m_Constant(c1)), m_Constant(c2)), reassociate},
+
+    // x | 0 -> x
+    Rule{m_c_Or(m_Value(x), m_Zero()), bound_x},
+    // x | 1..1 -> 1..1
+    Rule{m_c_Or(m_Any(), m_AllOnes(c1)), bound_c1},
+    // x | x -> x
+    Rule{m_Or(m_Value(x), m_Deferred(x)), bound_x},
+    Rule{m_c_Or(m_c_Or(m_Value(x), m_Constant(c1)), m_Constant(c2)), reassociate},
+
+    // x ^ 0 -> x
+    Rule{m_c_Xor(m_Value(x), m_Zero()), bound_x},
+    // x ^ x -> 0
+    Rule{m_Xor(m_Value(x), m_Deferred(x)),
+         [](BinaryOperator &xor_instr, const Bindings &) static {
+             return make_const(xor_instr, 0);
+         }},
+    Rule{m_c_Xor(m_c_Xor(m_Value(x), m_Constant(c1)), m_Constant(c2)), reassociate},
+};
+
+// Returns whether the block has been changed
+bool process_block(BasicBlock &bb) {
+    bool changed = false;
+    for (auto it = bb.begin(), ite = bb.end(); it != ite;) {
+        auto *result = kRules.apply(*it);
+        if (result == nullptr) {
+            ++it;
+            continue;
         }
-    } else if (rhs->get_opcode() == kConst) {
-        auto *const_rhs = static_cast<ConstInstruction *>(rhs);
-        if (const auto value = const_rhs->get_value(); value == 0) { // x & 0 -> 0
-            bb.replace_instruction(it, *rhs);
-        } else if (value == const_rhs->max_value()) { // x & 1..1 -> x
-            bb.replace_instruction(it, *lhs);
-        } else {
-            bitwise_instr_chaining(it, std::bit_and{});
-        }
-    } else if (lhs == rhs) { // x & x -> x
-        bb.replace_instruction(it, *lhs);
-    }
-
-    return next_it;
-}
-
-auto process_or(std::bidirectional_iterator auto it) -> decltype(it) {
-    using enum Instruction::Opcode;
 
-    auto &or_instr = static_cast<BinaryOperator &>(*it);
-    assert(or_instr.get_opcode() == kOr);
-
-    auto &bb = it->get_parent();
-    auto next_it = std::next(it);
-
-    auto *lhs = or_instr.get_lhs();
-    auto *rhs = or_instr.get_rhs();
-
-    if (lhs->get_opcode() == kConst) {
-        auto *const_lhs = static_cast<ConstInstruction *>(lhs);
-        if (const auto value = const_lhs->get_value(); value == 0) { // 0 | x -> x
-            bb.replace_instruction(it, *rhs);
-        } else if (value == const_lhs->max_value()) { // 1..1 | x -> 1..1
-            bb.replace_instruction(it, *lhs);
-        } else {
-            bitwise_instr_chaining(it, std::bit_or{});
-        }
-    } else if (rhs->get_opcode() == kConst) {
-        auto *const_rhs = static_cast<ConstInstruction *>(rhs);
-        if (const auto value = const_rhs->get_value(); value == 0) { // x | 0 -> x
-            bb.replace_instruction(it, *lhs);
-        } else if (value == const_rhs->max_value()) { // x | 1..1 -> 1..1
-            bb.replace_instruction(it, *rhs);
-        } else {
-            bitwise_instr_chaining(it, std::bit_or{});
+        changed = true;
+        // an instruction changed in place is matched again
+        if (result != std::addressof(*it)) {
+            const auto next_it = std::next(it);
+            bb.replace_instruction(it, *result);
+            it = next_it;
         }
-    } else if (lhs == rhs) { // x | x -> x
-        bb.replace_instruction(it, *lhs);
-    }
-
-    return next_it;
-}
-
-auto process_xor(std::bidirectional_iterator auto it) -> decltype(it) {
-    using enum Instruction::Opcode;
-
-    auto &xor_instr = static_cast<BinaryOperator &>(*it);
-    assert(xor_instr.get_opcode() == kOr);
-
-    auto &bb = it->get_parent();
-    auto next_it = std::next(it);
-
-    auto *lhs = xor_instr.get_lhs();
-    auto *rhs = xor_instr.get_rhs();
-
-    if (lhs->get_opcode() == kConst) {
-        const auto value = static_cast<ConstInstruction *>(lhs)->get_value();
-        if (value == 0) { // 0 ^ x -> x
-            bb.replace_instruction(it, *rhs);
-        } else {
-            bitwise_instr_chaining(it, std::bit_or{});
-        }
-    } else if (rhs->get_opcode() == kConst) {
-        const auto value = static_cast<ConstInstruction *>(rhs)->get_value();
-        if (value == 0) { // x ^ 0 -> x
-            bb.replace_instruction(it, *lhs);
-        } else {
-            bitwise_instr_chaining(it, std::bit_or{});
-        }
-    } else if (lhs == rhs) { // x ^ x -> 0
-        auto new_it = bb.template emplace<ConstInstruction>(it, xor_instr.get_type().clone(), 0);
-        bb.replace_instruction(it, *new_it);
-        return new_it;
-    }
-
-    return next_it;
-}
-
-auto process_instruction(std::bidirectional_iterator auto it) -> decltype(it) {
-    using enum Instruction::Opcode;
-    switch (it->get_opcode()) {
-    case kAdd:
-        return process_add(it);
-    case kShrL:
-        return process_shrl(it);
-    case kAnd:
-        return process_and(it);
-    case kOr:
-        return process_or(it);
-    case kXor:
-        return process_xor(it);
-    default:
-        return std::next(it);
     }
+    return changed;
 }
 
 } // unnamed namespace
 
-void PeepholePass::run(Function &f) {
-    const DFS<MutFunctionGraphTraits> dfs{f};
-    for (auto *bb : dfs.post_order() | std::views::reverse) {
-        for (auto it = bb->begin(), ite = bb->end(); it != ite;) {
-            it = process_instruction(it);
-        }
+PreservedAnalyses PeepholePass::run_impl(Function &f, AnalysisManager &am) {
+    bool changed = false;
+    for (auto *bb : am.dfs(f).post_order() | std::views::reverse) {
+        changed |= process_block(*bb);
     }
+
+    // only arithmetic instructions are rewritten, so branches stay
+    return changed ? PreservedAnalyses::cfg() : PreservedAnalyses::all();
 }
 
 } // namespace bjac
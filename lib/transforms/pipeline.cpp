@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <format>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include "bjac/IR/basic_block.hpp"
+#include "bjac/IR/function.hpp"
+
+#include "bjac/transforms/analysis_manager.hpp"
+#include "bjac/transforms/check_elimination.hpp"
+#include "bjac/transforms/constant_folding.hpp"
+#include "bjac/transforms/dce.hpp"
+#include "bjac/transforms/inst_combine.hpp"
+#include "bjac/transforms/peepholes.hpp"
+#include "bjac/transforms/pipeline.hpp"
+#include "bjac/transforms/sccp.hpp"
+
+namespace bjac {
+
+namespace {
+
+constexpr std::array<std::string_view, 6> kPassNames{
+    "check-elimination", "constant-folding", "dce", "inst-combine", "peepholes", "sccp"};
+
+template <typename Pass>
+PassPipeline::Runner make_runner() {
+    return [pass = Pass{}](Function &f, AnalysisManager &am) mutable { return pass.run(f, am); };
+}
+
+PassPipeline::Runner make_runner(std::string_view name) {
+    if (name == "check-elimination") {
+        return make_runner<CheckEliminationPass>();
+    }
+    if (name == "constant-folding") {
+        return make_runner<ConstantFoldingPass>();
+    }
+    if (name == "dce") {
+        return make_runner<DCE>();
+    }
+    if (name == "inst-combine") {
+        return make_runner<InstCombinePass>();
+    }
+    if (name == "peepholes") {
+        return make_runner<PeepholePass>();
+    }
+    if (name == "sccp") {
+        return make_runner<SCCPPass>();
+    }
+    throw std::invalid_argument{std::format("unknown pass '{}'", name)};
+}
+
+std::string_view trim(std::string_view str) {
+    constexpr std::string_view kSpaces = " \t\n";
+    const auto first = str.find_first_not_of(kSpaces);
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    return str.substr(first, str.find_last_not_of(kSpaces) - first + 1);
+}
+
+std::size_t instructions_count(const Function &f) {
+    std::size_t count = 0;
+    for (const auto &bb : f) {
+        count += bb.size();
+    }
+    return count;
+}
+
+// Instructions get consecutive identifiers within their block, so the identifiers handed out since
+// the snapshot count the instructions created. Instructions created in blocks removed since then
+// are not seen, which is fine as they are removed too
+class CreationSnapshot final {
+  public:
+    explicit CreationSnapshot(const Function &f) {
+        next_instr_ids_.reserve(f.size());
+        for (const auto &bb : f) {
+            next_instr_ids_.emplace(std::addressof(bb), bb.get_next_instr_id());
+        }
+    }
+
+    std::size_t created_since(const Function &f) const {
+        std::size_t created = 0;
+        for (const auto &bb : f) {
+            auto it = next_instr_ids_.find(std::addressof(bb));
+            created += bb.get_next_instr_id() - (it == next_instr_ids_.end() ? 0 : it->second);
+        }
+        return created;
+    }
+
+  private:
+    std::unordered_map<const BasicBlock *, unsigned> next_instr_ids_;
+};
+
+std::string escape(std::string_view str) {
+    std::string escaped;
+    escaped.reserve(str.size());
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            escaped.push_back('\\');
+        }
+        escaped.push_back(c);
+    }
+    return escaped;
+}
+
+} // unnamed namespace
+
+PassPipeline::PassPipeline(std::string_view spec, Options options) : PassPipeline{options} {
+    for (auto part : std::views::split(spec, ',')) {
+        const auto name = trim(std::string_view{part.begin(), part.end()});
+        if (name.empty()) {
+            throw std::invalid_argument{std::format("empty pass name in '{}'", spec)};
+        }
+        add(std::string{name}, make_runner(name));
+    }
+}
+
+std::span<const std::string_view> PassPipeline::known_passes() noexcept { return kPassNames; }
+
+PassPipeline &PassPipeline::add(std::string name, Runner runner) {
+    runners_.push_back(std::move(runner));
+    stats_.push_back(PassStats{.name = std::move(name)});
+    return *this;
+}
+
+std::size_t PassPipeline::run(Function &f, AnalysisManager &am) {
+    using Clock = std::chrono::steady_clock;
+
+    std::size_t iterations = 0;
+    for (bool changed = true; changed && iterations != options_.max_iterations;) {
+        changed = false;
+        ++iterations;
+
+        for (auto [runner, stats] : std::views::zip(runners_, stats_)) {
+            const auto instructions_before = instructions_count(f);
+            const CreationSnapshot snapshot{f};
+            const auto allocations_before = f.get_arena().allocations_count();
+
+            const auto start = Clock::now();
+            const auto preserved = runner(f, am);
+            stats.time += Clock::now() - start;
+
+            const auto added = snapshot.created_since(f);
+            ++stats.runs;
+            stats.changes += preserved.is_changed();
+            stats.instructions_added += added;
+            stats.instructions_removed += instructions_before + added - instructions_count(f);
+            stats.allocations += f.get_arena().allocations_count() - allocations_before;
+
+            changed |= preserved.is_changed();
+        }
+
+        changed &= options_.fixed_point;
+    }
+
+    iterations_count_ += iterations;
+    return iterations;
+}
+
+void PassPipeline::print_stats(std::ostream &os) const {
+    os << std::format("{:<20} {:>6} {:>8} {:>10} {:>8} {:>8} {:>12}\n", "pass", "runs", "changes",
+                      "time, ms", "added", "removed", "allocations");
+
+    PassStats total{.name = "total"};
+    for (const auto &stats : stats_) {
+        os << std::format("{:<20} {:>6} {:>8} {:>10.3f} {:>8} {:>8} {:>12}\n", stats.name,
+                          stats.runs, stats.changes, stats.time.count(), stats.instructions_added,
+                          stats.instructions_removed, stats.allocations);
+        total.runs += stats.runs;
+        total.changes += stats.changes;
+        total.time += stats.time;
+        total.instructions_added += stats.instructions_added;
+        total.instructions_removed += stats.instructions_removed;
+        total.allocations += stats.allocations;
+    }
+
+    os << std::format("{:<20} {:>6} {:>8} {:>10.3f} {:>8} {:>8} {:>12}\n", total.name, total.runs,
+                      total.changes, total.time.count(), total.instructions_added,
+                      total.instructions_removed, total.allocations);
+}
+
+std::string PassPipeline::stats_to_json() const {
+    std::string json = std::format(R"({{"iterations": {}, "passes": [)", iterations_count_);
+    for (auto [i, stats] : std::views::enumerate(stats_)) {
+        if (i != 0) {
+            json += ", ";
+        }
+        std::format_to(std::back_inserter(json),
+                       R"({{"name": "{}", "runs": {}, "changes": {}, "time_ms": {:.6f}, )"
+                       R"("instructions_added": {}, "instructions_removed": {}, )"
+                       R"("allocations": {}}})",
+                       escape(stats.name), stats.runs, stats.changes, stats.time.count(),
+                       stats.instructions_added, stats.instructions_removed, stats.allocations);
+    }
+    json += "]}";
+    return json;
+}
+
+} // namespace bjac
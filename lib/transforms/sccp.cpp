@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+#include <boost/container/small_vector.hpp>
+
+#include "bjac/IR/basic_block.hpp"
+#include "bjac/IR/binary_operator.hpp"
+#include "bjac/IR/branch_instruction.hpp"
+#include "bjac/IR/constant_instruction.hpp"
+#include "bjac/IR/dense_map.hpp"
+#include "bjac/IR/function.hpp"
+#include "bjac/IR/icmp_instruction.hpp"
+#include "bjac/IR/instruction.hpp"
+#include "bjac/IR/phi_instruction.hpp"
+
+#include "bjac/transforms/analysis_manager.hpp"
+#include "bjac/transforms/folding.hpp"
+#include "bjac/transforms/sccp.hpp"
+
+namespace bjac {
+
+namespace {
+
+// Top means that no value has reached the instruction yet, bottom means that it may take more than
+// one value. The value of an instruction only goes down: top, a constant, bottom
+struct LatticeValue final {
+    enum class Kind : unsigned char { kTop, kConstant, kBottom };
+
+    static constexpr LatticeValue bottom() noexcept { return {.kind = Kind::kBottom}; }
+    static constexpr LatticeValue constant(std::uintmax_t value) noexcept {
+        return {.kind = Kind::kConstant, .value = value};
+    }
+
+    bool is_top() const noexcept { return kind == Kind::kTop; }
+    bool is_constant() const noexcept { return kind == Kind::kConstant; }
+    bool is_bottom() const noexcept { return kind == Kind::kBottom; }
+
+    bool operator==(const LatticeValue &) const = default;
+
+    Kind kind = Kind::kTop;
+    // meaningful for constants only
+    std::uintmax_t value = 0;
+};
+
+LatticeValue meet(LatticeValue lhs, LatticeValue rhs) noexcept {
+    if (lhs.is_top()) {
+        return rhs;
+    }
+    if (rhs.is_top() || lhs == rhs) {
+        return lhs;
+    }
+    return LatticeValue::bottom();
+}
+
+LatticeValue from_optional(std::optional<std::uintmax_t> value) noexcept {
+    return value ? LatticeValue::constant(*value) : LatticeValue::bottom();
+}
+
+class Solver final {
+  public:
+    // The function has to be renumbered and shall not be changed while the solver is in use
+    explicit Solver(const Function &f)
+        : values_(f.numbered_instructions_count()), blocks_(f.numbered_blocks_count()) {}
+
+    void run(BasicBlock &entry) {
+        mark_executable(entry);
+        while (!cfg_worklist_.empty() || !ssa_worklist_.empty()) {
+            // reachability changes more rarely than values, and new blocks bring new values
+            while (!cfg_worklist_.empty()) {
+                const auto [from, to] = cfg_worklist_.back();
+                cfg_worklist_.pop_back();
+                visit_edge(*from, *to);
+            }
+            while (!ssa_worklist_.empty()) {
+                auto *instr = ssa_worklist_.back();
+                ssa_worklist_.pop_back();
+                for (auto *user : instr->get_users()) {
+                    if (is_executable(user->get_parent())) {
+                        visit(*user);
+                    }
+                }
+            }
+        }
+    }
+
+    bool is_executable(const BasicBlock &bb) const {
+        return blocks_.contains(bb) && blocks_.at(bb).executable;
+    }
+
+    LatticeValue value(const Instruction &instr) {
+        if (instr.get_opcode() == Instruction::Opcode::kConst) {
+            return LatticeValue::constant(static_cast<const ConstInstruction &>(instr).get_value());
+        }
+        return values_[instr];
+    }
+
+  private:
+    struct BlockState {
+        bool executable = false;
+        boost::container::small_vector<const BasicBlock *, 4> executable_predecessors;
+    };
+
+    void mark_executable(BasicBlock &bb) {
+        blocks_[bb].executable = true;
+        for (auto &instr : bb) {
+            visit(instr);
+        }
+    }
+
+    void visit_edge(const BasicBlock &from, BasicBlock &to) {
+        auto &state = blocks_[to];
+        if (std::ranges::contains(state.executable_predecessors, std::addressof(from))) {
+            return;
+        }
+        state.executable_predecessors.push_back(std::addressof(from));
+
+        if (!state.executable) {
+            mark_executable(to);
+            return;
+        }
+        // the new edge brings new inputs to PHI instructions only
+        for (auto &phi : to.phi_instructions()) {
+            visit(phi);
+        }
+    }
+
+    void visit(Instruction &instr) {
+        using enum Instruction::Opcode;
+
+        if (instr.get_opcode() == kBr) {
+            visit_branch(static_cast<BranchInstruction &>(instr));
+        } else if (instr.is_phi()) {
+            update(instr, evaluate_phi(static_cast<PHIInstruction &>(instr)));
+        } else if (instr.is_binary_op()) {
+            const auto &bin_op = static_cast<const BinaryOperator &>(instr);
+            const auto lhs = value(*bin_op.get_lhs());
+            const auto rhs = value(*bin_op.get_rhs());
+            if (lhs.is_constant() && rhs.is_constant()) {
+                update(instr, from_optional(fold_binary_operator(
+                                  bin_op.get_opcode(), bin_op.get_type(), lhs.value, rhs.value)));
+            } else if (lhs.is_bottom() || rhs.is_bottom()) {
+                update(instr, LatticeValue::bottom());
+            }
+        } else if (instr.get_opcode() == kICmp) {
+            const auto &icmp = static_cast<const ICmpInstruction &>(instr);
+            const auto lhs = value(*icmp.get_lhs());
+            const auto rhs = value(*icmp.get_rhs());
+            if (lhs.is_constant() && rhs.is_constant()) {
+                update(instr,
+                       LatticeValue::constant(fold_icmp(icmp.get_kind(), lhs.value, rhs.value)));
+            } else if (lhs.is_bottom() || rhs.is_bottom()) {
+                update(instr, LatticeValue::bottom());
+            }
+        } else if (instr.get_opcode() != kConst && instr.get_type_id() != Type::ID::kVoid) {
+            // arguments, loads, calls and casts aren't evaluated
+            update(instr, LatticeValue::bottom());
+        }
+    }
+
+    void visit_branch(BranchInstruction &br) {
+        auto &bb = br.get_parent();
+        if (!br.is_conditional()) {
+            cfg_worklist_.emplace_back(std::addressof(bb), br.get_true_path());
+            return;
+        }
+
+        const auto condition = value(*br.get_condition());
+        if (condition.is_constant()) {
+            cfg_worklist_.emplace_back(std::addressof(bb), condition.value != 0
+                                                               ? br.get_true_path()
+                                                               : br.get_false_path());
+        } else if (condition.is_bottom()) {
+            cfg_worklist_.emplace_back(std::addressof(bb), br.get_true_path());
+            cfg_worklist_.emplace_back(std::addressof(bb), br.get_false_path());
+        }
+    }
+
+    // Inputs coming along edges not known to be executable are ignored
+    LatticeValue evaluate_phi(PHIInstruction &phi) {
+        const auto &executable_predecessors = blocks_[phi.get_parent()].executable_predecessors;
+
+        LatticeValue result;
+        for (const auto &[pred, input] : phi.get_paths()) {
+            if (std::ranges::contains(executable_predecessors, pred)) {
+                result = meet(result, value(*input));
+                if (result.is_bottom()) {
+                    break;
+                }
+            }
+        }
+        return result;
+    }
+
+    void update(Instruction &instr, LatticeValue new_value) {
+        auto &old_value = values_[instr];
+        if (old_value != new_value) {
+            old_value = new_value;
+            ssa_worklist_.push_back(std::addressof(instr));
+        }
+    }
+
+    DenseMap<Instruction, LatticeValue> values_;
+    DenseMap<BasicBlock, BlockState> blocks_;
+
+    std::vector<std::pair<const BasicBlock *, BasicBlock *>> cfg_worklist_;
+    // instructions whose values have changed, so their users are to be visited
+    std::vector<Instruction *> ssa_worklist_;
+};
+
+// Replaces the conditional branch terminating bb with a jump to target keeping the values PHI
+// instructions of target take from bb
+void make_jump(BasicBlock &bb, BasicBlock &target) {
+    std::vector<std::pair<PHIInstruction *, Instruction *>> inputs;
+    for (auto &instr : target.phi_instructions()) {
+        auto &phi = static_cast<PHIInstruction &>(instr);
+        inputs.emplace_back(std::addressof(phi), phi.get_value(bb));
+    }
+
+    bb.pop_back();
+    bb.emplace_back<BranchInstruction>(target);
+
+    for (auto [phi, input] : inputs) {
+        if (input != nullptr) {
+            phi->add_path(bb, *input);
+        }
+    }
+}
+
+} // unnamed namespace
+
+PreservedAnalyses SCCPPass::run_impl(Function &f, [[maybe_unused]] AnalysisManager &am) {
+    f.renumber();
+    Solver solver{f};
+    solver.run(f.front());
+
+    // the solver reads the numbering, so the function is changed only once all results are taken
+    std::vector<std::pair<Instruction *, std::uintmax_t>> constants;
+    std::vector<std::pair<BasicBlock *, BasicBlock *>> jumps;
+    for (auto &bb : f) {
+        if (!solver.is_executable(bb)) {
+            continue;
+        }
+
+        for (auto &instr : bb) {
+            if (instr.get_opcode() == Instruction::Opcode::kConst ||
+                instr.get_type_id() == Type::ID::kVoid) {
+                continue;
+            }
+            if (const auto value = solver.value(instr); value.is_constant()) {
+                constants.emplace_back(std::addressof(instr), value.value);
+            }
+        }
+
+        auto *term = bb.get_terminator();
+        if (term == nullptr || term->get_opcode() != Instruction::Opcode::kBr) {
+            continue;
+        }
+        auto &br = static_cast<BranchInstruction &>(*term);
+        if (!br.is_conditional()) {
+            continue;
+        }
+        if (const auto condition = solver.value(*br.get_condition()); condition.is_constant()) {
+            jumps.emplace_back(std::addressof(bb),
+                               condition.value != 0 ? br.get_true_path() : br.get_false_path());
+        }
+    }
+
+    for (auto [instr, value] : constants) {
+        auto &bb = instr->get_parent();
+        // constants can't be placed among PHI instructions
+        const auto pos = instr->is_phi() ? bb.non_phi_instructions().begin()
+                                         : BasicBlock::get_iterator(*instr);
+        auto new_it = bb.emplace<ConstInstruction>(pos, std::addressof(instr->get_type()), value);
+        bb.replace_instruction(BasicBlock::get_iterator(*instr), *new_it);
+    }
+
+    for (auto [bb, target] : jumps) {
+        make_jump(*bb, *target);
+    }
+
+    folded_instructions_count_ += constants.size();
+    folded_branches_count_ += jumps.size();
+
+    if (!jumps.empty()) {
+        return PreservedAnalyses::none();
+    }
+    // values are replaced but no branches, so blocks and edges stay
+    return constants.empty() ? PreservedAnalyses::all() : PreservedAnalyses::cfg();
+}
+
+} // namespace bjac
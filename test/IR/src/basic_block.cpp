@@ -0,0 +1,102 @@
+#include <cstddef>
+#include <ranges>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "bjac/IR/basic_block.hpp"
+#include "bjac/IR/branch_instruction.hpp"
+#include "bjac/IR/constant_instruction.hpp"
+#include "bjac/IR/function.hpp"
+#include "bjac/IR/ret_instruction.hpp"
+
+#include "test/common.hpp"
+
+using enum bjac::Type::ID;
+
+TEST(BasicBlock, EdgesFollowBranches) {
+    // Assign
+    bjac::Function foo = get_func("foo", kVoid);
+    auto &bb_1 = foo.emplace_back();
+    auto &bb_2 = foo.emplace_back();
+    auto &bb_3 = foo.emplace_back();
+    auto &cond = bb_1.emplace_back<bjac::ConstInstruction>(get_i1(), 1);
+
+    // Act
+    bb_1.emplace_back<bjac::BranchInstruction>(cond, bb_2, bb_3);
+    bb_2.emplace_back<bjac::BranchInstruction>(bb_3);
+    bb_3.emplace_back<bjac::ReturnInstruction>();
+
+    // Assert
+    EXPECT_EQ(std::vector<bjac::BasicBlock *>(std::from_range, bb_1.successors()),
+              (std::vector<bjac::BasicBlock *>{&bb_2, &bb_3}));
+    EXPECT_EQ(std::vector<bjac::BasicBlock *>(std::from_range, bb_3.predecessors()),
+              (std::vector<bjac::BasicBlock *>{&bb_1, &bb_2}));
+    EXPECT_TRUE(bb_1.predecessors().empty());
+    EXPECT_TRUE(bb_3.successors().empty());
+}
+
+TEST(BasicBlock, ErasedBranchRemovesEdges) {
+    // Assign
+    bjac::Function foo = get_func("foo", kVoid);
+    auto &bb_1 = foo.emplace_back();
+    auto &bb_2 = foo.emplace_back();
+    auto &bb_3 = foo.emplace_back();
+    auto &cond = bb_1.emplace_back<bjac::ConstInstruction>(get_i1(), 1);
+    bb_1.emplace_back<bjac::BranchInstruction>(cond, bb_2, bb_3);
+    bb_2.emplace_back<bjac::BranchInstruction>(bb_3);
+    bb_3.emplace_back<bjac::ReturnInstruction>();
+
+    // Act
+    bb_1.pop_back();
+    bb_1.emplace_back<bjac::BranchInstruction>(bb_3);
+
+    // Assert
+    EXPECT_EQ(std::vector<bjac::BasicBlock *>(std::from_range, bb_1.successors()),
+              (std::vector<bjac::BasicBlock *>{&bb_3}));
+    EXPECT_TRUE(bb_2.predecessors().empty());
+    EXPECT_EQ(std::vector<bjac::BasicBlock *>(std::from_range, bb_3.predecessors()),
+              (std::vector<bjac::BasicBlock *>{&bb_2, &bb_1}));
+}
+
+TEST(BasicBlock, SetPathRedirectsEdge) {
+    // Assign
+    bjac::Function foo = get_func("foo", kVoid);
+    auto &bb_1 = foo.emplace_back();
+    auto &bb_2 = foo.emplace_back();
+    auto &bb_3 = foo.emplace_back();
+    auto &br = bb_1.emplace_back<bjac::BranchInstruction>(bb_2);
+    bb_2.emplace_back<bjac::ReturnInstruction>();
+    bb_3.emplace_back<bjac::ReturnInstruction>();
+
+    // Act
+    br.set_true_path(bb_3);
+
+    // Assert
+    EXPECT_EQ(std::vector<bjac::BasicBlock *>(std::from_range, bb_1.successors()),
+              (std::vector<bjac::BasicBlock *>{&bb_3}));
+    EXPECT_TRUE(bb_2.predecessors().empty());
+    EXPECT_EQ(bb_3.predecessor_index(bb_1), 0);
+}
+
+TEST(BasicBlock, LongEdgeListsAreAllocatedFromArena) {
+    // Assign
+    bjac::Function foo = get_func("foo", kVoid);
+    auto &target = foo.emplace_back();
+    std::vector<bjac::BasicBlock *> preds;
+    for (std::size_t i = 0; i != 5; ++i) {
+        preds.push_back(&foo.emplace_back());
+    }
+    for (std::size_t i = 0; i != 4; ++i) {
+        preds[i]->emplace_back<bjac::BranchInstruction>(target);
+    }
+    const auto allocations_count = foo.get_arena().allocations_count();
+
+    // Act
+    preds[4]->emplace_back<bjac::BranchInstruction>(target);
+
+    // Assert
+    EXPECT_EQ(std::ranges::size(target.predecessors()), 5);
+    // the branch and the grown list of predecessors
+    EXPECT_EQ(foo.get_arena().allocations_count(), allocations_count + 2);
+}
@@ -0,0 +1,96 @@
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "bjac/IR/basic_block.hpp"
+#include "bjac/IR/binary_operator.hpp"
+#include "bjac/IR/constant_instruction.hpp"
+#include "bjac/IR/dense_map.hpp"
+#include "bjac/IR/function.hpp"
+#include "bjac/IR/instruction.hpp"
+#include "bjac/IR/ret_instruction.hpp"
+
+#include "test/common.hpp"
+
+using enum bjac::Type::ID;
+
+TEST(DenseMap, RenumberFollowsLayout) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64);
+    auto &bb_1 = foo.emplace_back();
+    auto &bb_2 = foo.emplace_back();
+    auto &c_1 = bb_1.emplace_back<bjac::ConstInstruction>(get_i64(), 1);
+    auto &c_2 = bb_1.emplace_back<bjac::ConstInstruction>(get_i64(), 2);
+    auto &add = bb_2.emplace_back<bjac::BinaryOperator>(bjac::Instruction::Opcode::kAdd, c_1, c_2);
+    auto &ret = bb_2.emplace_back<bjac::ReturnInstruction>(add);
+
+    // Act
+    foo.renumber();
+
+    // Assert
+    EXPECT_EQ(foo.numbered_blocks_count(), 2);
+    EXPECT_EQ(foo.numbered_instructions_count(), 4);
+    EXPECT_EQ(bb_1.get_number(), 0);
+    EXPECT_EQ(bb_2.get_number(), 1);
+    EXPECT_EQ(c_1.get_number(), 0);
+    EXPECT_EQ(c_2.get_number(), 1);
+    EXPECT_EQ(add.get_number(), 2);
+    EXPECT_EQ(ret.get_number(), 3);
+}
+
+TEST(DenseMap, InsertLookUpAndErase) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64);
+    auto &bb = foo.emplace_back();
+    auto &c_1 = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 1);
+    auto &c_2 = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 2);
+    auto &ret = bb.emplace_back<bjac::ReturnInstruction>(c_2);
+    foo.renumber();
+    bjac::DenseMap<bjac::Instruction, int> map(foo.numbered_instructions_count());
+
+    // Act
+    map[c_1] = 10;
+    EXPECT_TRUE(map.try_emplace(ret, 30));
+    EXPECT_FALSE(map.try_emplace(ret, 40));
+
+    // Assert
+    EXPECT_EQ(map.size(), 2);
+    EXPECT_TRUE(map.contains(c_1));
+    EXPECT_FALSE(map.contains(c_2));
+    EXPECT_EQ(map.at(c_1), 10);
+    EXPECT_EQ(map.at(ret), 30);
+    EXPECT_THROW(map.at(c_2), std::out_of_range);
+
+    std::vector<const bjac::Instruction *> keys;
+    for (const auto &[instr, value] : map) {
+        keys.push_back(instr);
+    }
+    EXPECT_EQ(keys, (std::vector<const bjac::Instruction *>{&c_1, &ret}));
+
+    // Act
+    map.erase(c_1);
+
+    // Assert
+    EXPECT_EQ(map.size(), 1);
+    EXPECT_FALSE(map.contains(c_1));
+}
+
+TEST(DenseMap, GrowsBeyondPreallocatedBound) {
+    // Assign
+    bjac::Function foo = get_func("foo", kVoid);
+    auto &bb_1 = foo.emplace_back();
+    auto &bb_2 = foo.emplace_back();
+    bb_1.emplace_back<bjac::ReturnInstruction>();
+    bb_2.emplace_back<bjac::ReturnInstruction>();
+    foo.renumber();
+    bjac::DenseMap<bjac::BasicBlock, bool> map;
+
+    // Act
+    map[bb_2] = true;
+
+    // Assert
+    EXPECT_EQ(map.size(), 1);
+    EXPECT_FALSE(map.contains(bb_1));
+    EXPECT_TRUE(map.at(bb_2));
+}
@@ -0,0 +1,64 @@
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include "bjac/IR/type.hpp"
+
+using enum bjac::Type::ID;
+
+TEST(Type, IntegralTypesAreInterned) {
+    // Assign
+    const auto *i1 = bjac::IntegralType::get(kI1);
+    const auto *i64 = bjac::IntegralType::get(kI64);
+
+    // Act
+    const auto *another_i64 = bjac::IntegralType::get(kI64);
+
+    // Assert
+    EXPECT_EQ(i64, another_i64);
+    EXPECT_NE(i1, i64);
+    EXPECT_TRUE(i64->is_equal(*another_i64));
+    EXPECT_FALSE(i1->is_equal(*i64));
+    EXPECT_EQ(i1->id(), kI1);
+    EXPECT_EQ(i64->id(), kI64);
+}
+
+TEST(Type, PointerTypesAreInterned) {
+    // Assign
+    const auto *ptr_i8 = bjac::PointerType::get(kI8);
+
+    // Act
+    const auto *another_ptr_i8 = bjac::PointerType::get(kI8);
+    const auto *ptr_i32 = bjac::PointerType::get(kI32);
+
+    // Assert
+    EXPECT_EQ(ptr_i8, another_ptr_i8);
+    EXPECT_NE(ptr_i8, ptr_i32);
+    EXPECT_EQ(ptr_i8->referenced_kind(), kI8);
+    EXPECT_EQ(ptr_i32->referenced_kind(), kI32);
+}
+
+TEST(Type, ArrayTypesAreInterned) {
+    // Assign
+    const auto *array = bjac::ArrayType::get(kI64, 42);
+
+    // Act
+    const auto *same_array = bjac::ArrayType::get(kI64, 42);
+    const auto *other_size = bjac::ArrayType::get(kI64, 43);
+    const auto *other_kind = bjac::ArrayType::get(kI32, 42);
+
+    // Assert
+    EXPECT_EQ(array, same_array);
+    EXPECT_NE(array, other_size);
+    EXPECT_NE(array, other_kind);
+    EXPECT_EQ(array->size(), 42);
+    EXPECT_EQ(array->to_string(), "[42 x i64]");
+}
+
+TEST(Type, NonIntegralKinds) {
+    // Act & Assert
+    EXPECT_EQ(bjac::VoidType::get(), bjac::VoidType::get());
+    EXPECT_EQ(bjac::NoneType::get(), bjac::NoneType::get());
+    EXPECT_THROW(bjac::IntegralType::get(kVoid), std::invalid_argument);
+    EXPECT_THROW(bjac::PointerType::get(kArray), std::invalid_argument);
+}
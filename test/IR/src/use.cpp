@@ -0,0 +1,142 @@
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "bjac/IR/argument_instruction.hpp"
+#include "bjac/IR/binary_operator.hpp"
+#include "bjac/IR/branch_instruction.hpp"
+#include "bjac/IR/constant_instruction.hpp"
+#include "bjac/IR/function.hpp"
+#include "bjac/IR/phi_instruction.hpp"
+#include "bjac/IR/ret_instruction.hpp"
+
+#include "test/common.hpp"
+
+using enum bjac::Type::ID;
+using enum bjac::Instruction::Opcode;
+
+TEST(Use, UserIsCountedForEveryOperand) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto &bb = foo.emplace_back();
+    auto &arg = bb.emplace_back<bjac::ArgumentInstruction>(0);
+
+    // Act
+    auto &sum = bb.emplace_back<bjac::BinaryOperator>(kAdd, arg, arg);
+    auto &ret = bb.emplace_back<bjac::ReturnInstruction>(sum);
+
+    // Assert
+    EXPECT_EQ(arg.users_count(), 2);
+    EXPECT_EQ(std::vector<bjac::Instruction *>(std::from_range, arg.get_users()),
+              (std::vector<bjac::Instruction *>{&sum, &sum}));
+    EXPECT_EQ(sum.users_count(), 1);
+    EXPECT_TRUE(sum.has_user(&ret));
+    EXPECT_EQ(ret.users_count(), 0);
+}
+
+TEST(Use, ReplaceAllUses) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto &bb = foo.emplace_back();
+    auto &arg = bb.emplace_back<bjac::ArgumentInstruction>(0);
+    auto &zero = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 0);
+    auto &sum = bb.emplace_back<bjac::BinaryOperator>(kAdd, arg, zero);
+    auto &mul = bb.emplace_back<bjac::BinaryOperator>(kMul, sum, sum);
+    auto &ret = bb.emplace_back<bjac::ReturnInstruction>(mul);
+
+    // Act
+    bb.replace_instruction(bjac::BasicBlock::get_iterator(sum), arg);
+
+    // Assert
+    EXPECT_EQ(mul.get_lhs(), &arg);
+    EXPECT_EQ(mul.get_rhs(), &arg);
+    EXPECT_EQ(arg.users_count(), 2);
+    EXPECT_TRUE(arg.has_user(&mul));
+    EXPECT_EQ(zero.users_count(), 0);
+    EXPECT_TRUE(mul.has_user(&ret));
+}
+
+TEST(Use, ErasedUserIsUnlinked) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto &bb = foo.emplace_back();
+    auto &arg = bb.emplace_back<bjac::ArgumentInstruction>(0);
+    auto &one = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 1);
+    auto &sum = bb.emplace_back<bjac::BinaryOperator>(kAdd, arg, one);
+    bb.emplace_back<bjac::ReturnInstruction>(arg);
+
+    // Act
+    bb.erase(bjac::BasicBlock::get_iterator(sum));
+
+    // Assert
+    EXPECT_EQ(arg.users_count(), 1);
+    EXPECT_EQ(one.users_count(), 0);
+}
+
+TEST(Use, OperandsOfFixedArity) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto &bb = foo.emplace_back();
+    auto &arg = bb.emplace_back<bjac::ArgumentInstruction>(0);
+    auto &one = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 1);
+
+    // Act
+    auto &sum = bb.emplace_back<bjac::BinaryOperator>(kAdd, arg, one);
+    auto &ret = bb.emplace_back<bjac::ReturnInstruction>(sum);
+
+    // Assert
+    EXPECT_TRUE(one.operands().empty());
+    EXPECT_EQ(std::vector<bjac::Instruction *>(std::from_range, sum.inputs()),
+              (std::vector<bjac::Instruction *>{&arg, &one}));
+    EXPECT_EQ(std::vector<bjac::Instruction *>(std::from_range, ret.inputs()),
+              (std::vector<bjac::Instruction *>{&sum}));
+}
+
+TEST(Use, OperandsOfPHIFollowPredecessors) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {});
+    auto &bb_1 = foo.emplace_back();
+    auto &bb_2 = foo.emplace_back();
+    auto &bb_3 = foo.emplace_back();
+    auto &bb_4 = foo.emplace_back();
+    auto &one = bb_1.emplace_back<bjac::ConstInstruction>(get_i64(), 1);
+    bb_1.emplace_back<bjac::BranchInstruction>(bb_4);
+    auto &two = bb_2.emplace_back<bjac::ConstInstruction>(get_i64(), 2);
+    bb_2.emplace_back<bjac::BranchInstruction>(bb_4);
+    auto &phi = bb_4.emplace_back<bjac::PHIInstruction>(get_i64());
+    auto &three = bb_3.emplace_back<bjac::ConstInstruction>(get_i64(), 3);
+    bb_3.emplace_back<bjac::BranchInstruction>(bb_4);
+    phi.add_path(bb_1, one);
+    phi.add_path(bb_2, two);
+    phi.add_path(bb_3, three);
+
+    // Act
+    bb_4.remove_predecessor(bb_1);
+
+    // Assert
+    ASSERT_EQ(phi.operands().size(), 2);
+    for (std::size_t i = 0; auto *pred : bb_4.predecessors()) {
+        EXPECT_EQ(phi.get_value(i++), phi.get_value(*pred));
+    }
+    EXPECT_EQ(phi.get_value(bb_1), nullptr);
+    EXPECT_EQ(phi.get_value(bb_2), &two);
+    EXPECT_EQ(phi.get_value(bb_3), &three);
+    EXPECT_EQ(one.users_count(), 0);
+    EXPECT_EQ(two.users_count(), 1);
+    EXPECT_EQ(three.users_count(), 1);
+}
+
+TEST(Use, PathFromNonPredecessor) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {});
+    auto &bb_1 = foo.emplace_back();
+    auto &bb_2 = foo.emplace_back();
+    auto &one = bb_1.emplace_back<bjac::ConstInstruction>(get_i64(), 1);
+    auto &phi = bb_2.emplace_back<bjac::PHIInstruction>(get_i64());
+
+    // Act & Assert
+    EXPECT_THROW(phi.add_path(bb_1, one), std::invalid_argument);
+}
@@ -1,4 +1,5 @@
 #include <format>
+#include <optional>
 
 #include <gtest/gtest.h>
 
@@ -71,3 +72,68 @@ TEST(Lifetime, ThreeOverlappingSegments) {
     EXPECT_TRUE(lt.contains(Segment{1, 10}));
     EXPECT_EQ("[1; 10]", std::format("{}", lt));
 }
+
+TEST(Lifetime, SegmentsAddedInDescendingOrder) {
+    // Assign
+    bjac::Lifetime lt;
+
+    // Act
+    lt.add(Segment{20, 25});
+    lt.add(Segment{10, 12});
+    lt.add(Segment{1, 5});
+    lt.add(Segment{13, 15});
+
+    // Assert
+    EXPECT_EQ(lt.size(), 3);
+    EXPECT_EQ(lt.start_point(), 1);
+    EXPECT_EQ(lt.end_point(), 25);
+    EXPECT_EQ("[1; 5] U [10; 15] U [20; 25]", std::format("{}", lt));
+}
+
+TEST(Lifetime, SegmentBridgingHoles) {
+    // Assign
+    bjac::Lifetime lt{Segment{1, 2}, Segment{5, 6}, Segment{9, 10}, Segment{20, 21}};
+
+    // Act
+    lt.add(Segment{3, 9});
+
+    // Assert
+    EXPECT_EQ("[1; 10] U [20; 21]", std::format("{}", lt));
+}
+
+TEST(Lifetime, IntersectsPoint) {
+    // Assign
+    bjac::Lifetime lt{Segment{1, 5}, Segment{10, 15}};
+
+    // Act & Assert
+    EXPECT_TRUE(lt.intersects(1));
+    EXPECT_TRUE(lt.intersects(12));
+    EXPECT_FALSE(lt.intersects(6));
+    EXPECT_FALSE(lt.intersects(16));
+    EXPECT_TRUE(lt.intersects(Segment{6, 10}));
+    EXPECT_FALSE(lt.intersects(Segment{6, 9}));
+}
+
+TEST(Lifetime, LifetimeFitsIntoHole) {
+    // Assign
+    bjac::Lifetime lhs{Segment{1, 5}, Segment{20, 25}};
+    bjac::Lifetime rhs{Segment{7, 18}};
+
+    // Act & Assert
+    EXPECT_FALSE(lhs.intersects(rhs));
+    EXPECT_FALSE(rhs.intersects(lhs));
+    EXPECT_EQ(lhs.next_intersection(rhs), std::nullopt);
+}
+
+TEST(Lifetime, NextIntersection) {
+    // Assign
+    bjac::Lifetime lhs{Segment{1, 5}, Segment{10, 15}, Segment{30, 40}};
+    bjac::Lifetime rhs{Segment{7, 11}, Segment{35, 50}};
+
+    // Act & Assert
+    EXPECT_TRUE(lhs.intersects(rhs));
+    EXPECT_EQ(lhs.next_intersection(rhs), 10);
+    EXPECT_EQ(rhs.next_intersection(lhs), 10);
+    EXPECT_EQ(lhs.next_intersection(rhs, 12), 35);
+    EXPECT_EQ(lhs.next_intersection(rhs, 41), std::nullopt);
+}
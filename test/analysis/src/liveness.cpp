@@ -64,6 +64,11 @@ TEST(Liveness, Loop1) {
     EXPECT_EQ(lifetimes.at(phi), bjac::Lifetime({Segment(4, 7), Segment(9, 9)}));
     EXPECT_EQ(lifetimes.at(cond), bjac::Lifetime{Segment(5, 6)});
     EXPECT_EQ(lifetimes.at(add), bjac::Lifetime{Segment(7, 8)});
+
+    EXPECT_EQ(lifetimes.loop_depth(*bb.at('A')), 0);
+    EXPECT_EQ(lifetimes.loop_depth(*bb.at('B')), 1);
+    EXPECT_EQ(lifetimes.loop_depth(*bb.at('C')), 1);
+    EXPECT_EQ(lifetimes.loop_depth(*bb.at('D')), 0);
 }
 
 /*
@@ -1,7 +1,13 @@
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
 #include <stdexcept>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include "bjac/analysis/graph_coloring.hpp"
+#include "bjac/analysis/liveness.hpp"
 #include "bjac/analysis/reg_alloc.hpp"
 
 #include "bjac/IR/argument_instruction.hpp"
@@ -19,6 +25,84 @@ using enum bjac::Type::ID;
 using Storage = bjac::RegAlloc::Storage;
 using enum Storage::Kind;
 
+namespace {
+
+bool all_unique(std::vector<std::size_t> regs) {
+    std::ranges::sort(regs);
+    return std::ranges::adjacent_find(regs) == regs.end();
+}
+
+// Checks that values occupying registers or stack slots at the same time are in different ones,
+// that instructions read their operands from registers, and that results are never written to the
+// stack
+void expect_valid_allocation(const bjac::Function &foo, const auto &allocator) {
+    const bjac::LivenessAnalysis liveness{foo};
+
+    std::size_t last_position = 0;
+    for (const auto &lifetime : liveness.lifetimes()) {
+        last_position = std::max(last_position, lifetime.end_point());
+    }
+
+    for (std::size_t position = 0; position <= last_position; ++position) {
+        std::vector<std::size_t> read_regs;
+        std::vector<std::size_t> written_regs;
+        std::vector<std::size_t> slots;
+        for (const auto &[instr, lifetime] : liveness) {
+            if (!lifetime.intersects(position)) {
+                continue;
+            }
+
+            if (lifetime.start_point() == position) {
+                if (const auto &storage = allocator.at(*instr); storage.kind == kRegister) {
+                    written_regs.push_back(storage.index);
+                }
+                continue;
+            }
+
+            if (const auto &storage = allocator.at(*instr, position); storage.kind == kRegister) {
+                read_regs.push_back(storage.index);
+            } else if (storage.kind == kStackSlot) {
+                slots.push_back(storage.index);
+            }
+            if (!lifetime.intersects(position + 1)) {
+                continue;
+            }
+            // moves between instructions happen after results are written, so the register of a
+            // value is still taken unless the value is left in memory it's already in
+            const auto &current = allocator.at(*instr, position);
+            const bool is_moved_out = std::ranges::any_of(allocator.moves(), [&](const auto &move) {
+                return move.value == instr && move.successor == nullptr &&
+                       move.position == position + 1 && move.from == current;
+            });
+            if (current.kind == kRegister &&
+                (allocator.at(*instr, position + 1).kind == kRegister || is_moved_out)) {
+                written_regs.push_back(current.index);
+            }
+        }
+
+        EXPECT_TRUE(all_unique(read_regs)) << "position " << position;
+        EXPECT_TRUE(all_unique(written_regs)) << "position " << position;
+        EXPECT_TRUE(all_unique(slots)) << "position " << position;
+    }
+
+    for (const auto &bb : foo) {
+        for (const auto &instr : bb.non_phi_instructions()) {
+            if (!liveness.has_position(instr)) {
+                continue;
+            }
+            // constants may be defined at their uses only
+            if (instr.get_type_id() != kVoid) {
+                EXPECT_NE(allocator.at(instr).kind, kStackSlot);
+            }
+            for (const auto *input : instr.inputs()) {
+                EXPECT_EQ(allocator.at(*input, liveness.position(instr)).kind, kRegister);
+            }
+        }
+    }
+}
+
+} // unnamed namespace
+
 TEST(RegAlloc, ThrowOneRequestForZeroRegisters) {
     // Assign
     const bjac::Function foo = get_func("foo", kVoid);
@@ -27,18 +111,305 @@ TEST(RegAlloc, ThrowOneRequestForZeroRegisters) {
     EXPECT_THROW(bjac::RegAlloc(foo, 0), std::invalid_argument);
 }
 
+TEST(RegAlloc, ThrowOneRequestForOneRegister) {
+    // Assign
+    const bjac::Function foo = get_func("foo", kVoid);
+
+    // Act & Assert
+    EXPECT_THROW(bjac::RegAlloc(foo, 1), std::invalid_argument);
+}
+
+/*
+ * i64 foo()
+ * %bb0:
+ *     %0.0 = i64 constant 1
+ *     %0.1 = i64 constant 2
+ *     %0.2 = i64 constant 3
+ *     %0.3 = i64 add %0.0, %0.1
+ *     %0.4 = i64 add %0.3, %0.2
+ *     %0.5 = i64 add %0.4, %0.0
+ *     %0.6 ret i64 %0.5
+ */
+TEST(RegAlloc, EnoughRegisters) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64);
+    auto &bb = foo.emplace_back();
+    auto &a = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 1);
+    auto &b = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 2);
+    auto &c = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 3);
+    auto &d = bb.emplace_back<bjac::BinaryOperator>(kAdd, a, b);
+    auto &e = bb.emplace_back<bjac::BinaryOperator>(kAdd, d, c);
+    auto &f = bb.emplace_back<bjac::BinaryOperator>(kAdd, e, a);
+    bb.emplace_back<bjac::ReturnInstruction>(f);
+
+    // Act
+    const bjac::RegAlloc allocator{foo, 4};
+
+    // Assert
+    expect_valid_allocation(foo, allocator);
+    EXPECT_EQ(allocator.stack_slots_count(), 0);
+    EXPECT_TRUE(allocator.moves().empty());
+    for (const auto *instr : {&a, &b, &c, &d, &e, &f}) {
+        EXPECT_EQ(allocator.parts(*instr).size(), 1);
+    }
+}
+
+/*
+ * i64 foo(i64)
+ * %bb0:
+ *     %0.0 = i64 arg [0]
+ *     %0.1 = i64 add %0.0, %0.0
+ *     %0.2 = i64 mul %0.0, %0.0
+ *     %0.3 = i64 sub %0.0, %0.0
+ *     %0.4 = i64 add %0.1, %0.2
+ *     %0.5 = i64 add %0.4, %0.3
+ *     %0.6 = i64 add %0.5, %0.1
+ *     %0.7 ret i64 %0.6
+ */
+// %0.1, %0.2 and %0.3 are live at once, so one of them is spilled and then reloaded
+TEST(RegAlloc, SpilledValueIsReloaded) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto &bb = foo.emplace_back();
+    auto &x = bb.emplace_back<bjac::ArgumentInstruction>(0);
+    auto &a = bb.emplace_back<bjac::BinaryOperator>(kAdd, x, x);
+    auto &b = bb.emplace_back<bjac::BinaryOperator>(kMul, x, x);
+    auto &c = bb.emplace_back<bjac::BinaryOperator>(kSub, x, x);
+    auto &d = bb.emplace_back<bjac::BinaryOperator>(kAdd, a, b);
+    auto &e = bb.emplace_back<bjac::BinaryOperator>(kAdd, d, c);
+    auto &f = bb.emplace_back<bjac::BinaryOperator>(kAdd, e, a);
+    bb.emplace_back<bjac::ReturnInstruction>(f);
+
+    // Act
+    const bjac::RegAlloc allocator{foo, 2};
+
+    // Assert
+    expect_valid_allocation(foo, allocator);
+    EXPECT_GT(allocator.stack_slots_count(), 0);
+    EXPECT_TRUE(std::ranges::any_of(allocator.moves(), [](const auto &move) static {
+        return move.from.kind == kStackSlot && move.to.kind == kRegister;
+    }));
+    EXPECT_THROW(allocator.at(d, 0), std::out_of_range);
+}
+
+/*
+ * i64 foo(i64)
+ * %bb0:
+ *     %0.0 = i64 arg [0]
+ *     %0.1 = i64 add %0.0, %0.0
+ *     %0.2 = i64 mul %0.0, %0.0
+ *     %0.3 = i64 sub %0.0, %0.0
+ *     %0.4 = i64 add %0.1, %0.2
+ *     %0.5 = i64 add %0.4, %0.3
+ *     %0.6 = i64 add %0.5, %0.1
+ *     %0.7 = i64 add %0.6, %0.6
+ *     %0.8 = i64 mul %0.6, %0.6
+ *     %0.9 = i64 sub %0.6, %0.6
+ *     %0.10 = i64 add %0.7, %0.8
+ *     %0.11 = i64 add %0.10, %0.9
+ *     %0.12 = i64 add %0.11, %0.7
+ *     %0.13 ret i64 %0.12
+ */
+// The computation of SpilledValueIsReloaded is repeated on its result. Values spilled in the first
+// half are dead by the time the second half spills, so they share stack slots
+TEST(RegAlloc, StackSlotsAreShared) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto &bb = foo.emplace_back();
+    bjac::Instruction *x = &bb.emplace_back<bjac::ArgumentInstruction>(0);
+    for (int i = 0; i != 2; ++i) {
+        auto &a = bb.emplace_back<bjac::BinaryOperator>(kAdd, *x, *x);
+        auto &b = bb.emplace_back<bjac::BinaryOperator>(kMul, *x, *x);
+        auto &c = bb.emplace_back<bjac::BinaryOperator>(kSub, *x, *x);
+        auto &d = bb.emplace_back<bjac::BinaryOperator>(kAdd, a, b);
+        auto &e = bb.emplace_back<bjac::BinaryOperator>(kAdd, d, c);
+        x = &bb.emplace_back<bjac::BinaryOperator>(kAdd, e, a);
+    }
+    bb.emplace_back<bjac::ReturnInstruction>(*x);
+
+    // Act
+    const bjac::RegAlloc allocator{foo, 2};
+
+    // Assert
+    expect_valid_allocation(foo, allocator);
+    const auto spilled_values =
+        static_cast<std::size_t>(std::ranges::count_if(allocator, [](const auto &pair) static {
+            return std::ranges::any_of(pair.second, [](const auto &part) static {
+                return part.storage.kind == kStackSlot;
+            });
+        }));
+    EXPECT_GT(allocator.stack_slots_count(), 0);
+    EXPECT_LT(allocator.stack_slots_count(), spilled_values);
+}
+
+// The function of StackSlotsAreShared with more registers than fit in a machine word
+TEST(RegAlloc, ManyRegisters) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto &bb = foo.emplace_back();
+    bjac::Instruction *x = &bb.emplace_back<bjac::ArgumentInstruction>(0);
+    for (int i = 0; i != 2; ++i) {
+        auto &a = bb.emplace_back<bjac::BinaryOperator>(kAdd, *x, *x);
+        auto &b = bb.emplace_back<bjac::BinaryOperator>(kMul, *x, *x);
+        auto &c = bb.emplace_back<bjac::BinaryOperator>(kSub, *x, *x);
+        auto &d = bb.emplace_back<bjac::BinaryOperator>(kAdd, a, b);
+        auto &e = bb.emplace_back<bjac::BinaryOperator>(kAdd, d, c);
+        x = &bb.emplace_back<bjac::BinaryOperator>(kAdd, e, a);
+    }
+    bb.emplace_back<bjac::ReturnInstruction>(*x);
+
+    // Act
+    const bjac::RegAlloc allocator{foo, 70};
+
+    // Assert
+    expect_valid_allocation(foo, allocator);
+    EXPECT_EQ(allocator.stack_slots_count(), 0);
+    EXPECT_TRUE(allocator.moves().empty());
+}
+
+// The function of EnoughRegisters: constants evicted from registers are materialized again instead
+// of being stored to the stack
+TEST(RegAlloc, ConstantsAreRematerialized) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64);
+    auto &bb = foo.emplace_back();
+    auto &a = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 1);
+    auto &b = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 2);
+    auto &c = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 3);
+    auto &d = bb.emplace_back<bjac::BinaryOperator>(kAdd, a, b);
+    auto &e = bb.emplace_back<bjac::BinaryOperator>(kAdd, d, c);
+    auto &f = bb.emplace_back<bjac::BinaryOperator>(kAdd, e, a);
+    bb.emplace_back<bjac::ReturnInstruction>(f);
+
+    // Act
+    const bjac::RegAlloc allocator{foo, 2};
+
+    // Assert
+    expect_valid_allocation(foo, allocator);
+    EXPECT_EQ(allocator.stack_slots_count(), 0);
+    EXPECT_EQ(allocator.spill_cost(), 0.0);
+    EXPECT_TRUE(std::ranges::any_of(allocator.moves(), [](const auto &move) static {
+        return move.from.kind == kRematerialized && move.to.kind == kRegister;
+    }));
+    EXPECT_TRUE(std::ranges::none_of(allocator.moves(), [](const auto &move) static {
+        return move.to.kind == kRematerialized;
+    }));
+}
+
+/*
+ * i64 foo(i64)
+ * %bb0:
+ *     %0.0 = i64 arg [0]
+ *     %0.1 = i64 add %0.0, %0.0
+ *     %0.2 = i64 mul %0.0, %0.0
+ *     %0.3 = i64 add %0.1, %0.2
+ *     %0.4 = i64 mul %0.3, %0.3
+ *     %0.5 = i64 add %0.4, %0.0
+ *     %0.6 ret i64 %0.5
+ */
+// The argument is not read between %0.2 and %0.5, so it's evicted, and its incoming register is
+// taken by other values. The argument is stored and reloaded instead of being read from there again
+TEST(RegAlloc, EvictedArgumentsAreStored) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto &bb = foo.emplace_back();
+    auto &x = bb.emplace_back<bjac::ArgumentInstruction>(0);
+    auto &a = bb.emplace_back<bjac::BinaryOperator>(kAdd, x, x);
+    auto &b = bb.emplace_back<bjac::BinaryOperator>(kMul, x, x);
+    auto &c = bb.emplace_back<bjac::BinaryOperator>(kAdd, a, b);
+    auto &d = bb.emplace_back<bjac::BinaryOperator>(kMul, c, c);
+    auto &e = bb.emplace_back<bjac::BinaryOperator>(kAdd, d, x);
+    bb.emplace_back<bjac::ReturnInstruction>(e);
+
+    // Act
+    const bjac::RegAlloc allocator{foo, 2};
+
+    // Assert
+    expect_valid_allocation(foo, allocator);
+    EXPECT_EQ(allocator.at(x),
+              (Storage{.kind = kRegister, .index = bjac::RegAlloc::argument_register(0)}));
+    EXPECT_TRUE(std::ranges::any_of(allocator.parts(x), [](const auto &part) static {
+        return part.storage.kind == kStackSlot;
+    }));
+    EXPECT_TRUE(std::ranges::any_of(std::initializer_list{&b, &c, &d}, [&](const auto *instr) {
+        return allocator.at(*instr) == allocator.at(x);
+    }));
+    EXPECT_TRUE(std::ranges::none_of(allocator.moves(), [](const auto &move) static {
+        return move.from.kind == kRematerialized || move.to.kind == kRematerialized;
+    }));
+}
+
+/*
+ * i64 foo(i64)
+ * %bb0:
+ *     %0.0 = i64 arg [0]
+ *     %0.1 = i64 mul %0.0, %0.0
+ *     %0.2 = i64 constant 0
+ *     %0.3 = i64 constant 1
+ *     %0.4 br label %bb1
+ * %bb1: ; preds: %bb0, %bb2
+ *     %1.0 = phi i64 [%0.2, %bb0], [%2.0, %bb2]
+ *     %1.1 = icmp ult i64 %1.0, %0.0
+ *     %1.2 br i1 %1.1, label %bb2, label %bb3
+ * %bb2: ; preds: %bb1
+ *     %2.0 = i64 add %1.0, %0.3
+ *     %2.1 br label %bb1
+ * %bb3: ; preds: %bb1
+ *     %3.0 = i64 add %1.0, %0.1
+ *     %3.1 ret i64 %3.0
+ */
+// Five values are live at the comparison. The bound of the loop is not read again before the end
+// of the linear order, but the loop reads it on every iteration; %0.1 is the one to evict
+TEST(RegAlloc, LoopValuesStayInRegisters) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto [bb, names] = setup(foo, {'A', 'B', 'C', 'D'});
+
+    auto &n = bb.at('A')->emplace_back<bjac::ArgumentInstruction>(0);
+    auto &square = bb.at('A')->emplace_back<bjac::BinaryOperator>(kMul, n, n);
+    auto &zero = bb.at('A')->emplace_back<bjac::ConstInstruction>(get_i64(), 0);
+    auto &one = bb.at('A')->emplace_back<bjac::ConstInstruction>(get_i64(), 1);
+    bb.at('A')->emplace_back<bjac::BranchInstruction>(*bb.at('B'));
+
+    auto &i = bb.at('B')->emplace_back<bjac::PHIInstruction>(get_i64());
+    auto &cond =
+        bb.at('B')->emplace_back<bjac::ICmpInstruction>(bjac::ICmpInstruction::Kind::ult, i, n);
+    bb.at('B')->emplace_back<bjac::BranchInstruction>(cond, *bb.at('C'), *bb.at('D'));
+
+    auto &next = bb.at('C')->emplace_back<bjac::BinaryOperator>(kAdd, i, one);
+    bb.at('C')->emplace_back<bjac::BranchInstruction>(*bb.at('B'));
+
+    auto &sum = bb.at('D')->emplace_back<bjac::BinaryOperator>(kAdd, i, square);
+    bb.at('D')->emplace_back<bjac::ReturnInstruction>(sum);
+
+    i.add_path(*bb.at('A'), zero);
+    i.add_path(*bb.at('C'), next);
+
+    // Act
+    const bjac::RegAlloc allocator{foo, 4};
+
+    // Assert
+    expect_valid_allocation(foo, allocator);
+    EXPECT_GT(allocator.parts(square).size(), 1);
+    for (const auto *instr : {&n, &one, &i, &cond, &next}) {
+        EXPECT_EQ(allocator.parts(*instr).size(), 1);
+    }
+    // one store before the loop and one reload after it
+    EXPECT_DOUBLE_EQ(allocator.spill_cost(), 2.0);
+}
+
 /* i64 foo(i64)
  * %bb0:
- *     %0.0 = i64 arg [0]                        ; register[0]
- *     %0.1 = i64 constant 0                     ; register[1]
- *     %0.2 = i64 constant 1                     ; stack[0]
+ *     %0.0 = i64 arg [0]
+ *     %0.1 = i64 constant 0
+ *     %0.2 = i64 constant 1
  *     %0.3 br label %bb1
  * %bb1: ; preds: %bb0, %bb2
- *     %1.0 = phi i64 [%0.1, %bb0], [%2.0, %bb2] ; stack[1]
- *     %1.1 = icmp ult i64 %1.0, %0.0            ; register[1]
+ *     %1.0 = phi i64 [%0.1, %bb0], [%2.0, %bb2]
+ *     %1.1 = icmp ult i64 %1.0, %0.0
  *     %1.2 br i1 %1.1, label %bb2, label %bb3
  * %bb2: ; preds: %bb1
- *     %2.0 = i64 add %1.0, %0.2                 ; register[1]
+ *     %2.0 = i64 add %1.0, %0.2
  *     %2.1 br label %bb1
  * %bb3: ; preds: %bb1
  *     %3.0 ret i64 %1.0
@@ -69,38 +440,93 @@ TEST(RegAlloc, Loop1) {
     const bjac::RegAlloc allocator{foo, 2};
 
     // Assert
-    EXPECT_EQ(allocator.at(arg), Storage(kRegister, 0));
-    EXPECT_EQ(allocator.at(i), Storage(kRegister, 1));
-    EXPECT_EQ(allocator.at(one), Storage(kStackSlot, 0));
-    EXPECT_EQ(allocator.at(phi), Storage(kStackSlot, 1));
-    EXPECT_EQ(allocator.at(cond), Storage(kRegister, 1));
-    EXPECT_EQ(allocator.at(add), Storage(kRegister, 1));
+    expect_valid_allocation(foo, allocator);
+}
+
+// The function of Loop1: the increment takes the register of the PHI instruction, so nothing is
+// moved on the back edge
+TEST(RegAlloc, PHIInputsShareRegisters) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto [bb, names] = setup(foo, {'A', 'B', 'C', 'D'});
+
+    auto &arg = bb.at('A')->emplace_back<bjac::ArgumentInstruction>(0);
+    auto &i = bb.at('A')->emplace_back<bjac::ConstInstruction>(get_i64(), 0);
+    auto &one = bb.at('A')->emplace_back<bjac::ConstInstruction>(get_i64(), 1);
+    bb.at('A')->emplace_back<bjac::BranchInstruction>(*bb.at('B'));
+
+    auto &phi = bb.at('B')->emplace_back<bjac::PHIInstruction>(get_i64());
+    auto &cond =
+        bb.at('B')->emplace_back<bjac::ICmpInstruction>(bjac::ICmpInstruction::Kind::ult, phi, arg);
+    bb.at('B')->emplace_back<bjac::BranchInstruction>(cond, *bb.at('C'), *bb.at('D'));
+
+    auto &add = bb.at('C')->emplace_back<bjac::BinaryOperator>(kAdd, phi, one);
+    bb.at('C')->emplace_back<bjac::BranchInstruction>(*bb.at('B'));
+
+    bb.at('D')->emplace_back<bjac::ReturnInstruction>(phi);
+    phi.add_path(*bb.at('A'), i);
+    phi.add_path(*bb.at('C'), add);
+
+    // Act
+    const bjac::RegAlloc allocator{foo, 4};
+
+    // Assert
+    expect_valid_allocation(foo, allocator);
+    EXPECT_EQ(allocator.at(add), allocator.at(phi));
+    EXPECT_EQ(allocator.at(arg),
+              (Storage{.kind = kRegister, .index = bjac::RegAlloc::argument_register(0)}));
+}
+
+/*
+ * i64 foo(i64, i64)
+ * %bb0:
+ *     %0.0 = i64 arg [1]
+ *     %0.1 = i64 add %0.0, %0.0
+ *     %0.2 ret i64 %0.1
+ */
+TEST(RegAlloc, ValuesPreferConventionRegisters) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64, kI64});
+    auto &bb = foo.emplace_back();
+    auto &x = bb.emplace_back<bjac::ArgumentInstruction>(1);
+    auto &y = bb.emplace_back<bjac::BinaryOperator>(kAdd, x, x);
+    bb.emplace_back<bjac::ReturnInstruction>(y);
+
+    // Act
+    const bjac::RegAlloc allocator{foo, 4};
+
+    // Assert
+    expect_valid_allocation(foo, allocator);
+    EXPECT_EQ(allocator.at(x),
+              (Storage{.kind = kRegister, .index = bjac::RegAlloc::argument_register(1)}));
+    EXPECT_EQ(allocator.at(y),
+              (Storage{.kind = kRegister, .index = bjac::RegAlloc::kReturnRegister}));
 }
 
 /*
  * i64 foo(i64)
  * %bb0:
- *    %0.0 = i64 constant 0                      ; register[0]
- *    %0.1 = i64 constant 1                      ; stack[2]
- *    %0.2 = i64 constant 2                      ; stack[0]
- *    %0.3 = i64 arg [0]                         ; stack[1]
+ *    %0.0 = i64 constant 0
+ *    %0.1 = i64 constant 1
+ *    %0.2 = i64 constant 2
+ *    %0.3 = i64 arg [0]
  *    %0.4 br label %bb1
  * %bb1: ; preds: %bb0, %bb5
- *     %1.0 = phi i64 [%0.0, %bb0], [%4.0, %bb5] ; register[0]
- *     %1.1 = i64 mul %1.0, %0.2                 ; register[0]
- *     %1.2 = icmp ult i64 %1.1, %0.3            ; register[1]
+ *     %1.0 = phi i64 [%0.0, %bb0], [%4.0, %bb5]
+ *     %1.1 = i64 mul %1.0, %0.2
+ *     %1.2 = icmp ult i64 %1.1, %0.3
  *     %1.3 br i1 %1.2, label %bb2, label %bb3
  * %bb2: ; preds: %bb1
- *     %2.0 = i64 add %1.1, %0.1                 ; register[1]
+ *     %2.0 = i64 add %1.1, %0.1
  *     %2.1 br label %bb4
  * %bb3: ; preds: %bb1
- *     %3.0 = i64 add %1.1, %0.2                 ; register[1]
+ *     %3.0 = i64 add %1.1, %0.2
  *     %3.1 br label %bb4
  * %bb4: ; preds: %bb2, %bb3
- *     %4.0 = phi i64 [%2.0, %bb2], [%3.0, %bb3] ; register[1]
+ *     %4.0 = phi i64 [%2.0, %bb2], [%3.0, %bb3]
  *     %4.1 br label %bb5
  * %bb5: ; preds: %bb4
- *     %5.0 = icmp ult i64 %1.1, %0.3            ; register[0]
+ *     %5.0 = icmp ult i64 %1.1, %0.3
  *     %5.1 br i1 %5.0, label %bb6, label %bb1
  * %bb6: ; preds: %bb5
  *     %6.0 ret i64 %4.0
@@ -147,31 +573,21 @@ TEST(RegAlloc, Loop2) {
     const bjac::RegAlloc allocator{foo, 2};
 
     // Assert
-    EXPECT_EQ(allocator.at(zero), Storage(kRegister, 0));
-    EXPECT_EQ(allocator.at(one), Storage(kStackSlot, 2));
-    EXPECT_EQ(allocator.at(two), Storage(kStackSlot, 0));
-    EXPECT_EQ(allocator.at(arg), Storage(kStackSlot, 1));
-    EXPECT_EQ(allocator.at(b_phi), Storage(kRegister, 0));
-    EXPECT_EQ(allocator.at(prod), Storage(kRegister, 0));
-    EXPECT_EQ(allocator.at(b_cmp), Storage(kRegister, 1));
-    EXPECT_EQ(allocator.at(c_prod), Storage(kRegister, 1));
-    EXPECT_EQ(allocator.at(d_prod), Storage(kRegister, 1));
-    EXPECT_EQ(allocator.at(e_phi), Storage(kRegister, 1));
-    EXPECT_EQ(allocator.at(f_cmp), Storage(kRegister, 0));
+    expect_valid_allocation(foo, allocator);
 }
 
 /*
  * %bb0:
- *     %0.0 = i64 arg [0]                        ; register[0]
- *     %0.1 = i64 constant 0                     ; stack[0]
- *     %0.2 = i64 constant 1                     ; stack[1]
- *     %0.3 = icmp eq i64 %0.0, %0.1             ; register[0]
+ *     %0.0 = i64 arg [0]
+ *     %0.1 = i64 constant 0
+ *     %0.2 = i64 constant 1
+ *     %0.3 = icmp eq i64 %0.0, %0.1
  *     %0.4 br i1 %0.3, label %bb1, label %bb2
  * %bb2: ; preds: %bb0, %bb3
- *     %2.0 = phi i64 [%0.1, %bb0], [%2.2, %bb3] ; register[0]
- *     %2.1 = phi i64 [%0.1, %bb0], [%2.3, %bb3] ; register[1]
- *     %2.2 = i64 add %2.0, %2.1                 ; register[0]
- *     %2.3 = i64 add %2.1, %0.2                 ; register[1]
+ *     %2.0 = phi i64 [%0.1, %bb0], [%2.2, %bb3]
+ *     %2.1 = phi i64 [%0.1, %bb0], [%2.3, %bb3]
+ *     %2.2 = i64 add %2.0, %2.1
+ *     %2.3 = i64 add %2.1, %0.2
  *     %2.4 br label %bb3
  * %bb3: ; preds: %bb2
  *     %3.0 br label %bb2
@@ -210,12 +626,174 @@ TEST(RegAlloc, Loop3) {
     const bjac::RegAlloc allocator{foo, 2};
 
     // Assert
-    EXPECT_EQ(allocator.at(arg), Storage(kRegister, 0));
-    EXPECT_EQ(allocator.at(zero), Storage(kStackSlot, 0));
-    EXPECT_EQ(allocator.at(one), Storage(kStackSlot, 1));
-    EXPECT_EQ(allocator.at(a_cmp), Storage(kRegister, 0));
-    EXPECT_EQ(allocator.at(acc), Storage(kRegister, 0));
-    EXPECT_EQ(allocator.at(counter), Storage(kRegister, 1));
-    EXPECT_EQ(allocator.at(next_acc), Storage(kRegister, 0));
-    EXPECT_EQ(allocator.at(next_counter), Storage(kRegister, 1));
+    expect_valid_allocation(foo, allocator);
+}
+
+TEST(GraphColoringRegAlloc, ThrowOneRequestForZeroRegisters) {
+    // Assign
+    const bjac::Function foo = get_func("foo", kVoid);
+
+    // Act & Assert
+    EXPECT_THROW(bjac::GraphColoringRegAlloc(foo, 0), std::invalid_argument);
+}
+
+TEST(GraphColoringRegAlloc, ThrowOneRequestForOneRegister) {
+    // Assign
+    const bjac::Function foo = get_func("foo", kVoid);
+
+    // Act & Assert
+    EXPECT_THROW(bjac::GraphColoringRegAlloc(foo, 1), std::invalid_argument);
+}
+
+// The function of EnoughRegisters
+TEST(GraphColoringRegAlloc, EnoughRegisters) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64);
+    auto &bb = foo.emplace_back();
+    auto &a = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 1);
+    auto &b = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 2);
+    auto &c = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 3);
+    auto &d = bb.emplace_back<bjac::BinaryOperator>(kAdd, a, b);
+    auto &e = bb.emplace_back<bjac::BinaryOperator>(kAdd, d, c);
+    auto &f = bb.emplace_back<bjac::BinaryOperator>(kAdd, e, a);
+    bb.emplace_back<bjac::ReturnInstruction>(f);
+
+    // Act
+    const bjac::GraphColoringRegAlloc allocator{foo, 3};
+
+    // Assert
+    expect_valid_allocation(foo, allocator);
+    EXPECT_EQ(allocator.stack_slots_count(), 0);
+    EXPECT_TRUE(allocator.moves().empty());
+    for (const auto *instr : {&a, &b, &c, &d, &e, &f}) {
+        EXPECT_EQ(allocator.parts(*instr).size(), 1);
+    }
+}
+
+// The function of StackSlotsAreShared: values spilled everywhere are stored after their definitions
+// and reloaded before their uses
+TEST(GraphColoringRegAlloc, SpilledValuesAreReloaded) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto &bb = foo.emplace_back();
+    bjac::Instruction *x = &bb.emplace_back<bjac::ArgumentInstruction>(0);
+    for (int i = 0; i != 2; ++i) {
+        auto &a = bb.emplace_back<bjac::BinaryOperator>(kAdd, *x, *x);
+        auto &b = bb.emplace_back<bjac::BinaryOperator>(kMul, *x, *x);
+        auto &c = bb.emplace_back<bjac::BinaryOperator>(kSub, *x, *x);
+        auto &d = bb.emplace_back<bjac::BinaryOperator>(kAdd, a, b);
+        auto &e = bb.emplace_back<bjac::BinaryOperator>(kAdd, d, c);
+        x = &bb.emplace_back<bjac::BinaryOperator>(kAdd, e, a);
+    }
+    bb.emplace_back<bjac::ReturnInstruction>(*x);
+
+    // Act
+    const bjac::GraphColoringRegAlloc allocator{foo, 2};
+
+    // Assert
+    expect_valid_allocation(foo, allocator);
+    EXPECT_GT(allocator.stack_slots_count(), 0);
+    EXPECT_TRUE(std::ranges::any_of(allocator.moves(), [](const auto &move) static {
+        return move.from.kind == kRegister && move.to.kind == kStackSlot;
+    }));
+    EXPECT_TRUE(std::ranges::any_of(allocator.moves(), [](const auto &move) static {
+        return move.from.kind == kStackSlot && move.to.kind == kRegister;
+    }));
+}
+
+// The function of EvictedArgumentsAreStored
+TEST(GraphColoringRegAlloc, EvictedArgumentsAreStored) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto &bb = foo.emplace_back();
+    auto &x = bb.emplace_back<bjac::ArgumentInstruction>(0);
+    auto &a = bb.emplace_back<bjac::BinaryOperator>(kAdd, x, x);
+    auto &b = bb.emplace_back<bjac::BinaryOperator>(kMul, x, x);
+    auto &c = bb.emplace_back<bjac::BinaryOperator>(kAdd, a, b);
+    auto &d = bb.emplace_back<bjac::BinaryOperator>(kMul, c, c);
+    auto &e = bb.emplace_back<bjac::BinaryOperator>(kAdd, d, x);
+    bb.emplace_back<bjac::ReturnInstruction>(e);
+
+    // Act
+    const bjac::GraphColoringRegAlloc allocator{foo, 2};
+
+    // Assert
+    expect_valid_allocation(foo, allocator);
+    EXPECT_GT(allocator.stack_slots_count(), 0);
+    EXPECT_TRUE(std::ranges::none_of(allocator.parts(x), [](const auto &part) static {
+        return part.storage.kind == kRematerialized;
+    }));
+    EXPECT_TRUE(std::ranges::none_of(allocator.moves(), [](const auto &move) static {
+        return move.from.kind == kRematerialized || move.to.kind == kRematerialized;
+    }));
+}
+
+// The function of Loop1: the PHI instruction shares the register with both its inputs
+TEST(GraphColoringRegAlloc, PHIIsCoalescedWithInputs) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto [bb, names] = setup(foo, {'A', 'B', 'C', 'D'});
+
+    auto &arg = bb.at('A')->emplace_back<bjac::ArgumentInstruction>(0);
+    auto &i = bb.at('A')->emplace_back<bjac::ConstInstruction>(get_i64(), 0);
+    auto &one = bb.at('A')->emplace_back<bjac::ConstInstruction>(get_i64(), 1);
+    bb.at('A')->emplace_back<bjac::BranchInstruction>(*bb.at('B'));
+
+    auto &phi = bb.at('B')->emplace_back<bjac::PHIInstruction>(get_i64());
+    auto &cond =
+        bb.at('B')->emplace_back<bjac::ICmpInstruction>(bjac::ICmpInstruction::Kind::ult, phi, arg);
+    bb.at('B')->emplace_back<bjac::BranchInstruction>(cond, *bb.at('C'), *bb.at('D'));
+
+    auto &add = bb.at('C')->emplace_back<bjac::BinaryOperator>(kAdd, phi, one);
+    bb.at('C')->emplace_back<bjac::BranchInstruction>(*bb.at('B'));
+
+    bb.at('D')->emplace_back<bjac::ReturnInstruction>(phi);
+    phi.add_path(*bb.at('A'), i);
+    phi.add_path(*bb.at('C'), add);
+
+    // Act
+    const bjac::GraphColoringRegAlloc allocator{foo, 4};
+
+    // Assert
+    expect_valid_allocation(foo, allocator);
+    EXPECT_EQ(allocator.coalesced_moves_count(), 2);
+    EXPECT_EQ(allocator.at(phi), allocator.at(i));
+    EXPECT_EQ(allocator.at(phi), allocator.at(add));
+    EXPECT_TRUE(allocator.moves().empty());
+}
+
+// The function of Loop3 with two PHI instructions live at once
+TEST(GraphColoringRegAlloc, Loop) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto [bb, names] = setup(foo, {'A', 'B', 'C', 'D'});
+
+    auto &arg = bb.at('A')->emplace_back<bjac::ArgumentInstruction>(0);
+    auto &zero = bb.at('A')->emplace_back<bjac::ConstInstruction>(get_i64(), 0);
+    auto &one = bb.at('A')->emplace_back<bjac::ConstInstruction>(get_i64(), 1);
+    auto &a_cmp =
+        bb.at('A')->emplace_back<bjac::ICmpInstruction>(bjac::ICmpInstruction::Kind::eq, arg, zero);
+    bb.at('A')->emplace_back<bjac::BranchInstruction>(a_cmp, *bb.at('B'), *bb.at('C'));
+
+    bb.at('B')->emplace_back<bjac::ReturnInstruction>(zero);
+
+    auto &acc = bb.at('C')->emplace_back<bjac::PHIInstruction>(get_i64());
+    auto &counter = bb.at('C')->emplace_back<bjac::PHIInstruction>(get_i64());
+    auto &next_acc = bb.at('C')->emplace_back<bjac::BinaryOperator>(kAdd, acc, counter);
+    auto &next_counter = bb.at('C')->emplace_back<bjac::BinaryOperator>(kAdd, counter, one);
+    bb.at('C')->emplace_back<bjac::BranchInstruction>(*bb.at('D'));
+
+    bb.at('D')->emplace_back<bjac::BranchInstruction>(*bb.at('C'));
+
+    acc.add_path(*bb.at('A'), zero);
+    acc.add_path(*bb.at('D'), next_acc);
+
+    counter.add_path(*bb.at('A'), zero);
+    counter.add_path(*bb.at('D'), next_counter);
+
+    // Act
+    const bjac::GraphColoringRegAlloc allocator{foo, 2};
+
+    // Assert
+    expect_valid_allocation(foo, allocator);
 }
@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "bjac/analysis/graph_coloring.hpp"
+#include "bjac/analysis/reg_alloc.hpp"
+#include "bjac/analysis/ssa_destruction.hpp"
+
+#include "bjac/IR/argument_instruction.hpp"
+#include "bjac/IR/binary_operator.hpp"
+#include "bjac/IR/branch_instruction.hpp"
+#include "bjac/IR/constant_instruction.hpp"
+#include "bjac/IR/icmp_instruction.hpp"
+#include "bjac/IR/phi_instruction.hpp"
+#include "bjac/IR/ret_instruction.hpp"
+
+#include "test/common.hpp"
+
+using enum bjac::Instruction::Opcode;
+using enum bjac::Type::ID;
+using Storage = bjac::RegAlloc::Storage;
+using Copy = bjac::SSADestruction::Copy;
+using Placement = bjac::SSADestruction::Placement;
+
+namespace {
+
+using Location = std::pair<Storage::Kind, std::size_t>;
+
+Location location(const Storage &storage) { return {storage.kind, storage.index}; }
+
+Storage reg(std::size_t index) { return {.kind = Storage::kRegister, .index = index}; }
+Storage slot(std::size_t index) { return {.kind = Storage::kStackSlot, .index = index}; }
+
+Copy make_move(const Storage &from, const Storage &to) {
+    return {.kind = Copy::kMove, .value = nullptr, .from = from, .to = to};
+}
+
+// Checks that copies done one by one on locations initially holding their own names leave every
+// destination of the parallel copy with the name of its source
+void expect_same_effect(std::span<const Copy> parallel, std::span<const Copy> sequence) {
+    std::map<Location, Location> contents;
+    auto get = [&contents](const Storage &storage) {
+        auto it = contents.find(location(storage));
+        return it == contents.end() ? location(storage) : it->second;
+    };
+
+    for (const auto &copy : sequence) {
+        const auto from = get(copy.from);
+        const auto to = get(copy.to);
+        contents[location(copy.to)] = from;
+        if (copy.kind == Copy::kSwap) {
+            contents[location(copy.from)] = to;
+        }
+    }
+
+    for (const auto &copy : parallel) {
+        EXPECT_EQ(get(copy.to), location(copy.from));
+    }
+}
+
+} // unnamed namespace
+
+TEST(SSADestruction, ChainIsOrdered) {
+    // Assign
+    const std::vector parallel{make_move(reg(0), reg(1)), make_move(reg(1), reg(2)),
+                               make_move(slot(0), reg(0))};
+
+    // Act
+    const auto sequence = bjac::SSADestruction::sequentialize(parallel);
+
+    // Assert
+    EXPECT_EQ(sequence.size(), 3);
+    EXPECT_TRUE(std::ranges::all_of(sequence, [](const Copy &copy) static {
+        return copy.kind == Copy::kMove;
+    }));
+    expect_same_effect(parallel, sequence);
+}
+
+TEST(SSADestruction, CycleIsBrokenWithSwaps) {
+    // Assign
+    const std::vector parallel{make_move(reg(0), reg(1)), make_move(reg(1), reg(2)),
+                               make_move(reg(2), reg(0))};
+
+    // Act
+    const auto sequence = bjac::SSADestruction::sequentialize(parallel);
+
+    // Assert
+    EXPECT_EQ(sequence.size(), 2);
+    EXPECT_TRUE(std::ranges::all_of(sequence, [](const Copy &copy) static {
+        return copy.kind == Copy::kSwap;
+    }));
+    expect_same_effect(parallel, sequence);
+}
+
+TEST(SSADestruction, CycleIsBrokenWithScratch) {
+    // Assign
+    const std::vector parallel{make_move(reg(0), reg(1)), make_move(reg(1), reg(0)),
+                               make_move(reg(0), slot(0))};
+
+    // Act
+    const auto sequence = bjac::SSADestruction::sequentialize(parallel, reg(2));
+
+    // Assert
+    EXPECT_EQ(sequence.size(), 4);
+    EXPECT_TRUE(std::ranges::all_of(sequence, [](const Copy &copy) static {
+        return copy.kind == Copy::kMove;
+    }));
+    expect_same_effect(parallel, sequence);
+}
+
+TEST(SSADestruction, CopiesInPlaceVanish) {
+    // Assign
+    const std::vector parallel{make_move(reg(0), reg(0)), make_move(slot(1), slot(1))};
+
+    // Act & Assert
+    EXPECT_TRUE(bjac::SSADestruction::sequentialize(parallel).empty());
+}
+
+/*
+ * i64 foo(i64)
+ * %bb0:
+ *     %0.0 = i64 arg [0]
+ *     %0.1 = i64 constant 0
+ *     %0.2 = icmp eq i64 %0.0, %0.1
+ *     %0.3 br i1 %0.2, label %bb1, label %bb2
+ * %bb1: ; preds: %bb0
+ *     %1.0 = i64 add %0.0, %0.0
+ *     %1.1 br label %bb2
+ * %bb2: ; preds: %bb0, %bb1
+ *     %2.0 = phi i64 [%0.0, %bb0], [%1.0, %bb1]
+ *     %2.1 = i64 add %2.0, %0.0
+ *     %2.2 ret i64 %2.1
+ */
+// %2.0 and %0.0 are live at once, so the input of %2.0 is copied on the edge from %bb0, which is
+// critical
+TEST(SSADestruction, CriticalEdgeIsSplit) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto [bb, names] = setup(foo, {'A', 'B', 'C'});
+
+    auto &x = bb.at('A')->emplace_back<bjac::ArgumentInstruction>(0);
+    auto &zero = bb.at('A')->emplace_back<bjac::ConstInstruction>(get_i64(), 0);
+    auto &cond =
+        bb.at('A')->emplace_back<bjac::ICmpInstruction>(bjac::ICmpInstruction::Kind::eq, x, zero);
+    bb.at('A')->emplace_back<bjac::BranchInstruction>(cond, *bb.at('B'), *bb.at('C'));
+
+    auto &y = bb.at('B')->emplace_back<bjac::BinaryOperator>(kAdd, x, x);
+    bb.at('B')->emplace_back<bjac::BranchInstruction>(*bb.at('C'));
+
+    auto &phi = bb.at('C')->emplace_back<bjac::PHIInstruction>(get_i64());
+    auto &sum = bb.at('C')->emplace_back<bjac::BinaryOperator>(kAdd, phi, x);
+    bb.at('C')->emplace_back<bjac::ReturnInstruction>(sum);
+
+    phi.add_path(*bb.at('A'), x);
+    phi.add_path(*bb.at('B'), y);
+
+    const bjac::RegAlloc allocator{foo, 4};
+
+    // Act
+    const bjac::SSADestruction destruction{foo, allocator};
+
+    // Assert
+    EXPECT_EQ(destruction.split_edges_count(), 1);
+    for (const auto &edge : destruction.edges()) {
+        if (edge.placement != Placement::kSplitEdge) {
+            continue;
+        }
+        EXPECT_EQ(edge.pred, bb.at('A'));
+        EXPECT_EQ(edge.succ, bb.at('C'));
+        ASSERT_EQ(edge.copies.size(), 1);
+        EXPECT_EQ(edge.copies.front().value, &x);
+        EXPECT_EQ(edge.copies.front().from, allocator.at(x));
+        EXPECT_EQ(edge.copies.front().to, allocator.at(phi));
+    }
+}
+
+// The function of GraphColoringRegAlloc.PHIIsCoalescedWithInputs needs no copies
+TEST(SSADestruction, CoalescedPHINeedsNoCopies) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto [bb, names] = setup(foo, {'A', 'B', 'C', 'D'});
+
+    auto &arg = bb.at('A')->emplace_back<bjac::ArgumentInstruction>(0);
+    auto &i = bb.at('A')->emplace_back<bjac::ConstInstruction>(get_i64(), 0);
+    auto &one = bb.at('A')->emplace_back<bjac::ConstInstruction>(get_i64(), 1);
+    bb.at('A')->emplace_back<bjac::BranchInstruction>(*bb.at('B'));
+
+    auto &phi = bb.at('B')->emplace_back<bjac::PHIInstruction>(get_i64());
+    auto &cond =
+        bb.at('B')->emplace_back<bjac::ICmpInstruction>(bjac::ICmpInstruction::Kind::ult, phi, arg);
+    bb.at('B')->emplace_back<bjac::BranchInstruction>(cond, *bb.at('C'), *bb.at('D'));
+
+    auto &add = bb.at('C')->emplace_back<bjac::BinaryOperator>(kAdd, phi, one);
+    bb.at('C')->emplace_back<bjac::BranchInstruction>(*bb.at('B'));
+
+    bb.at('D')->emplace_back<bjac::ReturnInstruction>(phi);
+    phi.add_path(*bb.at('A'), i);
+    phi.add_path(*bb.at('C'), add);
+
+    const bjac::GraphColoringRegAlloc allocator{foo, 4};
+
+    // Act
+    const bjac::SSADestruction destruction{foo, allocator};
+
+    // Assert
+    EXPECT_TRUE(destruction.edges().empty());
+    EXPECT_EQ(destruction.coalesced_copies_count(), 2);
+}
+
+// A constant read only by the PHI instruction isn't kept in a register and is materialized right
+// into the location of the PHI instruction
+TEST(SSADestruction, RematerializedInput) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto [bb, names] = setup(foo, {'A', 'B', 'C', 'D'});
+
+    auto &arg = bb.at('A')->emplace_back<bjac::ArgumentInstruction>(0);
+    auto &zero = bb.at('A')->emplace_back<bjac::ConstInstruction>(get_i64(), 0);
+    auto &one = bb.at('A')->emplace_back<bjac::ConstInstruction>(get_i64(), 1);
+    bb.at('A')->emplace_back<bjac::BranchInstruction>(*bb.at('B'));
+
+    auto &phi = bb.at('B')->emplace_back<bjac::PHIInstruction>(get_i64());
+    auto &cond =
+        bb.at('B')->emplace_back<bjac::ICmpInstruction>(bjac::ICmpInstruction::Kind::ult, phi, arg);
+    bb.at('B')->emplace_back<bjac::BranchInstruction>(cond, *bb.at('C'), *bb.at('D'));
+
+    auto &add = bb.at('C')->emplace_back<bjac::BinaryOperator>(kAdd, phi, one);
+    bb.at('C')->emplace_back<bjac::BranchInstruction>(*bb.at('B'));
+
+    bb.at('D')->emplace_back<bjac::ReturnInstruction>(phi);
+    phi.add_path(*bb.at('A'), zero);
+    phi.add_path(*bb.at('C'), add);
+
+    const bjac::RegAlloc allocator{foo, 4};
+
+    // Act
+    const bjac::SSADestruction destruction{foo, allocator};
+
+    // Assert
+    const auto entry =
+        std::ranges::find(destruction.edges(), bb.at('A'), &bjac::SSADestruction::Edge::pred);
+    ASSERT_NE(entry, destruction.edges().end());
+    EXPECT_EQ(entry->succ, bb.at('B'));
+    ASSERT_EQ(entry->copies.size(), 1);
+    EXPECT_EQ(entry->copies.front().value, &zero);
+    EXPECT_EQ(entry->copies.front().from.kind, Storage::kRematerialized);
+    EXPECT_EQ(entry->copies.front().to, allocator.at(phi));
+}
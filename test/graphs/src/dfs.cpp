@@ -0,0 +1,99 @@
+#include <array>
+#include <cstddef>
+#include <iterator>
+
+#include <gtest/gtest.h>
+
+#include "bjac/graphs/dfs.hpp"
+
+#include "bjac/IR/branch_instruction.hpp"
+#include "bjac/IR/constant_instruction.hpp"
+#include "bjac/IR/function.hpp"
+
+#include "test/common.hpp"
+
+using enum bjac::Type::ID;
+
+TEST(DFS, Orders) {
+    // Assign
+    bjac::Function foo = get_func("foo", kVoid);
+    auto [bb, names] = setup(foo, {'A', 'B', 'C', 'D', 'E'});
+
+    auto &cond = bb.at('A')->emplace_back<bjac::ConstInstruction>(get_i1(), 0);
+
+    bb.at('A')->emplace_back<bjac::BranchInstruction>(cond, *bb.at('B'), *bb.at('C'));
+    bb.at('B')->emplace_back<bjac::BranchInstruction>(cond, *bb.at('D'), *bb.at('C'));
+    bb.at('C')->emplace_back<bjac::BranchInstruction>(*bb.at('D'));
+    bb.at('D')->emplace_back<bjac::BranchInstruction>(cond, *bb.at('A'), *bb.at('E'));
+
+    // Act
+    const bjac::DFS<bjac::ConstFunctionGraphTraits> dfs{foo};
+
+    // Assert
+    EXPECT_TRUE(matches(dfs.pre_order(),
+                        {std::array{bb.at('A'), bb.at('B'), bb.at('D'), bb.at('E'), bb.at('C')}},
+                        names));
+    EXPECT_TRUE(matches(dfs.post_order(),
+                        {std::array{bb.at('E'), bb.at('D'), bb.at('C'), bb.at('B'), bb.at('A')}},
+                        names));
+
+    EXPECT_EQ(dfs.info(bb.at('A')).get_discovery_time(), 1);
+    EXPECT_EQ(dfs.info(bb.at('A')).get_finished_time(), 10);
+    EXPECT_EQ(dfs.info(bb.at('C')).get_discovery_time(), 7);
+    EXPECT_EQ(dfs.info(bb.at('C')).get_finished_time(), 8);
+
+    EXPECT_EQ(std::next(dfs.st_begin(bb.at('C')))->get_vertex(), bb.at('B'));
+    EXPECT_EQ(std::next(dfs.st_begin(bb.at('E')))->get_vertex(), bb.at('D'));
+    EXPECT_EQ(std::distance(dfs.st_begin(bb.at('E')), dfs.st_end()), 3);
+
+    EXPECT_TRUE(dfs.is_proper_ancestor_of(bb.at('E'), bb.at('B')));
+    EXPECT_FALSE(dfs.is_ancestor_of(bb.at('C'), bb.at('D')));
+}
+
+TEST(DFS, Recompute) {
+    // Assign
+    bjac::Function foo = get_func("foo", kVoid);
+    auto [bb, names] = setup(foo, {'A', 'B', 'C', 'D'});
+
+    auto &cond = bb.at('A')->emplace_back<bjac::ConstInstruction>(get_i1(), 0);
+
+    bb.at('A')->emplace_back<bjac::BranchInstruction>(*bb.at('B'));
+    bb.at('B')->emplace_back<bjac::BranchInstruction>(cond, *bb.at('C'), *bb.at('D'));
+    bb.at('C')->emplace_back<bjac::BranchInstruction>(*bb.at('B'));
+
+    bjac::DFS<bjac::ConstFunctionGraphTraits> dfs{foo};
+
+    // Act
+    dfs.recompute(foo, bb.at('B'), {bb.at('C')});
+
+    // Assert
+    EXPECT_EQ(dfs.get_source(), bb.at('B'));
+    EXPECT_FALSE(dfs.contains(bb.at('A')));
+    EXPECT_TRUE(dfs.contains(bb.at('C')));
+    EXPECT_TRUE(matches(dfs.pre_order(), {std::array{bb.at('B'), bb.at('D')}}, names));
+    EXPECT_TRUE(matches(dfs.post_order(), {std::array{bb.at('D'), bb.at('B')}}, names));
+    EXPECT_EQ(dfs.info(bb.at('B')).get_discovery_time(), 1);
+}
+
+TEST(DFS, DeepStraightLine) {
+    // Assign
+    constexpr std::size_t kNBlocks = 200'000;
+
+    bjac::Function foo = get_func("foo", kVoid);
+    bjac::BasicBlock *prev = nullptr;
+    for (std::size_t i = 0; i != kNBlocks; ++i) {
+        auto &bb = foo.emplace_back();
+        if (prev) {
+            prev->emplace_back<bjac::BranchInstruction>(bb);
+        }
+        prev = &bb;
+    }
+
+    // Act
+    const bjac::DFS<bjac::ConstFunctionGraphTraits> dfs{foo};
+
+    // Assert
+    EXPECT_EQ(dfs.size(), kNBlocks);
+    EXPECT_EQ(dfs.pre_order().front(), &foo.front());
+    EXPECT_EQ(dfs.post_order().front(), &foo.back());
+}
@@ -1,8 +1,15 @@
+#include <algorithm>
 #include <array>
+#include <cstddef>
+#include <initializer_list>
 #include <optional>
+#include <random>
+#include <utility>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include "bjac/graphs/dfs.hpp"
 #include "bjac/graphs/dominator_tree.hpp"
 
 #include "bjac/IR/branch_instruction.hpp"
@@ -170,3 +177,162 @@ TEST(DominatorTree, Mandatory_3) {
     EXPECT_EQ(dom_tree.idom(bb.at('I')), bb.at('B'));
     EXPECT_TRUE(empty(dom_tree.successors(bb.at('I')), names));
 }
+
+TEST(DominatorTree, NearestCommonDominator) {
+    // Assign
+    bjac::Function foo = get_func("foo", kVoid);
+    auto [bb, names] = setup(foo, {'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J'});
+
+    auto &cond = bb.at('A')->emplace_back<bjac::ConstInstruction>(get_i1(), 0);
+
+    bb.at('A')->emplace_back<bjac::BranchInstruction>(*bb.at('B'));
+    bb.at('B')->emplace_back<bjac::BranchInstruction>(cond, *bb.at('E'), *bb.at('C'));
+    bb.at('C')->emplace_back<bjac::BranchInstruction>(*bb.at('D'));
+    bb.at('D')->emplace_back<bjac::BranchInstruction>(*bb.at('G'));
+    bb.at('E')->emplace_back<bjac::BranchInstruction>(cond, *bb.at('F'), *bb.at('D'));
+    bb.at('F')->emplace_back<bjac::BranchInstruction>(cond, *bb.at('B'), *bb.at('H'));
+    bb.at('G')->emplace_back<bjac::BranchInstruction>(cond, *bb.at('C'), *bb.at('I'));
+    bb.at('H')->emplace_back<bjac::BranchInstruction>(cond, *bb.at('G'), *bb.at('I'));
+
+    // Act
+    const bjac::DominatorTree<bjac::ConstFunctionGraphTraits> dom_tree{foo};
+
+    // Assert
+    EXPECT_EQ(dom_tree.nearest_common_dominator(bb.at('F'), bb.at('H')), bb.at('F'));
+    EXPECT_EQ(dom_tree.nearest_common_dominator(bb.at('H'), bb.at('F')), bb.at('F'));
+    EXPECT_EQ(dom_tree.nearest_common_dominator(bb.at('H'), bb.at('E')), bb.at('E'));
+    EXPECT_EQ(dom_tree.nearest_common_dominator(bb.at('H'), bb.at('C')), bb.at('B'));
+    EXPECT_EQ(dom_tree.nearest_common_dominator(bb.at('D'), bb.at('G')), bb.at('B'));
+    EXPECT_EQ(dom_tree.nearest_common_dominator(bb.at('I'), bb.at('A')), bb.at('A'));
+    EXPECT_EQ(dom_tree.nearest_common_dominator(bb.at('C'), bb.at('C')), bb.at('C'));
+    EXPECT_EQ(dom_tree.nearest_common_dominator(bb.at('C'), bb.at('J')), std::nullopt);
+
+    EXPECT_TRUE(dom_tree.is_dominator_of(bb.at('H'), bb.at('E')));
+    EXPECT_FALSE(dom_tree.is_dominator_of(bb.at('E'), bb.at('H')));
+    EXPECT_FALSE(dom_tree.is_dominator_of(bb.at('E'), bb.at('E')));
+    EXPECT_FALSE(dom_tree.is_dominator_of(bb.at('J'), bb.at('A')));
+}
+
+// In tree pre-order R, A, X, U, C the subtree of A ends with U, whose DFS number is less than the
+// one of C. The nearest common dominator of X and C is still R
+TEST(DominatorTree, NearestCommonDominatorAcrossSubtrees) {
+    // Assign
+    bjac::Function foo = get_func("foo", kVoid);
+    auto [bb, names] = setup(foo, {'R', 'A', 'C', 'U', 'X'});
+
+    auto &cond = bb.at('R')->emplace_back<bjac::ConstInstruction>(get_i1(), 0);
+
+    bb.at('R')->emplace_back<bjac::BranchInstruction>(cond, *bb.at('A'), *bb.at('C'));
+    bb.at('A')->emplace_back<bjac::BranchInstruction>(cond, *bb.at('U'), *bb.at('X'));
+    bb.at('X')->emplace_back<bjac::BranchInstruction>(*bb.at('C'));
+
+    // Act
+    const bjac::DominatorTree<bjac::ConstFunctionGraphTraits> dom_tree{foo};
+
+    // Assert
+    EXPECT_EQ(dom_tree.idom(bb.at('C')), bb.at('R'));
+    EXPECT_EQ(dom_tree.nearest_common_dominator(bb.at('X'), bb.at('C')), bb.at('R'));
+    EXPECT_EQ(dom_tree.nearest_common_dominator(bb.at('C'), bb.at('X')), bb.at('R'));
+    EXPECT_EQ(dom_tree.nearest_common_dominator(bb.at('U'), bb.at('C')), bb.at('R'));
+    EXPECT_EQ(dom_tree.nearest_common_dominator(bb.at('U'), bb.at('X')), bb.at('A'));
+}
+
+TEST(DominatorTree, RandomGraphs) {
+    using Traits = bjac::ConstFunctionGraphTraits;
+
+    constexpr std::size_t kNBlocks = 64;
+    std::mt19937 gen{42};
+
+    for (std::size_t graph_i = 0; graph_i != 16; ++graph_i) {
+        // Assign
+        bjac::Function foo = get_func("foo", kVoid);
+
+        std::vector<bjac::BasicBlock *> bbs;
+        for (std::size_t i = 0; i != kNBlocks; ++i) {
+            bbs.push_back(&foo.emplace_back());
+        }
+
+        auto &cond = bbs.front()->emplace_back<bjac::ConstInstruction>(get_i1(), 0);
+
+        // arbitrary edges make irreducible loops and unreachable blocks possible
+        std::uniform_int_distribution<std::size_t> target{0, kNBlocks - 1};
+        std::uniform_int_distribution<int> n_succs{0, 2};
+        for (auto *bb : bbs) {
+            const auto n = n_succs(gen);
+            const auto t = target(gen);
+            const auto f = target(gen);
+            if (n == 1 || (n == 2 && t == f)) {
+                bb->emplace_back<bjac::BranchInstruction>(*bbs[t]);
+            } else if (n == 2) {
+                bb->emplace_back<bjac::BranchInstruction>(cond, *bbs[t], *bbs[f]);
+            }
+        }
+
+        // Act
+        const bjac::DominatorTree<Traits> dom_tree{foo};
+
+        // Assert
+        const bjac::DFS<Traits> dfs{foo};
+
+        // dominates[u][v] is true iff u dominates v (not necessarily strictly): that's the case
+        // when v becomes unreachable once u is removed from the graph
+        std::vector dominates(kNBlocks, std::vector<bool>(kNBlocks, false));
+        auto index = [&bbs](const bjac::BasicBlock *bb) {
+            return static_cast<std::size_t>(std::ranges::find(bbs, bb) - bbs.begin());
+        };
+
+        for (std::size_t u = 0; u != kNBlocks; ++u) {
+            if (!dfs.contains(bbs[u])) {
+                continue;
+            }
+            const auto dfs_without_u =
+                u == 0 ? std::nullopt
+                       : std::optional<bjac::DFS<Traits>>{
+                             std::in_place, foo, bbs.front(),
+                             std::initializer_list<const bjac::BasicBlock *>{bbs[u]}};
+            for (std::size_t v = 0; v != kNBlocks; ++v) {
+                dominates[u][v] =
+                    dfs.contains(bbs[v]) && (u == 0 || u == v || !dfs_without_u->contains(bbs[v]));
+            }
+        }
+
+        for (std::size_t v = 0; v != kNBlocks; ++v) {
+            ASSERT_EQ(dom_tree.contains(bbs[v]), dfs.contains(bbs[v]));
+            if (!dfs.contains(bbs[v])) {
+                continue;
+            }
+
+            for (std::size_t u = 0; u != kNBlocks; ++u) {
+                EXPECT_EQ(dom_tree.is_dominator_of(bbs[v], bbs[u]), u != v && dominates[u][v]);
+            }
+
+            if (v == 0) {
+                EXPECT_EQ(dom_tree.idom(bbs[v]), std::nullopt);
+            } else {
+                const auto idom = index(dom_tree.idom_unchecked(bbs[v]));
+                EXPECT_TRUE(dominates[idom][v]);
+                for (std::size_t u = 0; u != kNBlocks; ++u) {
+                    if (u != v && dominates[u][v]) {
+                        EXPECT_TRUE(dominates[u][idom]);
+                    }
+                }
+            }
+
+            for (std::size_t u = 0; u != kNBlocks; ++u) {
+                if (!dfs.contains(bbs[u])) {
+                    continue;
+                }
+
+                const auto ncd = dom_tree.nearest_common_dominator(bbs[v], bbs[u]);
+                ASSERT_TRUE(ncd.has_value());
+                const auto w = index(*ncd);
+                EXPECT_TRUE(dominates[w][v] && dominates[w][u]);
+                for (std::size_t x = 0; x != kNBlocks; ++x) {
+                    if (dominates[x][v] && dominates[x][u]) {
+                        EXPECT_TRUE(dominates[x][w]);
+                    }
+                }
+            }
+        }
+    }
+}
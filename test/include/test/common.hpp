@@ -14,26 +14,25 @@
 
 #include "bjac/IR/function.hpp"
 
-inline auto get_void() { return std::make_unique<bjac::VoidType>(); }
-inline auto get_i1() { return std::make_unique<bjac::IntegralType>(bjac::Type::ID::kI1); }
-inline auto get_i64() { return std::make_unique<bjac::IntegralType>(bjac::Type::ID::kI64); }
-inline auto get_ptr(bjac::Type::ID id) { return std::make_unique<bjac::PointerType>(id); }
+inline auto get_void() { return bjac::VoidType::get(); }
+inline auto get_i1() { return bjac::IntegralType::get(bjac::Type::ID::kI1); }
+inline auto get_i64() { return bjac::IntegralType::get(bjac::Type::ID::kI64); }
+inline auto get_ptr(bjac::Type::ID id) { return bjac::PointerType::get(id); }
 inline auto get_array(bjac::Type::ID id, std::size_t size) {
-    return std::make_unique<bjac::ArrayType>(id, size);
+    return bjac::ArrayType::get(id, size);
 }
 
 inline auto get_func(std::string_view name, bjac::Type::ID ret,
                      std::initializer_list<bjac::Type::ID> params = {}) {
-    std::vector<std::unique_ptr<bjac::Type>> parameters;
+    std::vector<const bjac::Type *> parameters;
     for (auto id : params) {
-        parameters.emplace_back(std::make_unique<bjac::IntegralType>(id));
+        parameters.push_back(bjac::IntegralType::get(id));
     }
 
     if (ret == bjac::Type::ID::kVoid) {
-        return bjac::Function{name, std::make_unique<bjac::VoidType>(), std::move(parameters)};
+        return bjac::Function{name, bjac::VoidType::get(), std::move(parameters)};
     } else {
-        return bjac::Function{name, std::make_unique<bjac::IntegralType>(ret),
-                              std::move(parameters)};
+        return bjac::Function{name, bjac::IntegralType::get(ret), std::move(parameters)};
     }
 }
 
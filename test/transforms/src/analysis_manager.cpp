@@ -0,0 +1,137 @@
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "bjac/IR/argument_instruction.hpp"
+#include "bjac/IR/binary_operator.hpp"
+#include "bjac/IR/branch_instruction.hpp"
+#include "bjac/IR/constant_instruction.hpp"
+#include "bjac/IR/function.hpp"
+#include "bjac/IR/ret_instruction.hpp"
+
+#include "bjac/transforms/analysis_manager.hpp"
+#include "bjac/transforms/check_elimination.hpp"
+#include "bjac/transforms/constant_folding.hpp"
+#include "bjac/transforms/dce.hpp"
+
+#include "test/common.hpp"
+
+using enum bjac::Type::ID;
+using enum bjac::Instruction::Opcode;
+using bjac::Analysis;
+using bjac::PreservedAnalyses;
+
+TEST(AnalysisManager, ResultsAreCached) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto [bb, names] = setup(foo, {'A', 'B'});
+
+    auto &x = bb.at('A')->emplace_back<bjac::ArgumentInstruction>(0);
+    bb.at('A')->emplace_back<bjac::BranchInstruction>(*bb.at('B'));
+    bb.at('B')->emplace_back<bjac::ReturnInstruction>(x);
+
+    bjac::AnalysisManager am;
+
+    // Act
+    const auto *dom_tree = std::addressof(am.dom_tree(foo));
+    const auto *loop_tree = std::addressof(am.loop_tree(foo));
+
+    // Assert
+    EXPECT_EQ(std::addressof(am.dom_tree(foo)), dom_tree);
+    EXPECT_EQ(std::addressof(am.loop_tree(foo)), loop_tree);
+    EXPECT_EQ(am.computations_count(), 3);
+    EXPECT_TRUE(am.is_cached(foo, Analysis::kDFS));
+    EXPECT_TRUE(am.is_cached(foo, Analysis::kDominatorTree));
+    EXPECT_TRUE(am.is_cached(foo, Analysis::kLoopTree));
+}
+
+TEST(AnalysisManager, DroppingAnalysisDropsDependentOnes) {
+    // Assign
+    bjac::Function foo = get_func("foo", kVoid);
+    foo.emplace_back().emplace_back<bjac::ReturnInstruction>();
+
+    bjac::AnalysisManager am;
+    am.loop_tree(foo);
+
+    // Act
+    am.invalidate(foo, PreservedAnalyses::none().preserve(Analysis::kDFS).preserve(
+                           Analysis::kLoopTree));
+
+    // Assert
+    EXPECT_TRUE(am.is_cached(foo, Analysis::kDFS));
+    EXPECT_FALSE(am.is_cached(foo, Analysis::kDominatorTree));
+    EXPECT_FALSE(am.is_cached(foo, Analysis::kLoopTree));
+}
+
+TEST(AnalysisManager, PassesChangingNothingPreserveAll) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto &bb = foo.emplace_back();
+
+    auto &x = bb.emplace_back<bjac::ArgumentInstruction>(0);
+    auto &two = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 2);
+    auto &mul = bb.emplace_back<bjac::BinaryOperator>(kMul, x, two);
+    bb.emplace_back<bjac::ReturnInstruction>(mul);
+
+    bjac::AnalysisManager am;
+
+    // Act
+    const auto folding = bjac::ConstantFoldingPass{}.run(foo, am);
+    const auto check_elimination = bjac::CheckEliminationPass{}.run(foo, am);
+    const auto dce = bjac::DCE{}.run(foo, am);
+
+    // Assert
+    EXPECT_EQ(folding, PreservedAnalyses::all());
+    EXPECT_EQ(check_elimination, PreservedAnalyses::all());
+    EXPECT_EQ(dce, PreservedAnalyses::all());
+    EXPECT_FALSE(folding.is_changed());
+    // DFS is computed once for all passes, and the dominator tree for the check elimination
+    EXPECT_EQ(am.computations_count(), 2);
+}
+
+TEST(AnalysisManager, FoldingPreservesCFG) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64);
+    auto &bb = foo.emplace_back();
+
+    auto &two = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 2);
+    auto &three = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 3);
+    auto &add = bb.emplace_back<bjac::BinaryOperator>(kAdd, two, three);
+    bb.emplace_back<bjac::ReturnInstruction>(add);
+
+    bjac::AnalysisManager am;
+    am.dom_tree(foo);
+
+    // Act
+    const auto preserved = bjac::ConstantFoldingPass{}.run(foo, am);
+
+    // Assert
+    EXPECT_EQ(preserved, PreservedAnalyses::cfg());
+    EXPECT_NE(preserved, PreservedAnalyses::all());
+    EXPECT_TRUE(preserved.is_changed());
+    EXPECT_TRUE(am.is_cached(foo, Analysis::kDominatorTree));
+    EXPECT_EQ(am.computations_count(), 2);
+}
+
+TEST(AnalysisManager, RemovingBlocksInvalidatesAll) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto [bb, names] = setup(foo, {'A', 'B'});
+
+    auto &x = bb.at('A')->emplace_back<bjac::ArgumentInstruction>(0);
+    bb.at('A')->emplace_back<bjac::ReturnInstruction>(x);
+    bb.at('B')->emplace_back<bjac::ReturnInstruction>(x);
+
+    bjac::AnalysisManager am;
+    am.loop_tree(foo);
+
+    // Act
+    const auto preserved = bjac::DCE{}.run(foo, am);
+
+    // Assert
+    EXPECT_EQ(preserved, PreservedAnalyses::none());
+    EXPECT_EQ(foo.size(), 1);
+    EXPECT_FALSE(am.is_cached(foo, Analysis::kDFS));
+    EXPECT_FALSE(am.is_cached(foo, Analysis::kDominatorTree));
+    EXPECT_FALSE(am.is_cached(foo, Analysis::kLoopTree));
+}
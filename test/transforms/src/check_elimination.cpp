@@ -20,8 +20,8 @@ using enum bjac::Instruction::Opcode;
 
 TEST(NullCheck, CannotEliminateSingleCheck) {
     // Assign
-    std::vector<std::unique_ptr<bjac::Type>> parameters;
-    parameters.emplace_back(get_ptr(kI64));
+    std::vector<const bjac::Type *> parameters;
+    parameters.push_back(get_ptr(kI64));
     bjac::Function foo{"foo", get_i64(), std::move(parameters)};
 
     auto &bb = foo.emplace_back();
@@ -37,7 +37,7 @@ TEST(NullCheck, CannotEliminateSingleCheck) {
     // Assert
     EXPECT_EQ(to_string(foo), "i64 foo(ptr)\n"
                               "%bb0:\n"
-                              "    %0.0 = ptr arg [0]\n"
+                              "    %0.0 = ptr arg [0] ; used by: %0.1, %0.2\n"
                               "    %0.1 null_check ptr %0.0\n"
                               "    %0.2 = load i64, ptr %0.0 ; used by: %0.3\n"
                               "    %0.3 ret i64 %0.2\n");
@@ -45,9 +45,9 @@ TEST(NullCheck, CannotEliminateSingleCheck) {
 
 TEST(BoundsCheck, CannotEliminateSingleCheck) {
     // Assign
-    std::vector<std::unique_ptr<bjac::Type>> parameters;
-    parameters.emplace_back(get_array(kI64, 42));
-    parameters.emplace_back(get_i64());
+    std::vector<const bjac::Type *> parameters;
+    parameters.push_back(get_array(kI64, 42));
+    parameters.push_back(get_i64());
     bjac::Function foo{"foo", get_void(), std::move(parameters)};
 
     auto &bb = foo.emplace_back();
@@ -63,16 +63,16 @@ TEST(BoundsCheck, CannotEliminateSingleCheck) {
     // Assert
     EXPECT_EQ(to_string(foo), "void foo([42 x i64], i64)\n"
                               "%bb0:\n"
-                              "    %0.0 = [42 x i64] arg [0]\n"
-                              "    %0.1 = i64 arg [1]\n"
+                              "    %0.0 = [42 x i64] arg [0] ; used by: %0.2\n"
+                              "    %0.1 = i64 arg [1] ; used by: %0.2\n"
                               "    %0.2 bounds_check [42 x i64] %0.0, i64 %0.1\n"
                               "    %0.3 ret void\n");
 }
 
 TEST(NullCheck, EliminateSimple) {
     // Assign
-    std::vector<std::unique_ptr<bjac::Type>> parameters;
-    parameters.emplace_back(get_ptr(kI64));
+    std::vector<const bjac::Type *> parameters;
+    parameters.push_back(get_ptr(kI64));
     bjac::Function foo{"foo", get_i64(), std::move(parameters)};
 
     auto &bb = foo.emplace_back();
@@ -91,7 +91,7 @@ TEST(NullCheck, EliminateSimple) {
     // Assert
     EXPECT_EQ(to_string(foo), "i64 foo(ptr)\n"
                               "%bb0:\n"
-                              "    %0.0 = ptr arg [0]\n"
+                              "    %0.0 = ptr arg [0] ; used by: %0.1, %0.2, %0.4\n"
                               "    %0.1 null_check ptr %0.0\n"
                               "    %0.2 = load i64, ptr %0.0 ; used by: %0.5\n"
                               "    %0.4 = load i64, ptr %0.0 ; used by: %0.5\n"
@@ -101,9 +101,9 @@ TEST(NullCheck, EliminateSimple) {
 
 TEST(BoundsCheck, EliminateSimple) {
     // Assign
-    std::vector<std::unique_ptr<bjac::Type>> parameters;
-    parameters.emplace_back(get_array(kI64, 42));
-    parameters.emplace_back(get_i64());
+    std::vector<const bjac::Type *> parameters;
+    parameters.push_back(get_array(kI64, 42));
+    parameters.push_back(get_i64());
     bjac::Function foo{"foo", get_void(), std::move(parameters)};
 
     auto &bb = foo.emplace_back();
@@ -120,17 +120,17 @@ TEST(BoundsCheck, EliminateSimple) {
     // Assert
     EXPECT_EQ(to_string(foo), "void foo([42 x i64], i64)\n"
                               "%bb0:\n"
-                              "    %0.0 = [42 x i64] arg [0]\n"
-                              "    %0.1 = i64 arg [1]\n"
+                              "    %0.0 = [42 x i64] arg [0] ; used by: %0.2\n"
+                              "    %0.1 = i64 arg [1] ; used by: %0.2\n"
                               "    %0.2 bounds_check [42 x i64] %0.0, i64 %0.1\n"
                               "    %0.4 ret void\n");
 }
 
 TEST(NullCheck, EliminateFromDominatedBlock) {
     // Assign
-    std::vector<std::unique_ptr<bjac::Type>> parameters;
-    parameters.emplace_back(get_ptr(kI64));
-    parameters.emplace_back(get_i1());
+    std::vector<const bjac::Type *> parameters;
+    parameters.push_back(get_ptr(kI64));
+    parameters.push_back(get_i1());
     bjac::Function foo{"foo", get_i64(), std::move(parameters)};
 
     auto &bb_1 = foo.emplace_back();
@@ -160,7 +160,7 @@ TEST(NullCheck, EliminateFromDominatedBlock) {
     // Assert
     EXPECT_EQ(to_string(foo), "i64 foo(ptr, i1)\n"
                               "%bb0:\n"
-                              "    %0.0 = ptr arg [0]\n"
+                              "    %0.0 = ptr arg [0] ; used by: %0.1, %0.2, %1.1\n"
                               "    %0.1 null_check ptr %0.0\n"
                               "    %0.2 = load i64, ptr %0.0 ; used by: %1.2, %2.0\n"
                               "    %0.3 = i1 arg [1] ; used by: %0.4\n"
@@ -176,10 +176,10 @@ TEST(NullCheck, EliminateFromDominatedBlock) {
 
 TEST(BoundsCheck, EliminateFromDominatedBlock) {
     // Assign
-    std::vector<std::unique_ptr<bjac::Type>> parameters;
-    parameters.emplace_back(get_array(kI64, 42));
-    parameters.emplace_back(get_i64());
-    parameters.emplace_back(get_i1());
+    std::vector<const bjac::Type *> parameters;
+    parameters.push_back(get_array(kI64, 42));
+    parameters.push_back(get_i64());
+    parameters.push_back(get_i1());
     bjac::Function foo{"foo", get_void(), std::move(parameters)};
 
     auto &bb_1 = foo.emplace_back();
@@ -203,8 +203,8 @@ TEST(BoundsCheck, EliminateFromDominatedBlock) {
     // Assert
     EXPECT_EQ(to_string(foo), "void foo([42 x i64], i64, i1)\n"
                               "%bb0:\n"
-                              "    %0.0 = [42 x i64] arg [0]\n"
-                              "    %0.1 = i64 arg [1]\n"
+                              "    %0.0 = [42 x i64] arg [0] ; used by: %0.3\n"
+                              "    %0.1 = i64 arg [1] ; used by: %0.3\n"
                               "    %0.2 = i1 arg [2] ; used by: %0.4\n"
                               "    %0.3 bounds_check [42 x i64] %0.0, i64 %0.1\n"
                               "    %0.4 br i1 %0.2, label %bb1, label %bb2\n"
@@ -216,9 +216,9 @@ TEST(BoundsCheck, EliminateFromDominatedBlock) {
 
 TEST(NullCheck, CannotEliminateUnrelatedChecks) {
     // Assign
-    std::vector<std::unique_ptr<bjac::Type>> parameters;
-    parameters.emplace_back(get_ptr(kI64));
-    parameters.emplace_back(get_ptr(kI64));
+    std::vector<const bjac::Type *> parameters;
+    parameters.push_back(get_ptr(kI64));
+    parameters.push_back(get_ptr(kI64));
     bjac::Function foo{"foo", get_i64(), std::move(parameters)};
 
     auto &bb = foo.emplace_back();
@@ -238,10 +238,10 @@ TEST(NullCheck, CannotEliminateUnrelatedChecks) {
     // Assert
     EXPECT_EQ(to_string(foo), "i64 foo(ptr, ptr)\n"
                               "%bb0:\n"
-                              "    %0.0 = ptr arg [0]\n"
+                              "    %0.0 = ptr arg [0] ; used by: %0.1, %0.2\n"
                               "    %0.1 null_check ptr %0.0\n"
                               "    %0.2 = load i64, ptr %0.0 ; used by: %0.6\n"
-                              "    %0.3 = ptr arg [1]\n"
+                              "    %0.3 = ptr arg [1] ; used by: %0.4, %0.5\n"
                               "    %0.4 null_check ptr %0.3\n"
                               "    %0.5 = load i64, ptr %0.3 ; used by: %0.6\n"
                               "    %0.6 = i64 add %0.2, %0.5 ; used by: %0.7\n"
@@ -250,10 +250,10 @@ TEST(NullCheck, CannotEliminateUnrelatedChecks) {
 
 TEST(BoundsCheck, CannotEliminateUnrelatedChecks) {
     // Assign
-    std::vector<std::unique_ptr<bjac::Type>> parameters;
-    parameters.emplace_back(get_array(kI64, 42));
-    parameters.emplace_back(get_i64());
-    parameters.emplace_back(get_i64());
+    std::vector<const bjac::Type *> parameters;
+    parameters.push_back(get_array(kI64, 42));
+    parameters.push_back(get_i64());
+    parameters.push_back(get_i64());
     bjac::Function foo{"foo", get_void(), std::move(parameters)};
 
     auto &bb = foo.emplace_back();
@@ -271,9 +271,9 @@ TEST(BoundsCheck, CannotEliminateUnrelatedChecks) {
     // Assert
     EXPECT_EQ(to_string(foo), "void foo([42 x i64], i64, i64)\n"
                               "%bb0:\n"
-                              "    %0.0 = [42 x i64] arg [0]\n"
-                              "    %0.1 = i64 arg [1]\n"
-                              "    %0.2 = i64 arg [2]\n"
+                              "    %0.0 = [42 x i64] arg [0] ; used by: %0.3, %0.4\n"
+                              "    %0.1 = i64 arg [1] ; used by: %0.3\n"
+                              "    %0.2 = i64 arg [2] ; used by: %0.4\n"
                               "    %0.3 bounds_check [42 x i64] %0.0, i64 %0.1\n"
                               "    %0.4 bounds_check [42 x i64] %0.0, i64 %0.2\n"
                               "    %0.5 ret void\n");
@@ -281,9 +281,9 @@ TEST(BoundsCheck, CannotEliminateUnrelatedChecks) {
 
 TEST(NullCheck, CannotEliminateChecksFromUnrelatedBasicBlocks) {
     // Assign
-    std::vector<std::unique_ptr<bjac::Type>> parameters;
-    parameters.emplace_back(get_ptr(kI64));
-    parameters.emplace_back(get_i1());
+    std::vector<const bjac::Type *> parameters;
+    parameters.push_back(get_ptr(kI64));
+    parameters.push_back(get_i1());
     bjac::Function foo{"foo", get_i64(), std::move(parameters)};
 
     auto &bb_1 = foo.emplace_back();
@@ -314,7 +314,7 @@ TEST(NullCheck, CannotEliminateChecksFromUnrelatedBasicBlocks) {
     // Assert
     EXPECT_EQ(to_string(foo), "i64 foo(ptr, i1)\n"
                               "%bb0:\n"
-                              "    %0.0 = ptr arg [0]\n"
+                              "    %0.0 = ptr arg [0] ; used by: %1.0, %1.1, %2.1, %2.2\n"
                               "    %0.1 = i1 arg [1] ; used by: %0.3\n"
                               "    %0.2 = i64 constant 42 ; used by: %2.0\n"
                               "    %0.3 br i1 %0.1, label %bb1, label %bb2\n"
@@ -332,10 +332,10 @@ TEST(NullCheck, CannotEliminateChecksFromUnrelatedBasicBlocks) {
 
 TEST(BoundsCheck, CannotEliminateChecksFromUnrelatedBasicBlocks) {
     // Assign
-    std::vector<std::unique_ptr<bjac::Type>> parameters;
-    parameters.emplace_back(get_array(kI64, 42));
-    parameters.emplace_back(get_i64());
-    parameters.emplace_back(get_i1());
+    std::vector<const bjac::Type *> parameters;
+    parameters.push_back(get_array(kI64, 42));
+    parameters.push_back(get_i64());
+    parameters.push_back(get_i1());
     bjac::Function foo{"foo", get_void(), std::move(parameters)};
 
     auto &bb_1 = foo.emplace_back();
@@ -359,8 +359,8 @@ TEST(BoundsCheck, CannotEliminateChecksFromUnrelatedBasicBlocks) {
     // Assert
     EXPECT_EQ(to_string(foo), "void foo([42 x i64], i64, i1)\n"
                               "%bb0:\n"
-                              "    %0.0 = [42 x i64] arg [0]\n"
-                              "    %0.1 = i64 arg [1]\n"
+                              "    %0.0 = [42 x i64] arg [0] ; used by: %1.0, %2.0\n"
+                              "    %0.1 = i64 arg [1] ; used by: %1.0, %2.0\n"
                               "    %0.2 = i1 arg [2] ; used by: %0.3\n"
                               "    %0.3 br i1 %0.2, label %bb1, label %bb2\n"
                               "%bb1: ; preds: %bb0\n"
@@ -363,3 +363,25 @@ TEST(ConstantFolding, ArithmeticCombinationWithLogic) {
     EXPECT_EQ(static_cast<const bjac::ReturnInstruction *>(instrs[7])->get_ret_value(), instrs[6])
         << foo;
 }
+
+TEST(ConstantFolding, NarrowTypesWrapAround) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI8);
+
+    auto &bb = foo.emplace_back();
+
+    const auto *i8 = bjac::IntegralType::get(kI8);
+    auto &zero = bb.emplace_back<bjac::ConstInstruction>(i8, 0);
+    auto &one = bb.emplace_back<bjac::ConstInstruction>(i8, 1);
+    auto &sub = bb.emplace_back<bjac::BinaryOperator>(bjac::Instruction::Opcode::kSub, zero, one);
+    auto &ret = bb.emplace_back<bjac::ReturnInstruction>(sub);
+
+    // Act
+    bjac::ConstantFoldingPass{}.run(foo);
+
+    // Assert
+    const auto *result = ret.get_ret_value();
+    ASSERT_EQ(result->get_opcode(), bjac::Instruction::Opcode::kConst) << foo;
+    EXPECT_EQ(result->get_type_id(), kI8) << foo;
+    EXPECT_EQ(static_cast<const bjac::ConstInstruction *>(result)->get_value(), 0xff) << foo;
+}
@@ -0,0 +1,189 @@
+#include <cstdint>
+#include <ostream>
+
+#include <gtest/gtest.h>
+
+#include "bjac/IR/argument_instruction.hpp"
+#include "bjac/IR/binary_operator.hpp"
+#include "bjac/IR/constant_instruction.hpp"
+#include "bjac/IR/function.hpp"
+#include "bjac/IR/icmp_instruction.hpp"
+#include "bjac/IR/ret_instruction.hpp"
+
+#include "bjac/transforms/analysis_manager.hpp"
+#include "bjac/transforms/inst_combine.hpp"
+
+#include "test/common.hpp"
+
+using enum bjac::Type::ID;
+using enum bjac::Instruction::Opcode;
+
+namespace {
+
+const bjac::Instruction &returned_value(const bjac::BasicBlock &bb) {
+    return *static_cast<const bjac::ReturnInstruction &>(bb.back()).get_ret_value();
+}
+
+struct IdentityParam {
+    bjac::Instruction::Opcode opcode;
+    std::uintmax_t constant;
+
+    friend std::ostream &operator<<(std::ostream &os, [[maybe_unused]] const IdentityParam &p) {
+        return os << "<some-param>";
+    }
+};
+
+} // unnamed namespace
+
+class InstCombineIdentity : public ::testing::TestWithParam<IdentityParam> {};
+
+/*
+ * i64 foo(i64)
+ * %bb0:
+ *     %0.0 = i64 arg [0]
+ *     %0.1 = i64 constant <identity>
+ *     %0.2 = i64 <op> %0.0, %0.1
+ *     %0.3 ret i64 %0.2
+ */
+TEST_P(InstCombineIdentity, /* no test name */) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto &bb = foo.emplace_back();
+
+    auto &x = bb.emplace_back<bjac::ArgumentInstruction>(0);
+    auto &c = bb.emplace_back<bjac::ConstInstruction>(get_i64(), GetParam().constant);
+    auto &op = bb.emplace_back<bjac::BinaryOperator>(GetParam().opcode, x, c);
+    bb.emplace_back<bjac::ReturnInstruction>(op);
+
+    // Act
+    bjac::InstCombinePass{}.run(foo);
+
+    // Assert
+    EXPECT_EQ(&returned_value(bb), &x) << foo;
+    EXPECT_EQ(bb.size(), 2) << foo;
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    /* no instantiation name */, InstCombineIdentity,
+    ::testing::Values(IdentityParam{kAdd, 0}, IdentityParam{kSub, 0}, IdentityParam{kMul, 1},
+                      IdentityParam{kUDiv, 1}, IdentityParam{kSDiv, 1}, IdentityParam{kShl, 0},
+                      IdentityParam{kShrA, 0}, IdentityParam{kShrL, 0},
+                      IdentityParam{kAnd, UINT64_MAX}, IdentityParam{kOr, 0},
+                      IdentityParam{kXor, 0}));
+
+/*
+ * i64 foo(i64)
+ * %bb0:
+ *     %0.0 = i64 arg [0]
+ *     %0.1 = i64 constant 1
+ *     %0.2 = i64 add %0.1, %0.0
+ *     %0.3 = i64 constant 2
+ *     %0.4 = i64 add %0.2, %0.3
+ *     %0.5 = i64 constant 3
+ *     %0.6 = i64 sub %0.4, %0.5
+ *     %0.7 ret i64 %0.6
+ */
+// Every rewrite exposes the next one, and one run is enough for all of them
+TEST(InstCombine, ChainConvergesInOneRun) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto &bb = foo.emplace_back();
+
+    auto &x = bb.emplace_back<bjac::ArgumentInstruction>(0);
+    auto &one = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 1);
+    auto &add_1 = bb.emplace_back<bjac::BinaryOperator>(kAdd, one, x);
+    auto &two = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 2);
+    auto &add_2 = bb.emplace_back<bjac::BinaryOperator>(kAdd, add_1, two);
+    auto &three = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 3);
+    auto &sub = bb.emplace_back<bjac::BinaryOperator>(kSub, add_2, three);
+    bb.emplace_back<bjac::ReturnInstruction>(sub);
+
+    bjac::InstCombinePass pass;
+    bjac::AnalysisManager am;
+
+    // Act
+    const auto preserved = pass.run(foo, am);
+    const auto rewrites_count = pass.rewrites_count();
+    const auto preserved_again = pass.run(foo, am);
+
+    // Assert
+    EXPECT_EQ(preserved, bjac::PreservedAnalyses::cfg());
+    EXPECT_EQ(&returned_value(bb), &x) << foo;
+    EXPECT_EQ(bb.size(), 2) << foo;
+    EXPECT_EQ(preserved_again, bjac::PreservedAnalyses::all());
+    EXPECT_EQ(pass.rewrites_count(), rewrites_count);
+}
+
+/*
+ * i64 foo(i64)
+ * %bb0:
+ *     %0.0 = i64 arg [0]
+ *     %0.1 = i64 constant 8
+ *     %0.2 = i64 mul %0.0, %0.1
+ *     %0.3 = i64 urem %0.2, %0.1
+ *     %0.4 ret i64 %0.3
+ */
+TEST(InstCombine, StrengthReduction) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto &bb = foo.emplace_back();
+
+    auto &x = bb.emplace_back<bjac::ArgumentInstruction>(0);
+    auto &eight = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 8);
+    auto &mul = bb.emplace_back<bjac::BinaryOperator>(kMul, x, eight);
+    auto &rem = bb.emplace_back<bjac::BinaryOperator>(kURem, mul, eight);
+    bb.emplace_back<bjac::ReturnInstruction>(rem);
+
+    // Act
+    bjac::InstCombinePass{}.run(foo);
+
+    // Assert
+    const auto &result = returned_value(bb);
+    ASSERT_EQ(result.get_opcode(), kAnd) << foo;
+    const auto &mask = static_cast<const bjac::BinaryOperator &>(result);
+    ASSERT_EQ(mask.get_rhs()->get_opcode(), kConst) << foo;
+    EXPECT_EQ(static_cast<const bjac::ConstInstruction *>(mask.get_rhs())->get_value(), 7) << foo;
+
+    const auto *shift = mask.get_lhs();
+    ASSERT_EQ(shift->get_opcode(), kShl) << foo;
+    const auto &shl = static_cast<const bjac::BinaryOperator &>(*shift);
+    EXPECT_EQ(shl.get_lhs(), &x) << foo;
+    ASSERT_EQ(shl.get_rhs()->get_opcode(), kConst) << foo;
+    EXPECT_EQ(static_cast<const bjac::ConstInstruction *>(shl.get_rhs())->get_value(), 3) << foo;
+}
+
+/*
+ * i1 foo(i64)
+ * %bb0:
+ *     %0.0 = i64 arg [0]
+ *     %0.1 = i64 xor %0.0, %0.0
+ *     %0.2 = i64 constant 5
+ *     %0.3 = i64 add %0.1, %0.2
+ *     %0.4 = i64 constant 5
+ *     %0.5 = i1 icmp eq %0.3, %0.4
+ *     %0.6 ret i1 %0.5
+ */
+// Folding constants exposed by other rules uses the rules of constant folding
+TEST(InstCombine, ExposedConstantsAreFolded) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI1, {kI64});
+    auto &bb = foo.emplace_back();
+
+    auto &x = bb.emplace_back<bjac::ArgumentInstruction>(0);
+    auto &zero = bb.emplace_back<bjac::BinaryOperator>(kXor, x, x);
+    auto &five = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 5);
+    auto &sum = bb.emplace_back<bjac::BinaryOperator>(kAdd, zero, five);
+    auto &other_five = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 5);
+    auto &cmp =
+        bb.emplace_back<bjac::ICmpInstruction>(bjac::ICmpInstruction::Kind::eq, sum, other_five);
+    bb.emplace_back<bjac::ReturnInstruction>(cmp);
+
+    // Act
+    bjac::InstCombinePass{}.run(foo);
+
+    // Assert
+    const auto &result = returned_value(bb);
+    ASSERT_EQ(result.get_opcode(), kConst) << foo;
+    EXPECT_EQ(static_cast<const bjac::ConstInstruction &>(result).get_value(), 1) << foo;
+    EXPECT_EQ(bb.size(), 3) << foo;
+}
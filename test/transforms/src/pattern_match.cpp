@@ -0,0 +1,146 @@
+#include <cstddef>
+
+#include <gtest/gtest.h>
+
+#include "bjac/IR/argument_instruction.hpp"
+#include "bjac/IR/binary_operator.hpp"
+#include "bjac/IR/constant_instruction.hpp"
+#include "bjac/IR/function.hpp"
+#include "bjac/IR/instruction.hpp"
+#include "bjac/IR/ret_instruction.hpp"
+
+#include "bjac/transforms/pattern_match.hpp"
+
+#include "test/common.hpp"
+
+using enum bjac::Type::ID;
+using enum bjac::Instruction::Opcode;
+using namespace bjac::pattern;
+
+/*
+ * i64 foo(i64)
+ * %bb0:
+ *     %0.0 = i64 arg [0]
+ *     %0.1 = i64 constant 5
+ *     %0.2 = i64 add %0.0, %0.1
+ *     %0.3 = i64 add %0.1, %0.0
+ *     %0.4 ret i64 %0.0
+ */
+TEST(PatternMatch, CommutablePatternMatchesBothOrders) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto &bb = foo.emplace_back();
+
+    auto &arg = bb.emplace_back<bjac::ArgumentInstruction>(0);
+    auto &five = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 5);
+    auto &add_1 = bb.emplace_back<bjac::BinaryOperator>(kAdd, arg, five);
+    auto &add_2 = bb.emplace_back<bjac::BinaryOperator>(kAdd, five, arg);
+    bb.emplace_back<bjac::ReturnInstruction>(arg);
+
+    constexpr auto kCommutable = m_c_Add(m_Value(x), m_Constant(c1));
+    constexpr auto kOrdered = m_Add(m_Value(x), m_Constant(c1));
+
+    // Act
+    Bindings bindings_1;
+    const bool matched_1 = kCommutable.match(&add_1, bindings_1);
+    Bindings bindings_2;
+    const bool matched_2 = kCommutable.match(&add_2, bindings_2);
+    Bindings bindings_3;
+    const bool matched_3 = kOrdered.match(&add_2, bindings_3);
+
+    // Assert
+    ASSERT_TRUE(matched_1) << foo;
+    EXPECT_EQ(bindings_1[x], &arg) << foo;
+    EXPECT_EQ(bindings_1.constant(c1), 5) << foo;
+
+    ASSERT_TRUE(matched_2) << foo;
+    EXPECT_EQ(bindings_2[x], &arg) << foo;
+    EXPECT_EQ(bindings_2.constant(c1), 5) << foo;
+
+    EXPECT_FALSE(matched_3) << foo;
+}
+
+/*
+ * i64 foo(i64, i64)
+ * %bb0:
+ *     %0.0 = i64 arg [0]
+ *     %0.1 = i64 arg [1]
+ *     %0.2 = i64 sub %0.0, %0.0
+ *     %0.3 = i64 sub %0.0, %0.1
+ *     %0.4 ret i64 %0.0
+ */
+TEST(PatternMatch, DeferredMatchesBoundValue) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64, kI64});
+    auto &bb = foo.emplace_back();
+
+    auto &arg_1 = bb.emplace_back<bjac::ArgumentInstruction>(0);
+    auto &arg_2 = bb.emplace_back<bjac::ArgumentInstruction>(1);
+    auto &same = bb.emplace_back<bjac::BinaryOperator>(kSub, arg_1, arg_1);
+    auto &different = bb.emplace_back<bjac::BinaryOperator>(kSub, arg_1, arg_2);
+    bb.emplace_back<bjac::ReturnInstruction>(arg_1);
+
+    constexpr auto kPattern = m_Sub(m_Value(x), m_Deferred(x));
+
+    // Act
+    Bindings bindings;
+    const bool matched_same = kPattern.match(&same, bindings);
+    const bool matched_different = kPattern.match(&different, bindings);
+
+    // Assert
+    EXPECT_TRUE(matched_same) << foo;
+    EXPECT_FALSE(matched_different) << foo;
+}
+
+/*
+ * i64 foo(i64)
+ * %bb0:
+ *     %0.0 = i64 arg [0]
+ *     %0.1 = i64 constant 0
+ *     %0.2 = i64 add %0.0, %0.1
+ *     %0.3 = i64 add %0.0, %0.0
+ *     %0.4 ret i64 %0.2
+ */
+TEST(RuleSet, FirstAppliedRuleWins) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto &bb = foo.emplace_back();
+
+    auto &arg = bb.emplace_back<bjac::ArgumentInstruction>(0);
+    auto &zero = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 0);
+    auto &add_zero = bb.emplace_back<bjac::BinaryOperator>(kAdd, arg, zero);
+    auto &add_arg = bb.emplace_back<bjac::BinaryOperator>(kAdd, arg, arg);
+    auto &ret = bb.emplace_back<bjac::ReturnInstruction>(add_zero);
+
+    std::size_t declined = 0;
+    std::size_t applied_last = 0;
+    const RuleSet rules{
+        // matches but declines to apply
+        Rule{m_Add(m_Value(x), m_Constant(c1)),
+             [&declined](bjac::BinaryOperator &, const Bindings &) -> bjac::Instruction * {
+                 ++declined;
+                 return nullptr;
+             }},
+        Rule{m_Add(m_Value(x), m_Zero()),
+             [](bjac::BinaryOperator &, const Bindings &b) static { return b[x]; }},
+        Rule{m_Add(m_Any(), m_Any()),
+             [&applied_last](bjac::BinaryOperator &add, const Bindings &) -> bjac::Instruction * {
+                 ++applied_last;
+                 return &add;
+             }},
+    };
+
+    // Act
+    auto *result_zero = rules.apply(add_zero);
+    auto *result_arg = rules.apply(add_arg);
+    auto *result_ret = rules.apply(ret);
+
+    // Assert
+    EXPECT_EQ(result_zero, &arg) << foo;
+    EXPECT_EQ(result_arg, &add_arg) << foo;
+    EXPECT_EQ(result_ret, nullptr) << foo;
+
+    // the first rule isn't tried for add_arg as its rhs can't be a constant
+    EXPECT_EQ(declined, 1);
+    EXPECT_EQ(applied_last, 1);
+}
@@ -12,6 +12,7 @@
 #include "bjac/IR/function.hpp"
 #include "bjac/IR/ret_instruction.hpp"
 
+#include "bjac/transforms/analysis_manager.hpp"
 #include "bjac/transforms/peepholes.hpp"
 
 #include "test/common.hpp"
@@ -550,3 +551,89 @@ TEST(PeepholesForShrLWithZero, ShiftZeroForAnyNumberOfBits) {
               instrs.at(1))
         << foo;
 }
+
+/*
+ * Before:
+ * i64 foo(i64)
+ * %bb0:
+ *     %0.0 = i64 arg [0] ; used by: %0.2
+ *     %0.1 = i64 constant 0x0ff ; used by: %0.2
+ *     %0.2 = i64 xor %0.0, %0.1 ; used by: %0.4
+ *     %0.3 = i64 constant 0xff0 ; used by: %0.4
+ *     %0.4 = i64 xor %0.2, %0.3 ; used by: %0.5
+ *     %0.5 ret i64 %0.4
+ *
+ * After:
+ * i64 foo(i64)
+ * %bb0:
+ *     %0.0 = i64 arg [0] ; used by: %0.2, %0.4
+ *     %0.1 = i64 constant 0x0ff ; used by: %0.2
+ *     %0.2 = i64 xor %0.0, %0.1
+ *     %0.3 = i64 constant 0xff0
+ *     %0.6 = i64 constant 0xf0f ; used by: %0.4
+ *     %0.4 = i64 xor %0.0, %0.6 ; used by: %0.5
+ *     %0.5 ret i64 %0.4
+ */
+TEST(PeepholesForXor, ChainingConstantOnRightRight) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+
+    auto &bb = foo.emplace_back();
+
+    auto &arg = bb.emplace_back<bjac::ArgumentInstruction>(0);
+    auto &const_1 = bb.emplace_back<bjac::ConstInstruction>(get_i64(), std::uint64_t{0x0ff});
+    auto &op_1 =
+        bb.emplace_back<bjac::BinaryOperator>(bjac::Instruction::Opcode::kXor, arg, const_1);
+    auto &const_2 = bb.emplace_back<bjac::ConstInstruction>(get_i64(), std::uint64_t{0xff0});
+    auto &op_2 =
+        bb.emplace_back<bjac::BinaryOperator>(bjac::Instruction::Opcode::kXor, op_1, const_2);
+    bb.emplace_back<bjac::ReturnInstruction>(op_2);
+
+    // Act
+    bjac::PeepholePass{}.run(foo);
+
+    // Assert
+    EXPECT_EQ(bb.size(), 7) << foo;
+    EXPECT_EQ(op_2.get_lhs(), &arg) << foo;
+    ASSERT_EQ(op_2.get_rhs()->get_opcode(), bjac::Instruction::Opcode::kConst) << foo;
+    EXPECT_EQ(static_cast<const bjac::ConstInstruction *>(op_2.get_rhs())->get_value(), 0xf0f)
+        << foo;
+}
+
+/*
+ * i64 foo(i64)
+ * %bb0:
+ *     %0.0 = i64 arg [0]
+ *     %0.1 = i64 constant 0x0ff
+ *     %0.2 = i64 and %0.0, %0.1
+ *     %0.3 = i64 constant 0xff0
+ *     %0.4 = i64 or %0.2, %0.3
+ *     %0.5 ret i64 %0.4
+ */
+// Constants are combined only through chains of the same operation
+TEST(PeepholesForOr, NoChainingThroughAnd) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+
+    auto &bb = foo.emplace_back();
+
+    auto &arg = bb.emplace_back<bjac::ArgumentInstruction>(0);
+    auto &const_1 = bb.emplace_back<bjac::ConstInstruction>(get_i64(), std::uint64_t{0x0ff});
+    auto &op_1 =
+        bb.emplace_back<bjac::BinaryOperator>(bjac::Instruction::Opcode::kAnd, arg, const_1);
+    auto &const_2 = bb.emplace_back<bjac::ConstInstruction>(get_i64(), std::uint64_t{0xff0});
+    auto &op_2 =
+        bb.emplace_back<bjac::BinaryOperator>(bjac::Instruction::Opcode::kOr, op_1, const_2);
+    bb.emplace_back<bjac::ReturnInstruction>(op_2);
+
+    bjac::AnalysisManager am;
+
+    // Act
+    const auto preserved = bjac::PeepholePass{}.run(foo, am);
+
+    // Assert
+    EXPECT_EQ(preserved, bjac::PreservedAnalyses::all()) << foo;
+    EXPECT_EQ(bb.size(), 6) << foo;
+    EXPECT_EQ(op_2.get_lhs(), &op_1) << foo;
+    EXPECT_EQ(op_2.get_rhs(), &const_2) << foo;
+}
@@ -0,0 +1,122 @@
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "bjac/IR/binary_operator.hpp"
+#include "bjac/IR/constant_instruction.hpp"
+#include "bjac/IR/function.hpp"
+#include "bjac/IR/ret_instruction.hpp"
+
+#include "bjac/transforms/dce.hpp"
+#include "bjac/transforms/pipeline.hpp"
+
+#include "test/common.hpp"
+
+using enum bjac::Type::ID;
+using enum bjac::Instruction::Opcode;
+
+namespace {
+
+/*
+ * i64 foo()
+ * %bb0:
+ *     %0.0 = i64 constant 2
+ *     %0.1 = i64 constant 3
+ *     %0.2 = i64 add %0.0, %0.1
+ *     %0.3 ret i64 %0.2
+ */
+void fill_foldable_function(bjac::Function &foo) {
+    auto &bb = foo.emplace_back();
+
+    auto &two = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 2);
+    auto &three = bb.emplace_back<bjac::ConstInstruction>(get_i64(), 3);
+    auto &add = bb.emplace_back<bjac::BinaryOperator>(kAdd, two, three);
+    bb.emplace_back<bjac::ReturnInstruction>(add);
+}
+
+} // unnamed namespace
+
+TEST(PassPipeline, UnknownPassThrows) {
+    // Act & Assert
+    EXPECT_THROW(bjac::PassPipeline{"dce, inlining"}, std::invalid_argument);
+    EXPECT_THROW(bjac::PassPipeline{"dce,,peepholes"}, std::invalid_argument);
+}
+
+TEST(PassPipeline, PassesRunInOrder) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64);
+    fill_foldable_function(foo);
+    bjac::PassPipeline pipeline{"constant-folding, dce"};
+
+    // Act
+    const auto iterations = pipeline.run(foo);
+
+    // Assert
+    EXPECT_EQ(iterations, 1);
+    EXPECT_EQ(foo.front().size(), 2) << foo;
+
+    const auto stats = pipeline.stats();
+    ASSERT_EQ(stats.size(), 2);
+
+    EXPECT_EQ(stats[0].name, "constant-folding");
+    EXPECT_EQ(stats[0].runs, 1);
+    EXPECT_EQ(stats[0].changes, 1);
+    EXPECT_EQ(stats[0].instructions_added, 1);
+    EXPECT_EQ(stats[0].instructions_removed, 1);
+    EXPECT_GE(stats[0].allocations, 1);
+
+    EXPECT_EQ(stats[1].name, "dce");
+    EXPECT_EQ(stats[1].instructions_added, 0);
+    EXPECT_EQ(stats[1].instructions_removed, 2);
+}
+
+TEST(PassPipeline, FixedPoint) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64);
+    bjac::Function bar = get_func("bar", kI64);
+    fill_foldable_function(foo);
+    fill_foldable_function(bar);
+    bjac::PassPipeline once{"dce, constant-folding"};
+    bjac::PassPipeline fixed_point{"dce, constant-folding", {.fixed_point = true}};
+
+    // Act
+    const auto once_iterations = once.run(foo);
+    const auto fixed_point_iterations = fixed_point.run(bar);
+
+    // Assert
+    EXPECT_EQ(once_iterations, 1);
+    EXPECT_EQ(foo.front().size(), 4) << foo;
+    // constants left by the folding are removed by the second run, and the third one changes
+    // nothing
+    EXPECT_EQ(fixed_point_iterations, 3);
+    EXPECT_EQ(bar.front().size(), 2) << bar;
+
+    // neither pass changes the blocks, yet both changes are counted
+    const auto stats = fixed_point.stats();
+    ASSERT_EQ(stats.size(), 2);
+    EXPECT_EQ(stats[0].changes, 1);
+    EXPECT_EQ(stats[1].changes, 1);
+}
+
+TEST(PassPipeline, CustomPassesAndReports) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64);
+    fill_foldable_function(foo);
+    bjac::PassPipeline pipeline;
+    pipeline.add<bjac::DCE>("my-dce");
+
+    // Act
+    pipeline.run(foo);
+    std::ostringstream table;
+    pipeline.print_stats(table);
+    const auto json = pipeline.stats_to_json();
+
+    // Assert
+    EXPECT_NE(table.str().find("my-dce"), std::string::npos);
+    EXPECT_NE(table.str().find("total"), std::string::npos);
+    EXPECT_TRUE(json.starts_with(R"({"iterations": 1, "passes": [{"name": "my-dce", "runs": 1, )"))
+        << json;
+    EXPECT_TRUE(json.ends_with("]}")) << json;
+}
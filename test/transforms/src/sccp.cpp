@@ -0,0 +1,225 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "bjac/IR/argument_instruction.hpp"
+#include "bjac/IR/basic_block.hpp"
+#include "bjac/IR/binary_operator.hpp"
+#include "bjac/IR/branch_instruction.hpp"
+#include "bjac/IR/constant_instruction.hpp"
+#include "bjac/IR/function.hpp"
+#include "bjac/IR/icmp_instruction.hpp"
+#include "bjac/IR/phi_instruction.hpp"
+#include "bjac/IR/ret_instruction.hpp"
+
+#include "bjac/transforms/analysis_manager.hpp"
+#include "bjac/transforms/dce.hpp"
+#include "bjac/transforms/sccp.hpp"
+
+#include "test/common.hpp"
+
+using enum bjac::Type::ID;
+using enum bjac::Instruction::Opcode;
+
+namespace {
+
+const bjac::Instruction &returned_value(const bjac::BasicBlock &bb) {
+    return *static_cast<const bjac::ReturnInstruction &>(bb.back()).get_ret_value();
+}
+
+} // unnamed namespace
+
+/*
+ * i64 foo(i64)
+ * %bb0:
+ *     %0.0 = i64 arg [0]
+ *     %0.1 = i64 constant 0
+ *     %0.2 = i1 icmp eq %0.0, %0.1
+ *     %0.3 br i1 %0.2, label %bb1, label %bb2
+ * %bb1: ; preds: %bb0
+ *     %1.0 = i64 constant 2
+ *     %1.1 = i64 constant 3
+ *     %1.2 = i64 add %1.0, %1.1
+ *     %1.3 br label %bb3
+ * %bb2: ; preds: %bb0
+ *     %2.0 = i64 constant 5
+ *     %2.1 br label %bb3
+ * %bb3: ; preds: %bb1, %bb2
+ *     %3.0 = phi i64 [%1.2, %bb1], [%2.0, %bb2]
+ *     %3.1 ret i64 %3.0
+ */
+// Both paths bring the same constant, and the one computed with an addition is folded on the way
+TEST(SCCP, ConstantThroughPHI) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto [bb, names] = setup(foo, {'A', 'B', 'C', 'D'});
+
+    auto &arg = bb['A']->emplace_back<bjac::ArgumentInstruction>(0);
+    auto &zero = bb['A']->emplace_back<bjac::ConstInstruction>(get_i64(), 0);
+    auto &cond =
+        bb['A']->emplace_back<bjac::ICmpInstruction>(bjac::ICmpInstruction::Kind::eq, arg, zero);
+    bb['A']->emplace_back<bjac::BranchInstruction>(cond, *bb['B'], *bb['C']);
+
+    auto &two = bb['B']->emplace_back<bjac::ConstInstruction>(get_i64(), 2);
+    auto &three = bb['B']->emplace_back<bjac::ConstInstruction>(get_i64(), 3);
+    auto &sum = bb['B']->emplace_back<bjac::BinaryOperator>(kAdd, two, three);
+    bb['B']->emplace_back<bjac::BranchInstruction>(*bb['D']);
+
+    auto &five = bb['C']->emplace_back<bjac::ConstInstruction>(get_i64(), 5);
+    bb['C']->emplace_back<bjac::BranchInstruction>(*bb['D']);
+
+    auto &phi = bb['D']->emplace_back<bjac::PHIInstruction>(get_i64());
+    bb['D']->emplace_back<bjac::ReturnInstruction>(phi);
+    phi.add_path(*bb['B'], sum);
+    phi.add_path(*bb['C'], five);
+
+    bjac::SCCPPass pass;
+    bjac::AnalysisManager am;
+
+    // Act
+    const auto preserved = pass.run(foo, am);
+
+    // Assert
+    EXPECT_EQ(preserved, bjac::PreservedAnalyses::cfg());
+    EXPECT_EQ(pass.folded_branches_count(), 0);
+
+    const auto &result = returned_value(*bb['D']);
+    ASSERT_EQ(result.get_opcode(), kConst) << foo;
+    EXPECT_EQ(static_cast<const bjac::ConstInstruction &>(result).get_value(), 5) << foo;
+    EXPECT_EQ(bb['D']->front().get_opcode(), kConst) << foo;
+    EXPECT_EQ(foo.size(), 4) << foo;
+}
+
+/*
+ * i64 foo()
+ * %bb0:
+ *     %0.0 = i64 constant 3
+ *     %0.1 = i64 constant 4
+ *     %0.2 = i1 icmp ult %0.0, %0.1
+ *     %0.3 br i1 %0.2, label %bb1, label %bb2
+ * %bb1: ; preds: %bb0
+ *     %1.0 = i64 constant 10
+ *     %1.1 br label %bb3
+ * %bb2: ; preds: %bb0
+ *     %2.0 = i64 constant 20
+ *     %2.1 br label %bb3
+ * %bb3: ; preds: %bb1, %bb2
+ *     %3.0 = phi i64 [%1.0, %bb1], [%2.0, %bb2]
+ *     %3.1 ret i64 %3.0
+ */
+// Values coming from the path never taken don't count, and DCE removes the block of the path
+TEST(SCCP, BranchOnConstantCondition) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64);
+    auto [bb, names] = setup(foo, {'A', 'B', 'C', 'D'});
+
+    auto &three = bb['A']->emplace_back<bjac::ConstInstruction>(get_i64(), 3);
+    auto &four = bb['A']->emplace_back<bjac::ConstInstruction>(get_i64(), 4);
+    auto &cond =
+        bb['A']->emplace_back<bjac::ICmpInstruction>(bjac::ICmpInstruction::Kind::ult, three, four);
+    bb['A']->emplace_back<bjac::BranchInstruction>(cond, *bb['B'], *bb['C']);
+
+    auto &ten = bb['B']->emplace_back<bjac::ConstInstruction>(get_i64(), 10);
+    bb['B']->emplace_back<bjac::BranchInstruction>(*bb['D']);
+
+    auto &twenty = bb['C']->emplace_back<bjac::ConstInstruction>(get_i64(), 20);
+    bb['C']->emplace_back<bjac::BranchInstruction>(*bb['D']);
+
+    auto &phi = bb['D']->emplace_back<bjac::PHIInstruction>(get_i64());
+    bb['D']->emplace_back<bjac::ReturnInstruction>(phi);
+    phi.add_path(*bb['B'], ten);
+    phi.add_path(*bb['C'], twenty);
+
+    bjac::SCCPPass pass;
+    bjac::AnalysisManager am;
+
+    // Act
+    const auto preserved = pass.run(foo, am);
+    bjac::DCE{}.run(foo, am);
+
+    // Assert
+    EXPECT_EQ(preserved, bjac::PreservedAnalyses::none());
+    EXPECT_EQ(pass.folded_branches_count(), 1);
+
+    EXPECT_EQ(foo.size(), 3) << foo;
+    EXPECT_EQ(bb['A']->size(), 1) << foo;
+    ASSERT_EQ(bb['A']->back().get_opcode(), kBr) << foo;
+    const auto &br = static_cast<const bjac::BranchInstruction &>(bb['A']->back());
+    EXPECT_FALSE(br.is_conditional()) << foo;
+    EXPECT_EQ(br.get_true_path(), bb['B']) << foo;
+
+    // the removed block is no longer a predecessor
+    EXPECT_EQ(std::vector<bjac::BasicBlock *>(std::from_range, bb['D']->predecessors()),
+              (std::vector<bjac::BasicBlock *>{bb['B']}))
+        << foo;
+
+    const auto &result = returned_value(*bb['D']);
+    ASSERT_EQ(result.get_opcode(), kConst) << foo;
+    EXPECT_EQ(static_cast<const bjac::ConstInstruction &>(result).get_value(), 10) << foo;
+}
+
+/*
+ * i64 foo(i64)
+ * %bb0:
+ *     %0.0 = i64 arg [0]
+ *     %0.1 = i64 constant 0
+ *     %0.2 = i64 constant 1
+ *     %0.3 br label %bb1
+ * %bb1: ; preds: %bb0, %bb2
+ *     %1.0 = phi i64 [%0.2, %bb0], [%2.0, %bb2]
+ *     %1.1 = phi i64 [%0.1, %bb0], [%2.1, %bb2]
+ *     %1.2 = i1 icmp ult %1.1, %0.0
+ *     %1.3 br i1 %1.2, label %bb2, label %bb3
+ * %bb2: ; preds: %bb1
+ *     %2.0 = i64 mul %1.0, %0.2
+ *     %2.1 = i64 add %1.1, %0.2
+ *     %2.2 br label %bb1
+ * %bb3: ; preds: %bb1
+ *     %3.0 ret i64 %1.0
+ */
+// The value of %1.0 is assumed constant until the back edge proves otherwise, which it doesn't
+TEST(SCCP, ConstantAroundLoop) {
+    // Assign
+    bjac::Function foo = get_func("foo", kI64, {kI64});
+    auto [bb, names] = setup(foo, {'A', 'H', 'L', 'E'});
+
+    auto &n = bb['A']->emplace_back<bjac::ArgumentInstruction>(0);
+    auto &zero = bb['A']->emplace_back<bjac::ConstInstruction>(get_i64(), 0);
+    auto &one = bb['A']->emplace_back<bjac::ConstInstruction>(get_i64(), 1);
+    bb['A']->emplace_back<bjac::BranchInstruction>(*bb['H']);
+
+    auto &k = bb['H']->emplace_back<bjac::PHIInstruction>(get_i64());
+    auto &i = bb['H']->emplace_back<bjac::PHIInstruction>(get_i64());
+    auto &cond =
+        bb['H']->emplace_back<bjac::ICmpInstruction>(bjac::ICmpInstruction::Kind::ult, i, n);
+    bb['H']->emplace_back<bjac::BranchInstruction>(cond, *bb['L'], *bb['E']);
+
+    auto &k_next = bb['L']->emplace_back<bjac::BinaryOperator>(kMul, k, one);
+    auto &i_next = bb['L']->emplace_back<bjac::BinaryOperator>(kAdd, i, one);
+    bb['L']->emplace_back<bjac::BranchInstruction>(*bb['H']);
+
+    bb['E']->emplace_back<bjac::ReturnInstruction>(k);
+
+    k.add_path(*bb['A'], one);
+    k.add_path(*bb['L'], k_next);
+    i.add_path(*bb['A'], zero);
+    i.add_path(*bb['L'], i_next);
+
+    bjac::SCCPPass pass;
+
+    // Act
+    pass.run(foo);
+
+    // Assert
+    EXPECT_EQ(pass.folded_branches_count(), 0);
+    // k and k_next
+    EXPECT_EQ(pass.folded_instructions_count(), 2);
+
+    const auto &result = returned_value(*bb['E']);
+    ASSERT_EQ(result.get_opcode(), kConst) << foo;
+    EXPECT_EQ(static_cast<const bjac::ConstInstruction &>(result).get_value(), 1) << foo;
+
+    // i changes with every iteration
+    ASSERT_EQ(bb['H']->front().get_opcode(), kPHI) << foo;
+    EXPECT_EQ(foo.size(), 4) << foo;
+}
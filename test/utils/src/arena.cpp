@@ -0,0 +1,93 @@
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "bjac/utils/arena.hpp"
+
+TEST(Arena, AllocationsAreAligned) {
+    // Assign
+    bjac::Arena arena;
+
+    for (std::size_t size = 1; size <= bjac::Arena::kMaxChunkSize; size += 7) {
+        // Act
+        void *p = arena.allocate(size);
+
+        // Assert
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p) % bjac::Arena::kGranularity, 0);
+        EXPECT_EQ(&bjac::Arena::owner(p), &arena);
+    }
+}
+
+TEST(Arena, FreedChunksAreReused) {
+    // Assign
+    bjac::Arena arena;
+    void *p = arena.allocate(40);
+    void *q = arena.allocate(100);
+
+    // Act
+    arena.deallocate(p, 40);
+    arena.deallocate(q, 100);
+
+    // Assert
+    EXPECT_EQ(arena.allocate(100), q);
+    EXPECT_EQ(arena.allocate(33), p); // 33 and 40 bytes belong to the same size class
+    EXPECT_NE(arena.allocate(40), p);
+}
+
+TEST(Arena, SlabsAreAllocatedOnDemand) {
+    // Assign
+    bjac::Arena arena;
+    constexpr std::size_t kChunkSize = 64;
+    constexpr std::size_t kChunksPerSlab = bjac::Arena::kSlabSize / kChunkSize - 1;
+
+    // Act
+    for (std::size_t i = 0; i != kChunksPerSlab; ++i) {
+        static_cast<void>(arena.allocate(kChunkSize));
+    }
+
+    // Assert
+    EXPECT_EQ(arena.slabs_count(), 1);
+    static_cast<void>(arena.allocate(kChunkSize));
+    EXPECT_EQ(arena.slabs_count(), 2);
+}
+
+TEST(Arena, LargeAllocations) {
+    // Assign
+    bjac::Arena arena;
+
+    // Act
+    void *p = arena.allocate(2 * bjac::Arena::kSlabSize);
+
+    // Assert
+    EXPECT_EQ(arena.slabs_count(), 0);
+    EXPECT_EQ(arena.allocations_count(), 1);
+    arena.deallocate(p, 2 * bjac::Arena::kSlabSize);
+    EXPECT_EQ(arena.deallocations_count(), 1);
+}
+
+TEST(Arena, MemoryResource) {
+    // Assign
+    bjac::Arena arena;
+    std::pmr::set<int> set{&arena};
+    std::pmr::vector<int> vector{&arena};
+
+    // Act
+    for (int i = 0; i != 1000; ++i) {
+        set.insert(i);
+        vector.push_back(i);
+    }
+    set.clear();
+    const auto slabs_count = arena.slabs_count();
+    for (int i = 0; i != 1000; ++i) {
+        set.insert(i);
+    }
+
+    // Assert
+    EXPECT_EQ(set.size(), 1000);
+    EXPECT_EQ(vector.size(), 1000);
+    EXPECT_EQ(arena.slabs_count(), slabs_count);
+}
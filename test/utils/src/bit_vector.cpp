@@ -0,0 +1,74 @@
+#include <cstddef>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "bjac/utils/bit_vector.hpp"
+
+TEST(BitVector, SetTestAndReset) {
+    // Assign
+    bjac::BitVector bits(130);
+
+    // Act
+    bits.set(0);
+    bits.set(64);
+    bits.set(129);
+    bits.reset(64);
+
+    // Assert
+    EXPECT_TRUE(bits.test(0));
+    EXPECT_FALSE(bits.test(64));
+    EXPECT_TRUE(bits.test(129));
+    EXPECT_EQ(bits.count(), 2);
+    EXPECT_TRUE(bits.any());
+}
+
+TEST(BitVector, IteratesOverSetBitsInOrder) {
+    // Assign
+    bjac::BitVector bits(200);
+    const std::vector<std::size_t> expected{3, 63, 64, 65, 127, 199};
+    for (auto i : expected) {
+        bits.set(i);
+    }
+
+    // Act
+    const std::vector<std::size_t> actual(std::from_range, bits);
+
+    // Assert
+    EXPECT_EQ(actual, expected);
+}
+
+TEST(BitVector, EmptyVectorHasNoSetBits) {
+    // Assign
+    bjac::BitVector bits(100);
+
+    // Act & Assert
+    EXPECT_TRUE(bits.none());
+    EXPECT_EQ(bits.begin(), bits.end());
+}
+
+TEST(BitVector, SetOperations) {
+    // Assign
+    bjac::BitVector lhs(100);
+    bjac::BitVector rhs(100);
+    lhs.set(1);
+    lhs.set(70);
+    rhs.set(70);
+    rhs.set(99);
+
+    // Act
+    auto united = lhs;
+    united |= rhs;
+    auto intersected = lhs;
+    intersected &= rhs;
+    auto subtracted = lhs;
+    subtracted.subtract(rhs);
+
+    // Assert
+    EXPECT_EQ(std::vector<std::size_t>(std::from_range, united),
+              (std::vector<std::size_t>{1, 70, 99}));
+    EXPECT_EQ(std::vector<std::size_t>(std::from_range, intersected),
+              (std::vector<std::size_t>{70}));
+    EXPECT_EQ(std::vector<std::size_t>(std::from_range, subtracted),
+              (std::vector<std::size_t>{1}));
+}